@@ -0,0 +1,50 @@
+#include "simlib/aho_corasick.hh"
+#include "simlib/random.hh"
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static std::string random_text(size_t len) {
+    std::string res(len, '\0');
+    for (auto& c : res) {
+        c = static_cast<char>(get_random('a', 'd'));
+    }
+    return res;
+}
+
+static void aho_corasick_build(benchmark::State& state) {
+    std::vector<std::string> patterns;
+    for (int i = 0; i < state.range(0); ++i) {
+        patterns.emplace_back(random_text(get_random(1, 16)));
+    }
+
+    for (auto _ : state) {
+        AhoCorasick ac;
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            ac.add_pattern(patterns[i], i + 1);
+        }
+        ac.build_fail_edges();
+        benchmark::DoNotOptimize(ac);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(aho_corasick_build)->Arg(16)->Arg(1024);
+
+static void aho_corasick_search_in(benchmark::State& state) {
+    AhoCorasick ac;
+    for (uint i = 1; i <= 256; ++i) {
+        auto pattern = random_text(get_random(1, 16));
+        ac.add_pattern(pattern, i);
+    }
+    ac.build_fail_edges();
+    auto text = random_text(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ac.search_in(text));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(aho_corasick_search_in)->Arg(1 << 10)->Arg(1 << 20);
@@ -0,0 +1,24 @@
+#include "simlib/concat.hh"
+#include "simlib/concat_tostr.hh"
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+static void concat_inplace_buff(benchmark::State& state) {
+    std::string str = "some string";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(concat("foo", str, ' ', 1234567890, " bar ", -42, '\n'));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(concat_inplace_buff);
+
+static void concat_tostr_string(benchmark::State& state) {
+    std::string str = "some string";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            concat_tostr("foo", str, ' ', 1234567890, " bar ", -42, '\n'));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(concat_tostr_string);
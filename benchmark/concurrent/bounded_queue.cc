@@ -0,0 +1,32 @@
+#include "simlib/concurrent/bounded_queue.hh"
+
+#include <benchmark/benchmark.h>
+
+static void bounded_queue_push_pop(benchmark::State& state) {
+    concurrent::BoundedQueue<int64_t> queue(static_cast<unsigned>(state.range(0)));
+    int64_t i = 0;
+    for (auto _ : state) {
+        queue.push(++i);
+        benchmark::DoNotOptimize(queue.pop());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+// NOLINTNEXTLINE
+BENCHMARK(bounded_queue_push_pop)->Arg(1)->Arg(1024);
+
+// Half of the threads are producers, the other half consumers
+static void bounded_queue_contention(benchmark::State& state) {
+    static concurrent::BoundedQueue<int64_t> queue(64);
+    bool producer = (state.thread_index() % 2 == 0);
+    int64_t i = 0;
+    for (auto _ : state) {
+        if (producer) {
+            queue.push(++i);
+        } else {
+            benchmark::DoNotOptimize(queue.pop());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+// NOLINTNEXTLINE
+BENCHMARK(bounded_queue_contention)->ThreadRange(2, 16)->UseRealTime();
@@ -0,0 +1,26 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/config_file.hh"
+
+#include <benchmark/benchmark.h>
+#include <string>
+
+static std::string make_config(int vars_num) {
+    std::string res;
+    for (int i = 0; i < vars_num; ++i) {
+        back_insert(res, "var", i, ": 'some value ", i, "'\n");
+        back_insert(res, "arr", i, ": [\n\tfirst\n\t\"second\\n\"\n\t3\n]\n");
+    }
+    return res;
+}
+
+static void config_file_load_config_from_string(benchmark::State& state) {
+    auto config = make_config(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        ConfigFile cf;
+        cf.load_config_from_string(config, true);
+        benchmark::DoNotOptimize(cf);
+    }
+    state.SetBytesProcessed(state.iterations() * config.size());
+}
+// NOLINTNEXTLINE
+BENCHMARK(config_file_load_config_from_string)->Arg(16)->Arg(1024);
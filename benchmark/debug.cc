@@ -0,0 +1,54 @@
+#include "simlib/debug.hh"
+
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+// NOINLINE to make the compiler keep the mark of every call
+[[gnu::noinline]] static int function_without_mark(int x) {
+    benchmark::DoNotOptimize(x);
+    return x + 1;
+}
+
+[[gnu::noinline]] static int function_with_mark(int x) {
+    STACK_UNWINDING_MARK;
+    benchmark::DoNotOptimize(x);
+    return x + 1;
+}
+
+static void stack_unwinding_mark_baseline(benchmark::State& state) {
+    int x = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x = function_without_mark(x));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(stack_unwinding_mark_baseline);
+
+static void stack_unwinding_mark_no_exception(benchmark::State& state) {
+    int x = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x = function_with_mark(x));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(stack_unwinding_mark_no_exception);
+
+[[gnu::noinline]] static void throw_through_marks(int depth) {
+    STACK_UNWINDING_MARK;
+    if (depth == 0) {
+        throw std::runtime_error("error");
+    }
+    throw_through_marks(depth - 1);
+}
+
+static void stack_unwinding_mark_exception(benchmark::State& state) {
+    for (auto _ : state) {
+        try {
+            throw_through_marks(static_cast<int>(state.range(0)));
+        } catch (const std::exception&) {
+            ::stack_unwinding::StackGuard::marks_collected.clear();
+        }
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(stack_unwinding_mark_exception)->Arg(0)->Arg(8)->Arg(64);
@@ -0,0 +1,42 @@
+#include "simlib/event_queue.hh"
+#include "simlib/file_descriptor.hh"
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+
+static void event_queue_ready_handlers(benchmark::State& state) {
+    for (auto _ : state) {
+        EventQueue eq;
+        int64_t counter = 0;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            eq.add_ready_handler([&] { ++counter; });
+        }
+        eq.run();
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(event_queue_ready_handlers)->Arg(1)->Arg(1024);
+
+static void event_queue_file_handler(benchmark::State& state) {
+    FileDescriptor fd("/dev/zero", O_RDONLY | O_CLOEXEC);
+    if (not fd.is_open()) {
+        state.SkipWithError("Failed to open /dev/zero");
+        return;
+    }
+
+    for (auto _ : state) {
+        EventQueue eq;
+        int64_t dispatches = 0;
+        EventQueue::handler_id_t hid = eq.add_file_handler(fd, FileEvent::READABLE, [&] {
+            if (++dispatches == state.range(0)) {
+                eq.remove_handler(hid);
+            }
+        });
+        eq.run();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(event_queue_file_handler)->Arg(1)->Arg(1024);
@@ -0,0 +1,45 @@
+#include "simlib/inplace_array.hh"
+#include "simlib/inplace_buff.hh"
+
+#include <benchmark/benchmark.h>
+#include <memory_resource>
+
+static void inplace_buff_append_grow(benchmark::State& state) {
+    for (auto _ : state) {
+        InplaceBuff<32> buff;
+        for (int i = 0; i < state.range(0); ++i) {
+            buff.append("0123456789abcdef");
+        }
+        benchmark::DoNotOptimize(buff.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 16);
+}
+// NOLINTNEXTLINE
+BENCHMARK(inplace_buff_append_grow)->Range(8, 1 << 16);
+
+static void inplace_buff_append_grow_monotonic_resource(benchmark::State& state) {
+    for (auto _ : state) {
+        std::pmr::monotonic_buffer_resource arena;
+        InplaceBuff<32> buff(&arena);
+        for (int i = 0; i < state.range(0); ++i) {
+            buff.append("0123456789abcdef");
+        }
+        benchmark::DoNotOptimize(buff.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 16);
+}
+// NOLINTNEXTLINE
+BENCHMARK(inplace_buff_append_grow_monotonic_resource)->Range(8, 1 << 16);
+
+static void inplace_array_emplace_back_grow(benchmark::State& state) {
+    for (auto _ : state) {
+        InplaceArray<int, 16> arr;
+        for (int i = 0; i < state.range(0); ++i) {
+            arr.emplace_back(i);
+        }
+        benchmark::DoNotOptimize(arr.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(inplace_array_emplace_back_grow)->Range(8, 1 << 20);
@@ -0,0 +1,56 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/file_descriptor.hh"
+#include "simlib/libzip.hh"
+#include "simlib/random.hh"
+#include "simlib/temporary_file.hh"
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <string>
+
+// Creates a zip archive with @p entries_num files of size @p entry_size each
+static void create_zip(FilePath path, int entries_num, size_t entry_size) {
+    std::string data(entry_size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(get_random('0', '9')); // Compressible, but not too much
+    }
+
+    ZipFile zip(path, ZIP_CREATE | ZIP_TRUNCATE);
+    for (int i = 0; i < entries_num; ++i) {
+        zip.file_add(concat("tests/", i, ".in"), zip.source_buffer(data));
+    }
+    zip.close();
+}
+
+static void zip_file_extract_to_str(benchmark::State& state) {
+    TemporaryFile zip_file("/tmp/simlib.benchmark.libzip.XXXXXX");
+    create_zip(zip_file.path(), 16, state.range(0));
+
+    ZipFile zip(zip_file.path(), ZIP_RDONLY);
+    auto entries_num = zip.entries_no();
+    for (auto _ : state) {
+        for (ZipFile::index_t i = 0; i < entries_num; ++i) {
+            benchmark::DoNotOptimize(zip.extract_to_str(i));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * entries_num * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(zip_file_extract_to_str)->Arg(1 << 10)->Arg(1 << 20);
+
+static void zip_file_extract_to_fd(benchmark::State& state) {
+    TemporaryFile zip_file("/tmp/simlib.benchmark.libzip.XXXXXX");
+    create_zip(zip_file.path(), 16, state.range(0));
+    FileDescriptor dev_null("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    ZipFile zip(zip_file.path(), ZIP_RDONLY);
+    auto entries_num = zip.entries_no();
+    for (auto _ : state) {
+        for (ZipFile::index_t i = 0; i < entries_num; ++i) {
+            zip.extract_to_fd(i, dev_null);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * entries_num * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(zip_file_extract_to_fd)->Arg(1 << 10)->Arg(1 << 20);
@@ -0,0 +1,16 @@
+#include "simlib/logger.hh"
+
+#include <benchmark/benchmark.h>
+
+static void logger_log_line(benchmark::State& state) {
+    // Shared by all threads to measure contention
+    static Logger logger("/dev/null");
+    logger.label(state.range(0) != 0);
+    int64_t i = 0;
+    for (auto _ : state) {
+        logger("Judging submission ", ++i, " of problem ", 42, ": OK");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+// NOLINTNEXTLINE
+BENCHMARK(logger_log_line)->ArgName("label")->Arg(0)->Arg(1)->ThreadRange(1, 8);
@@ -0,0 +1,39 @@
+#include "simlib/metrics.hh"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+namespace {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Counter bench_counter{"bench_counter_total", "Benchmark counter"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::DurationHistogram bench_histogram{"bench_duration_seconds", "Benchmark histogram"};
+
+} // namespace
+
+static void metrics_counter_inc(benchmark::State& state) {
+    for (auto _ : state) {
+        bench_counter.inc();
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(metrics_counter_inc)->ThreadRange(1, 8);
+
+static void metrics_histogram_observe(benchmark::State& state) {
+    std::chrono::nanoseconds val{12345};
+    for (auto _ : state) {
+        bench_histogram.observe(val);
+        val += std::chrono::nanoseconds(7);
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(metrics_histogram_observe)->ThreadRange(1, 8);
+
+static void metrics_render_prometheus(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics::render_prometheus());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(metrics_render_prometheus);
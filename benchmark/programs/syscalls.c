@@ -0,0 +1,23 @@
+// Usage: syscalls <allowed|traced> <count>
+// Issues <count> system calls that the sandbox either allows or traces.
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        return 1;
+    }
+
+    int traced = (strcmp(argv[1], "traced") == 0);
+    long count = atol(argv[2]);
+    for (long i = 0; i < count; ++i) {
+        if (traced) {
+            syscall(SYS_brk, 0); // traced to update the VM peak
+        } else {
+            syscall(SYS_getpid);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/sim/judge_worker.hh"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+using std::chrono_literals::operator""ms;
+
+static sim::JudgeReport make_report(int tests_num) {
+    using Test = sim::JudgeReport::Test;
+    sim::JudgeReport report;
+    for (int i = 1; i <= tests_num; ++i) {
+        auto& group = report.groups.emplace_back();
+        for (char c : {'a', 'b'}) {
+            auto status = (i % 7 == 0 ? Test::WA : Test::OK);
+            group.tests.emplace_back(
+                concat_tostr(i, c), status, i % 1500 * 1ms, 1500ms, i * 1031 % 65536 << 10,
+                65536 << 10, status == Test::WA ? "Line 1: expected 4" : "");
+        }
+        group.score = group.max_score = 10;
+    }
+    return report;
+}
+
+static void judge_report_pretty_dump(benchmark::State& state) {
+    auto report = make_report(5000);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(report.pretty_dump());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(judge_report_pretty_dump);
+
+static void verbose_judge_logger(benchmark::State& state) {
+    auto report = make_report(5000);
+    Sandbox::ExitStat es;
+    es.runtime = es.cpu_runtime = 123ms;
+    for (auto _ : state) {
+        sim::VerboseJudgeLogger logger;
+        logger.begin(false);
+        for (const auto& group : report.groups) {
+            for (const auto& test : group.tests) {
+                logger.test(test.name, test, es, es, std::nullopt, "");
+            }
+            logger.group_score(group.score, group.max_score, 1);
+        }
+        logger.end();
+        benchmark::DoNotOptimize(logger.judge_log());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(verbose_judge_logger);
@@ -0,0 +1,90 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/file_contents.hh"
+#include "simlib/file_manip.hh"
+#include "simlib/sim/judge_worker.hh"
+#include "simlib/temporary_directory.hh"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+
+using std::string;
+
+namespace {
+
+constexpr size_t COMPILATION_ERRORS_MAX_LENGTH = 4096;
+
+constexpr const char SOLUTION_SOURCE[] = R"(#include <stdio.h>
+int main() {
+    long long a, b;
+    if (scanf("%lld %lld", &a, &b) == 2) {
+        printf("%lld\n", a + b);
+    }
+    return 0;
+}
+)";
+
+// A package with @p tests_num tests of the "a + b" problem, solved by
+// prog/sol.c and checked by the default checker
+struct SyntheticPackage {
+    TemporaryDirectory dir{"/tmp/simlib.benchmark.judge_worker.XXXXXX"};
+    string simfile;
+
+    explicit SyntheticPackage(int tests_num) {
+        throw_assert(mkdir(concat(dir.path(), "prog")) == 0);
+        throw_assert(mkdir(concat(dir.path(), "tests")) == 0);
+        put_file_contents(concat(dir.path(), "prog/sol.c"), SOLUTION_SOURCE);
+
+        string limits, tests_files;
+        for (int i = 1; i <= tests_num; ++i) {
+            auto input = concat(i, ' ', i, '\n');
+            auto output = concat(2 * i, '\n');
+            put_file_contents(concat(dir.path(), "tests/", i, ".in"), input);
+            put_file_contents(concat(dir.path(), "tests/", i, ".out"), output);
+            back_insert(limits, '\t', i, " 1\n");
+            back_insert(tests_files, '\t', i, " tests/", i, ".in tests/", i, ".out\n");
+        }
+        simfile = concat_tostr(
+            "name: a + b\nlabel: apb\nsolutions: [prog/sol.c]\nmemory_limit: 32\n"
+            "limits: [\n",
+            limits, "]\ntests_files: [\n", tests_files, "]\n");
+    }
+};
+
+void compile(sim::JudgeWorker& jworker) {
+    string compilation_errors;
+    if (jworker.compile_checker(
+            std::chrono::seconds(30), &compilation_errors, COMPILATION_ERRORS_MAX_LENGTH, ""))
+    {
+        THROW("failed to compile checker: \n", compilation_errors);
+    }
+    if (jworker.compile_solution_from_package(
+            "prog/sol.c", sim::SolutionLanguage::C11, std::chrono::seconds(30),
+            &compilation_errors, COMPILATION_ERRORS_MAX_LENGTH, ""))
+    {
+        THROW("failed to compile solution: \n", compilation_errors);
+    }
+}
+
+} // namespace
+
+static void judge_worker_judge(benchmark::State& state) {
+    SyntheticPackage package(static_cast<int>(state.range(0)));
+    sim::JudgeWorker jworker;
+    jworker.use_memfds = (state.range(1) != 0);
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+
+    sim::VerboseJudgeLogger judge_logger;
+    for (auto _ : state) {
+        auto report = jworker.judge(false, judge_logger);
+        benchmark::DoNotOptimize(report);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// NOLINTNEXTLINE
+BENCHMARK(judge_worker_judge)
+    ->ArgNames({"tests", "memfds"})
+    ->ArgsProduct({{1, 32}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,90 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/sim/simfile.hh"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::string make_simfile(int tests_num) {
+    std::string limits, scoring, tests_files;
+    for (int i = 1; i <= tests_num; ++i) {
+        back_insert(limits, '\t', i, "a 1.5\n\t", i, "b 2 32\n");
+        back_insert(scoring, '\t', i, " 10\n");
+        back_insert(tests_files, '\t', i, "a in/", i, "a.in out/", i, "a.out\n");
+        back_insert(tests_files, '\t', i, "b in/", i, "b.in out/", i, "b.out\n");
+    }
+    return concat_tostr(
+        "name: Some problem\n"
+        "label: som\n"
+        "statement: doc/statement.pdf\n"
+        "checker: check/checker.cc\n"
+        "solutions: [prog/sol.cc, prog/sol1.cc, prog/sol2.c]\n"
+        "memory_limit: 64\n"
+        "limits: [\n",
+        limits, "]\nscoring: [\n", scoring, "]\ntests_files: [\n", tests_files, "]\n");
+}
+
+static void simfile_load_all(benchmark::State& state) {
+    auto simfile = make_simfile(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        sim::Simfile sf(simfile);
+        sf.load_all();
+        benchmark::DoNotOptimize(sf);
+    }
+    state.SetBytesProcessed(state.iterations() * simfile.size());
+}
+// NOLINTNEXTLINE
+BENCHMARK(simfile_load_all)->Arg(10)->Arg(500);
+
+static void simfile_dump(benchmark::State& state) {
+    sim::Simfile sf(make_simfile(static_cast<int>(state.range(0))));
+    sf.load_all();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sf.dump());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(simfile_dump)->Arg(10)->Arg(500);
+
+static std::vector<std::string> shuffled_test_names(size_t tests_num) {
+    std::vector<std::string> names;
+    names.reserve(tests_num);
+    for (size_t i = 0; i < tests_num; ++i) {
+        // 26 * 26 tests per group
+        size_t tid = i % (26 * 26);
+        names.emplace_back(concat_tostr(
+            "problem", i / (26 * 26) + 1, static_cast<char>('a' + tid / 26),
+            static_cast<char>('a' + tid % 26)));
+    }
+    std::shuffle(names.begin(), names.end(), std::mt19937_64{42}); // NOLINT
+    return names;
+}
+
+static void test_name_comparator_sort_names(benchmark::State& state) {
+    auto names = shuffled_test_names(state.range(0));
+    std::vector<StringView> to_sort;
+    for (auto _ : state) {
+        to_sort.assign(names.begin(), names.end());
+        std::sort(to_sort.begin(), to_sort.end(), sim::Simfile::TestNameComparator());
+        benchmark::DoNotOptimize(to_sort.data());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(test_name_comparator_sort_names)->Arg(1000)->Arg(100000);
+
+static void test_name_comparator_sort_keys(benchmark::State& state) {
+    auto names = shuffled_test_names(state.range(0));
+    std::vector<sim::Simfile::TestNameComparator::Key> to_sort;
+    for (auto _ : state) {
+        to_sort.clear();
+        for (const auto& name : names) {
+            to_sort.emplace_back(sim::Simfile::TestNameComparator::key(name));
+        }
+        std::sort(to_sort.begin(), to_sort.end(), sim::Simfile::TestNameComparator());
+        benchmark::DoNotOptimize(to_sort.data());
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(test_name_comparator_sort_keys)->Arg(1000)->Arg(100000);
@@ -0,0 +1,76 @@
+#include "simlib/concat_tostr.hh"
+#include "simlib/sandbox.hh"
+#include "simlib/spawner.hh"
+#include "simlib/temporary_file.hh"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+using std::string;
+
+// Returns path of the compiled benchmark/programs/syscalls.c
+static const string& syscalls_program() {
+    static TemporaryFile executable("/tmp/simlib.benchmark.spawner.XXXXXX");
+    static bool compiled = [] {
+        auto es = Spawner::run(
+            "cc",
+            {"cc", "-O2", "benchmark/programs/syscalls.c", "-o", executable.path(), "-static"},
+            {-1, STDOUT_FILENO, STDERR_FILENO});
+        return es.si.code == CLD_EXITED and es.si.status == 0;
+    }();
+    if (not compiled) {
+        THROW("failed to compile benchmark/programs/syscalls.c");
+    }
+    return executable.path();
+}
+
+static void spawner_run_true(benchmark::State& state) {
+    for (auto _ : state) {
+        auto es = Spawner::run("true", {"true"});
+        if (es.si.code != CLD_EXITED or es.si.status != 0) {
+            state.SkipWithError("true failed");
+            return;
+        }
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(spawner_run_true)->UseRealTime();
+
+static constexpr Sandbox::Options SANDBOX_OPTIONS{
+    -1, -1, -1, std::chrono::seconds(10), 64 << 20, std::nullopt};
+
+static void run_syscalls_program(benchmark::State& state, bool sandboxed, StringView kind) {
+    const auto& exec = syscalls_program();
+    std::vector<string> args = {exec, kind.to_string(), concat_tostr(state.range(0))};
+    for (auto _ : state) {
+        auto es = (sandboxed ? Sandbox().run(exec, args, SANDBOX_OPTIONS)
+                             : Spawner::run(exec, args, SANDBOX_OPTIONS));
+        if (es.si.code != CLD_EXITED or es.si.status != 0) {
+            state.SkipWithError(es.message.c_str());
+            return;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void spawner_run_syscalls(benchmark::State& state) {
+    run_syscalls_program(state, false, "allowed");
+}
+// NOLINTNEXTLINE
+BENCHMARK(spawner_run_syscalls)->Arg(0)->Arg(100000)->UseRealTime();
+
+// Spawn latency of the sandbox (Arg(0)) and the cost of syscalls that are
+// allowed by the seccomp filter
+static void sandbox_run_allowed_syscalls(benchmark::State& state) {
+    run_syscalls_program(state, true, "allowed");
+}
+// NOLINTNEXTLINE
+BENCHMARK(sandbox_run_allowed_syscalls)->Arg(0)->Arg(100000)->UseRealTime();
+
+// The difference from sandbox_run_allowed_syscalls is the per-syscall cost of
+// stopping the tracee and handling the syscall in the tracer
+static void sandbox_run_traced_syscalls(benchmark::State& state) {
+    run_syscalls_program(state, true, "traced");
+}
+// NOLINTNEXTLINE
+BENCHMARK(sandbox_run_traced_syscalls)->Arg(0)->Arg(100000)->UseRealTime();
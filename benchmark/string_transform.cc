@@ -0,0 +1,59 @@
+#include "simlib/string_transform.hh"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+static void str2num_int(benchmark::State& state) {
+    StringView str = "-1234567890";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        benchmark::DoNotOptimize(str2num<int64_t>(str));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(str2num_int);
+
+static void str2num_uint64_max(benchmark::State& state) {
+    StringView str = "18446744073709551615";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        benchmark::DoNotOptimize(str2num<uint64_t>(str));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(str2num_uint64_max);
+
+static void str2num_double(benchmark::State& state) {
+    StringView str = "3.14159265358979";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        benchmark::DoNotOptimize(str2num<double>(str));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(str2num_double);
+
+static void str2num_16_digits(benchmark::State& state) {
+    StringView str = "1234567890123456";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str);
+        benchmark::DoNotOptimize(str2num<uint64_t>(str));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(str2num_16_digits);
+
+static void str2nums_int(benchmark::State& state) {
+    std::string str;
+    for (int i = 0; i < 1000; ++i) {
+        str += std::to_string(i * 7919 % 1000003);
+        str += (i % 10 == 9 ? '\n' : ' ');
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(str2nums<int>(str));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * str.size()));
+}
+// NOLINTNEXTLINE
+BENCHMARK(str2nums_int);
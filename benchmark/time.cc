@@ -0,0 +1,40 @@
+#include "simlib/time.hh"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+static void localdate_strftime(benchmark::State& state) {
+    auto tp = std::chrono::system_clock::now();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(localdate("%Y-%m-%d %H:%M:%S", tp));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(localdate_strftime);
+
+static void mysql_localdate_buff_same_second(benchmark::State& state) {
+    auto tp = std::chrono::system_clock::now();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mysql_localdate_buff(tp, state.range(0)));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(mysql_localdate_buff_same_second)->Arg(0)->Arg(6);
+
+static void mysql_localdate_buff_now(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mysql_localdate_buff(std::chrono::system_clock::now(), 6));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(mysql_localdate_buff_now)->ThreadRange(1, 8);
+
+static void mysql_localdate_buff_every_second_changes(benchmark::State& state) {
+    auto tp = std::chrono::system_clock::now();
+    for (auto _ : state) {
+        tp += std::chrono::seconds(1);
+        benchmark::DoNotOptimize(mysql_localdate_buff(tp));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(mysql_localdate_buff_every_second_changes);
@@ -0,0 +1,34 @@
+#include "simlib/to_string.hh"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+static void to_string_int(benchmark::State& state) {
+    int64_t x = -1234567890;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(to_string(x));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(to_string_int);
+
+static void to_string_uint64_max(benchmark::State& state) {
+    uint64_t x = UINT64_MAX;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(to_string(x));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(to_string_uint64_max);
+
+static void to_string_double(benchmark::State& state) {
+    double x = 3.14159265358979;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(to_string(x, 6));
+    }
+}
+// NOLINTNEXTLINE
+BENCHMARK(to_string_double);
@@ -2,6 +2,7 @@
 
 #include "simlib/concat_common.hh"
 
+#include <algorithm>
 #include <type_traits>
 
 template <class... Args, std::enable_if_t<(is_string_argument<Args> and ...), int> = 0>
@@ -19,10 +20,10 @@ template <class... Args, std::enable_if_t<(is_string_argument<Args> and ...), in
 std::string& back_insert(std::string& str, Args&&... args) {
     return [&str](auto&&... xx) -> std::string& {
         size_t total_length = (str.size() + ... + string_length(xx));
-        // Allocate more space (reserve() is inefficient)
-        size_t old_size = str.size();
-        str.resize(total_length);
-        str.resize(old_size);
+        // Grow geometrically, as reserve() allocates exactly the requested size
+        if (total_length > str.capacity()) {
+            str.reserve(std::max(total_length, str.capacity() * 2));
+        }
         return (str += ... += std::forward<decltype(xx)>(xx));
     }(stringify(std::forward<Args>(args))...);
 }
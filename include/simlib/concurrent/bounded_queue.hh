@@ -6,6 +6,7 @@
 #include <climits>
 #include <deque>
 #include <mutex>
+#include <optional>
 #include <type_traits>
 
 namespace concurrent {
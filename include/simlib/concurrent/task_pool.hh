@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace concurrent {
+
+// Runs tasks on a pool of threads. Tasks may add new tasks while running. The
+// most recently added task is run first, so that recursive walks proceed
+// depth-first and keep the number of simultaneously held resources low.
+class TaskPool {
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::vector<std::function<void()>> tasks_;
+    size_t busy_workers_ = 0;
+    std::exception_ptr first_exception_;
+
+    void worker() {
+        std::unique_lock lock(mtx_);
+        for (;;) {
+            if (tasks_.empty()) {
+                if (busy_workers_ == 0) {
+                    cv_.notify_all(); // No more tasks will appear
+                    return;
+                }
+
+                cv_.wait(lock);
+                continue;
+            }
+
+            auto task = std::move(tasks_.back());
+            tasks_.pop_back();
+            ++busy_workers_;
+            lock.unlock();
+
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard guard(mtx_);
+                if (not first_exception_) {
+                    first_exception_ = std::current_exception();
+                }
+            }
+            task = nullptr; // Destroy the captured state outside the lock
+
+            lock.lock();
+            --busy_workers_;
+        }
+    }
+
+public:
+    TaskPool() = default;
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool(TaskPool&&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    TaskPool& operator=(TaskPool&&) = delete;
+
+    ~TaskPool() = default;
+
+    void push(std::function<void()> task) {
+        {
+            std::lock_guard guard(mtx_);
+            tasks_.emplace_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    // Runs tasks using @p threads_num threads (including the current one)
+    // until there are no tasks left. If @p threads_num is 0, the number of
+    // hardware threads is used. If any task throws, the first exception is
+    // rethrown after all the tasks have finished.
+    void run(unsigned threads_num = 0) {
+        if (threads_num == 0) {
+            threads_num = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+
+        std::vector<std::thread> workers;
+        try {
+            workers.reserve(threads_num - 1);
+            while (workers.size() + 1 < threads_num) {
+                workers.emplace_back([&] { worker(); });
+            }
+        } catch (const std::system_error&) {
+            // Continue with the threads that have been created
+        }
+
+        worker();
+        for (auto& thr : workers) {
+            thr.join();
+        }
+
+        if (first_exception_) {
+            std::rethrow_exception(std::exchange(first_exception_, nullptr));
+        }
+    }
+};
+
+} // namespace concurrent
@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <cxxabi.h>
 #include <exception>
 
 #define eprintf(...) fprintf(stderr, __VA_ARGS__)
@@ -93,34 +94,53 @@ inline auto errmsg() noexcept { return errmsg(errno); }
 
 namespace stack_unwinding {
 
+// Describes the place of a STACK_UNWINDING_MARK. It is a static constant, so
+// creating a mark costs only storing a pointer to it.
+struct MarkSite {
+    const char* file;
+    size_t line;
+    const char* pretty_function;
+};
+
 class StackGuard {
+    // Per-thread exception handling state, laid out as specified by the
+    // Itanium C++ ABI (2.2.2)
+    struct EhGlobals {
+        void* caught_exceptions;
+        unsigned int uncaught_exceptions;
+    };
+
+    // Cached result of __cxa_get_globals(), so that checking the exception
+    // state is just a load instead of a call into the C++ runtime
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+    static inline thread_local const EhGlobals* eh_globals_;
+
+    // Number of marks recorded so far by the current thread
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-    static inline thread_local uintmax_t event_stamp;
+    static inline thread_local uintmax_t marks_recorded;
 
-    bool inside_catch_ = static_cast<bool>(std::current_exception());
-    int uncaught_counter_ = std::uncaught_exceptions();
-    uintmax_t creation_stamp_ = event_stamp++;
-    const char* file_;
-    size_t line_;
-    const char* pretty_func_;
+    const MarkSite* site_;
+    unsigned uncaught_counter_ = eh_globals()->uncaught_exceptions;
+    uintmax_t creation_stamp_ = marks_recorded;
+
+    static const EhGlobals* eh_globals() noexcept {
+        if (__builtin_expect(eh_globals_ == nullptr, false)) {
+            eh_globals_ = reinterpret_cast<const EhGlobals*>(__cxxabiv1::__cxa_get_globals());
+        }
+        return eh_globals_;
+    }
 
 public:
     struct StackMark {
-        InplaceBuff<512> description;
-        uintmax_t stamp = event_stamp++;
-
-        template <class... Args, std::enable_if_t<(is_string_argument<Args> and ...), int> = 0>
-        explicit StackMark(Args&&... args)
-        : description(std::in_place, std::forward<Args>(args)...) {}
+        const MarkSite* site;
+        uintmax_t stamp;
     };
 
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
     static inline thread_local InplaceArray<StackMark, 128> marks_collected;
 
-    StackGuard(const char* file, size_t line, const char* pretty_function) noexcept
-    : file_(file)
-    , line_(line)
-    , pretty_func_(pretty_function) {}
+    explicit StackGuard(const MarkSite* site) noexcept
+    : site_(site) {}
 
     StackGuard(const StackGuard&) = delete;
     StackGuard(StackGuard&&) = delete;
@@ -128,21 +148,28 @@ public:
     StackGuard& operator=(StackGuard&&) = delete;
 
     ~StackGuard() {
-        if (std::uncaught_exceptions() == 1 and uncaught_counter_ == 0 and not inside_catch_) {
-            // Remove stack marks that are from earlier exceptions
-            if (marks_collected.size() > 0 and marks_collected.back().stamp < creation_stamp_)
-            {
-                marks_collected.clear();
-            }
+        // A mark created inside a catch block is destroyed before the block
+        // ends, so checking for an active handler here instead of upon
+        // creation is equivalent, and saves a load if no exception is thrown
+        const auto* eh = eh_globals();
+        if (eh->uncaught_exceptions == 1 and uncaught_counter_ == 0 and
+            eh->caught_exceptions == nullptr)
+        {
+            record();
+        }
+    }
 
-            try {
-                StackMark a;
-                StackMark b;
-                assert(a.stamp + 1 == b.stamp);
-                marks_collected.emplace_back(pretty_func_, " at ", file_, ':', line_);
-            } catch (...) {
-                // Nothing we can do here
-            }
+private:
+    void record() noexcept {
+        // Remove stack marks that are from earlier exceptions
+        if (marks_collected.size() > 0 and marks_collected.back().stamp < creation_stamp_) {
+            marks_collected.clear();
+        }
+
+        try {
+            marks_collected.emplace_back(StackMark{site_, marks_recorded++});
+        } catch (...) {
+            // Nothing we can do here
         }
     }
 };
@@ -152,9 +179,15 @@ public:
 #define STACK_UNWINDING_MARK_CONCATENATE_DETAIL(x, y) x##y
 #define STACK_UNWINDING_MARK_CONCAT(x, y) STACK_UNWINDING_MARK_CONCATENATE_DETAIL(x, y)
 
-#define STACK_UNWINDING_MARK                                   \
-    ::stack_unwinding::StackGuard STACK_UNWINDING_MARK_CONCAT( \
-        stack_unwind_mark_no_, __COUNTER__)(__FILE__, __LINE__, __PRETTY_FUNCTION__)
+#define STACK_UNWINDING_MARK_IMPL(site, guard)                                \
+    static constexpr ::stack_unwinding::MarkSite site{                       \
+        __FILE__, __LINE__, static_cast<const char*>(__PRETTY_FUNCTION__)}; \
+    ::stack_unwinding::StackGuard guard(&(site))
+
+#define STACK_UNWINDING_MARK                                                  \
+    STACK_UNWINDING_MARK_IMPL(                                                \
+        STACK_UNWINDING_MARK_CONCAT(stack_unwind_mark_site_no_, __COUNTER__), \
+        STACK_UNWINDING_MARK_CONCAT(stack_unwind_mark_no_, __COUNTER__))
 
 #define ERRLOG_CATCH(...)                                                        \
     do {                                                                         \
@@ -164,7 +197,8 @@ public:
                                                                                  \
         size_t i = 0;                                                            \
         for (auto const& mark : ::stack_unwinding::StackGuard::marks_collected)  \
-            tmplog('[', i++, "] ", mark.description, "\n");                      \
+            tmplog('[', i++, "] ", mark.site->pretty_function, " at ",           \
+                   mark.site->file, ':', mark.site->line, "\n");                \
                                                                                  \
         tmplog.flush_no_nl();                                                    \
         ::stack_unwinding::StackGuard::marks_collected.clear();                  \
@@ -66,7 +66,7 @@ public:
     EventQueue(EventQueue&& other) noexcept;
     EventQueue& operator=(const EventQueue&) = delete;
     EventQueue& operator=(EventQueue&& other) noexcept;
-    ~EventQueue() = default;
+    ~EventQueue();
 
     // Stops processing of events immediately. It is safe to call it from other
     // threads.
@@ -1,43 +1,180 @@
 #pragma once
 
+#include "simlib/ctype.hh"
+#include "simlib/string_view.hh"
+
+#include <algorithm>
 #include <array>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <optional>
 #include <sys/types.h>
 #include <unistd.h>
 
-class FdPreadBuff {
+// Buffered reader of the file contents starting from the specified offset.
+// Reads are done with pread(), so the file offset of the fd is not changed.
+// StringViews returned by the read_*() methods point into the internal buffer,
+// so they are valid only until the next call to any non-const method.
+template <size_t BUFF_SIZE>
+class BasicFdPreadBuff {
+    static_assert(BUFF_SIZE > 0);
+
     int fd;
-    std::array<unsigned char, 4096> buff{};
+    std::array<unsigned char, BUFF_SIZE> buff{};
     size_t pos = 0;
     size_t len = 0;
     off64_t buff_end_offset;
 
 public:
-    explicit FdPreadBuff(int fd, off64_t beg_offset = 0) noexcept
-    : fd{fd}
+    static constexpr size_t buff_size = BUFF_SIZE;
+
+    explicit BasicFdPreadBuff(int file_fd, off64_t beg_offset = 0) noexcept
+    : fd{file_fd}
     , buff_end_offset{beg_offset} {}
 
     // On success returns read character or EOF on success, otherwise
     // std::nullopt is returned and errno is set by read()
     std::optional<int> get_char() noexcept {
-        if (pos != len) {
-            return buff[pos++];
+        if (pos == len) {
+            ssize_t res = refill();
+            if (res < 0) {
+                return std::nullopt;
+            }
+            if (res == 0) {
+                return EOF;
+            }
         }
-        ssize_t res = pread64(fd, buff.data(), buff.size(), buff_end_offset);
-        if (res < 0) {
-            return std::nullopt;
+        return buff[pos++];
+    }
+
+    // Skips everything up to and including the first occurrence of @p delim.
+    // Returns @p delim if it was found, EOF if EOF was reached before it,
+    // otherwise std::nullopt is returned and errno is set by read()
+    std::optional<int> skip_until(char delim) noexcept {
+        for (;;) {
+            if (auto* p = std::memchr(buff.data() + pos, delim, len - pos); p) {
+                pos = static_cast<unsigned char*>(p) - buff.data() + 1;
+                return static_cast<unsigned char>(delim);
+            }
+            pos = len;
+            ssize_t res = refill();
+            if (res < 0) {
+                return std::nullopt;
+            }
+            if (res == 0) {
+                return EOF;
+            }
         }
-        if (res == 0) {
-            return EOF;
+    }
+
+    // Returns data up to (excluding) the first occurrence of @p delim or EOF.
+    // @p delim is consumed. If there are at least buff_size bytes before
+    // @p delim, only the first buff_size bytes are returned and the rest is
+    // left for the subsequent calls -- so returned data of size buff_size
+    // means that @p delim was not reached. At EOF std::nullopt is returned and
+    // errno is set to 0, on error std::nullopt is returned and errno is set by
+    // read().
+    std::optional<StringView> read_until(char delim) noexcept {
+        return extract(
+            [delim](const unsigned char* beg, const unsigned char* end) {
+                auto* p = std::memchr(beg, delim, end - beg);
+                return p ? static_cast<const unsigned char*>(p) : end;
+            },
+            true);
+    }
+
+    // Same as read_until('\n')
+    std::optional<StringView> read_line() noexcept { return read_until('\n'); }
+
+    // Skips white space and returns the following sequence of non-white space
+    // characters (the white space after it is not consumed). Tokens longer
+    // than buff_size are split the same way as in read_until(). At EOF
+    // std::nullopt is returned and errno is set to 0, on error std::nullopt
+    // is returned and errno is set by read().
+    std::optional<StringView> read_token() noexcept {
+        for (;;) {
+            while (pos != len and is_space(buff[pos])) {
+                ++pos;
+            }
+            if (pos != len) {
+                break;
+            }
+            ssize_t res = refill();
+            if (res < 0) {
+                return std::nullopt;
+            }
+            if (res == 0) {
+                errno = 0;
+                return std::nullopt;
+            }
         }
-        buff_end_offset += res;
-        len = res;
-        pos = 1;
-        return buff[0];
+        return extract(
+            [](const unsigned char* beg, const unsigned char* end) {
+                return std::find_if(beg, end, [](unsigned char c) { return is_space(c); });
+            },
+            false);
     }
 
     [[nodiscard]] off64_t curr_offset() const noexcept {
         return buff_end_offset - (len - pos);
     }
+
+private:
+    // Moves the unread data to the beginning of the buffer and fills the rest
+    // of the buffer. Returns the value returned by pread().
+    ssize_t refill() noexcept {
+        if (pos > 0) {
+            std::memmove(buff.data(), buff.data() + pos, len - pos);
+            len -= pos;
+            pos = 0;
+        }
+        ssize_t res = pread64(fd, buff.data() + len, buff.size() - len, buff_end_offset);
+        if (res > 0) {
+            buff_end_offset += res;
+            len += res;
+        }
+        return res;
+    }
+
+    StringView view(size_t beg, size_t end) const noexcept {
+        return {reinterpret_cast<const char*>(buff.data()) + beg, end - beg};
+    }
+
+    // @p find(beg, end) returns pointer to the first delimiter in [beg, end)
+    // or end if there is none
+    template <class Finder>
+    std::optional<StringView> extract(Finder&& find, bool consume_delim) noexcept {
+        size_t scanned = pos;
+        for (;;) {
+            size_t end = find(buff.data() + scanned, buff.data() + len) - buff.data();
+            if (end != len) {
+                auto res = view(pos, end);
+                pos = end + consume_delim;
+                return res;
+            }
+            if (pos == 0 and len == buff.size()) {
+                // The buffer is full and there is no delimiter
+                pos = len;
+                return view(0, len);
+            }
+
+            scanned = len - pos; // refill() moves the unread data to the front
+            ssize_t rc = refill();
+            if (rc < 0) {
+                return std::nullopt;
+            }
+            if (rc == 0) {
+                if (pos == len) {
+                    errno = 0;
+                    return std::nullopt;
+                }
+                auto res = view(pos, len);
+                pos = len;
+                return res;
+            }
+        }
+    }
 };
+
+using FdPreadBuff = BasicFdPreadBuff<4096>;
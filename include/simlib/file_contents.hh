@@ -5,6 +5,7 @@
 #include "simlib/file_perms.hh"
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /**
  * @brief Read @p count bytes to @p buff from @p fd
@@ -38,6 +39,40 @@
  */
 [[nodiscard]] size_t pread_all(int fd, off64_t pos, void* buff, size_t count) noexcept;
 
+/**
+ * @brief Read from @p fd to the buffers described by @p iov
+ * @details Uses readv(2), but reads until the buffers are full or EOF is
+ *   encountered. Any number of buffers is allowed (not only up to IOV_MAX).
+ *
+ * @param fd file descriptor
+ * @param iov buffers to fill; they are modified -- the entries are advanced
+ *   past the read bytes
+ * @param iovcnt number of buffers
+ *
+ * @return number of bytes read, if error occurs then errno is > 0
+ *
+ * @errors The same as for readv(2) except EINTR
+ */
+[[nodiscard]] size_t readv_all(int fd, iovec* iov, int iovcnt) noexcept;
+
+/**
+ * @brief Read from @p fd starting at @p pos to the buffers described by @p iov
+ *   without moving the file offset
+ * @details Uses preadv(2), but reads until the buffers are full or EOF is
+ *   encountered. Any number of buffers is allowed (not only up to IOV_MAX).
+ *
+ * @param fd file descriptor
+ * @param pos file offset -- where to start reading
+ * @param iov buffers to fill; they are modified -- the entries are advanced
+ *   past the read bytes
+ * @param iovcnt number of buffers
+ *
+ * @return number of bytes read, if error occurs then errno is > 0
+ *
+ * @errors The same as for preadv(2) except EINTR
+ */
+[[nodiscard]] size_t preadv_all(int fd, off64_t pos, iovec* iov, int iovcnt) noexcept;
+
 /**
  * @brief Write @p count bytes to @p fd from @p buff
  * @details Uses write(2), but writes until it is unable to write
@@ -52,6 +87,22 @@
  */
 [[nodiscard]] size_t write_all(int fd, const void* buff, size_t count) noexcept;
 
+/**
+ * @brief Write the buffers described by @p iov to @p fd
+ * @details Uses writev(2), but writes until it is unable to write. Any number
+ *   of buffers is allowed (not only up to IOV_MAX).
+ *
+ * @param fd file descriptor
+ * @param iov buffers to write; they are modified -- the entries are advanced
+ *   past the written bytes
+ * @param iovcnt number of buffers
+ *
+ * @return number of bytes written, if error occurs then errno is > 0
+ *
+ * @errors The same as for writev(2) except EINTR
+ */
+[[nodiscard]] size_t writev_all(int fd, iovec* iov, int iovcnt) noexcept;
+
 /**
  * @brief Write @p count bytes to @p fd from @p str
  * @details Uses write(2), but writes until it is unable to write
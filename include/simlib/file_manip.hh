@@ -42,6 +42,41 @@
     return remove_rat(AT_FDCWD, pathname);
 }
 
+/**
+ * @brief Removes recursively file/directory @p pathname relative to the
+ *   directory file descriptor @p dirfd using multiple threads
+ * @details Works like remove_rat(), but subdirectories and batches of files are
+ *   removed concurrently. Worth using for large directory trees.
+ *
+ * @param dirfd directory file descriptor
+ * @param pathname file/directory pathname (relative to @p dirfd)
+ * @param threads_num number of threads to use (including the calling thread),
+ *   0 means the number of hardware threads
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @errors The same that occur for remove_rat() or ENOMEM
+ */
+[[nodiscard]] int
+remove_rat_parallel(int dirfd, FilePath pathname, unsigned threads_num = 0) noexcept;
+
+/**
+ * @brief Removes recursively file/directory @p pathname using multiple threads
+ * @details Uses remove_rat_parallel()
+ *
+ * @param pathname file/directory to remove
+ * @param threads_num number of threads to use (including the calling thread),
+ *   0 means the number of hardware threads
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @errors The same that occur for remove_rat_parallel()
+ */
+[[nodiscard]] inline int
+remove_r_parallel(FilePath pathname, unsigned threads_num = 0) noexcept {
+    return remove_rat_parallel(AT_FDCWD, pathname, threads_num);
+}
+
 // Create directory (not recursively) (mode: 0755/rwxr-xr-x)
 [[nodiscard]] inline int mkdir(FilePath pathname) noexcept { return mkdir(pathname, S_0755); }
 
@@ -90,14 +125,18 @@
 /**
  * @brief Fast copies file from @p infd to @p outfd
  * @details Reads from @p infd form it's offset and writes to @p outfd from its
- *   offset
+ *   offset. If @p infd is a regular file, the copying is offloaded to the
+ *   kernel: first FICLONE (reflink) is tried, then copy_file_range(2), then
+ *   sendfile(2) and at last a read(2) / write(2) loop is used. Mechanisms that
+ *   turn out to be unsupported for a pair of filesystems are not tried again.
  *
  * @param infd file descriptor from which data will be copied
  * @param outfd file descriptor to which data will be copied
  *
  * @return 0 on success, -1 on error
  *
- * @errors The same that occur for read(2), write(2)
+ * @errors The same that occur for read(2), write(2), ioctl(FICLONE),
+ *   copy_file_range(2), sendfile(2)
  */
 [[nodiscard]] int blast(int infd, int outfd) noexcept;
 
@@ -223,7 +262,9 @@ copyat_using_rename(int src_dirfd, FilePath src, int dest_dirfd, FilePath dest)
  *              thread 2] holds the file X open for writing
  * - [new process from thread 2] exit
  * This function avoids this problem by opening the file X in a child process,
- * thus preventing the race.
+ * thus preventing the race. The child shares memory with the calling process
+ * (like after vfork()), so it is much cheaper than fork(). If the calling
+ * process is single-threaded, no child is created.
  */
 void thread_fork_safe_copyat(
     int src_dirfd, FilePath src, int dest_dirfd, FilePath dest, mode_t mode);
@@ -239,7 +280,9 @@ void thread_fork_safe_copyat(
  *              thread 2] holds the file X open for writing
  * - [new process from thread 2] exit
  * This function avoids this problem by opening the file X in a child process,
- * thus preventing the race.
+ * thus preventing the race. The child shares memory with the calling process
+ * (like after vfork()), so it is much cheaper than fork(). If the calling
+ * process is single-threaded, no child is created.
  */
 inline void thread_fork_safe_copy(FilePath src, FilePath dest, mode_t mode) {
     return thread_fork_safe_copyat(AT_FDCWD, src, AT_FDCWD, dest, mode);
@@ -276,6 +319,46 @@ copy_rat(int src_dirfd, FilePath src, int dest_dirfd, FilePath dest) noexcept;
  */
 [[nodiscard]] int copy_r(FilePath src, FilePath dest, bool create_subdirs = true) noexcept;
 
+/**
+ * @brief Copies (overrides) file/directory @p src to @p dest relative to a
+ *   directory file descriptor using multiple threads
+ * @details Works like copy_rat(), but subdirectories and batches of files are
+ *   copied concurrently. Worth using for large directory trees.
+ *
+ * @param src_dirfd directory file descriptor
+ * @param src source file/directory (relative to @p src_dirfd)
+ * @param dest_dirfd directory file descriptor
+ * @param dest destination file/directory (relative to @p dest_dirfd)
+ * @param threads_num number of threads to use (including the calling thread),
+ *   0 means the number of hardware threads
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @errors The same that occur for copy_rat() or ENOMEM
+ */
+[[nodiscard]] int copy_rat_parallel(
+    int src_dirfd, FilePath src, int dest_dirfd, FilePath dest,
+    unsigned threads_num = 0) noexcept;
+
+/**
+ * @brief Copies (overrides) recursively files and folders using multiple
+ *   threads
+ * @details Uses copy_rat_parallel()
+ *
+ * @param src source file/directory
+ * @param dest destination file/directory
+ * @param create_subdirs whether create subdirectories or not
+ * @param threads_num number of threads to use (including the calling thread),
+ *   0 means the number of hardware threads
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @errors The same that occur for copy_rat_parallel()
+ */
+[[nodiscard]] int copy_r_parallel(
+    FilePath src, FilePath dest, bool create_subdirs = true,
+    unsigned threads_num = 0) noexcept;
+
 [[nodiscard]] inline int rename(FilePath source, FilePath destination) noexcept {
     return rename(source.data(), destination.data());
 }
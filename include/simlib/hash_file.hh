@@ -0,0 +1,110 @@
+#pragma once
+
+#include "simlib/debug.hh"
+#include "simlib/file_descriptor.hh"
+#include "simlib/file_path.hh"
+#include "simlib/string_view.hh"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <functional>
+#include <sys/stat.h>
+#include <vector>
+
+/**
+ * @brief Calls @p consume with consecutive chunks of the @p fd contents from
+ *   the current file offset till EOF
+ * @details The next chunk is read by a reader thread (one per call, started
+ *   only if the file is longer than one chunk) while @p consume processes the
+ *   current one, so memory usage is constant (two 1 MiB buffers) and reading
+ *   overlaps with processing.
+ *
+ * @param fd file descriptor to read from
+ * @param consume called with every chunk; the chunk is valid only until
+ *   @p consume returns
+ *
+ * @errors If read(2) fails an exception of type std::runtime_error is thrown.
+ *   Exceptions thrown by @p consume are propagated.
+ */
+void read_file_in_chunks(int fd, const std::function<void(StringView)>& consume);
+
+/**
+ * @brief Splits the first @p size bytes of the @p fd contents into leaves of
+ *   @p leaf_size bytes and calls @p consume(leaf_no, chunk) with consecutive
+ *   chunks of every leaf
+ * @details Leaves are processed in parallel, but chunks of one leaf are passed
+ *   sequentially in one thread. The file offset of @p fd is not changed.
+ *
+ * @param fd file descriptor of a regular file
+ * @param size number of bytes to read (if the file turns out to be shorter,
+ *   the leaves past its end are shorter or empty)
+ * @param leaf_size size of a leaf (the last leaf may be shorter)
+ * @param threads_num number of threads to use, 0 means the number of hardware
+ *   threads
+ * @param consume called with every chunk; the chunk is valid only until
+ *   @p consume returns
+ *
+ * @errors If pread(2) fails an exception of type std::runtime_error is
+ *   thrown. Exceptions thrown by @p consume are propagated.
+ */
+void read_file_leaves_in_parallel(
+    int fd, off64_t size, size_t leaf_size, unsigned threads_num,
+    const std::function<void(size_t leaf_no, StringView chunk)>& consume);
+
+/// Returns the raw digest of the @p fd contents from the current file offset
+/// till EOF, computed with Hasher (e.g. Sha3_256, Sha256, Murmur3Hash128).
+/// Memory usage does not depend on the file size.
+template <class Hasher>
+typename Hasher::Digest hash_file(int fd) {
+    Hasher hasher;
+    read_file_in_chunks(fd, [&](StringView chunk) { hasher.update(chunk); });
+    return hasher.digest();
+}
+
+/// Returns the raw digest of the contents of @p file, computed with Hasher
+template <class Hasher>
+typename Hasher::Digest hash_file(FilePath file) {
+    FileDescriptor fd(file, O_RDONLY | O_CLOEXEC);
+    if (not fd.is_open()) {
+        THROW("Failed to open file `", file, '`', errmsg());
+    }
+    return hash_file<Hasher>(fd);
+}
+
+/**
+ * @brief Returns the tree hash of the @p fd contents, computed with Hasher in
+ *   parallel
+ * @details The file is split into leaves of @p leaf_size bytes and the result
+ *   is H(H(leaf_0) || H(leaf_1) || ... || H(leaf_n-1)), where H is Hasher. So
+ *   it differs from hash_file() and depends on @p leaf_size. Useful for very
+ *   large files, as leaves are hashed in parallel.
+ *
+ * @param fd file descriptor of a regular file (the file offset is ignored)
+ * @param leaf_size size of a leaf
+ * @param threads_num number of threads to use, 0 means the number of hardware
+ *   threads
+ *
+ * @errors The same as for read_file_leaves_in_parallel()
+ */
+template <class Hasher>
+typename Hasher::Digest
+hash_file_tree(int fd, size_t leaf_size = 64 << 20, unsigned threads_num = 0) {
+    struct stat64 st {};
+    if (fstat64(fd, &st)) {
+        THROW("fstat64()", errmsg());
+    }
+    // An empty file consists of one empty leaf
+    size_t leaves_num = std::max<size_t>((st.st_size + leaf_size - 1) / leaf_size, 1);
+    std::vector<Hasher> leaf_hashers(leaves_num);
+    read_file_leaves_in_parallel(
+        fd, st.st_size, leaf_size, threads_num, [&](size_t leaf_no, StringView chunk) {
+            leaf_hashers[leaf_no].update(chunk);
+        });
+
+    Hasher root;
+    for (auto& leaf_hasher : leaf_hashers) {
+        auto digest = leaf_hasher.digest();
+        root.update({reinterpret_cast<const char*>(digest.data()), digest.size()});
+    }
+    return root.digest();
+}
@@ -3,207 +3,234 @@
 #include "simlib/inplace_buff.hh"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
-#if 0 // Clang does not support std::launder yet
-#if __cplusplus > 201402L
-#warning "Since C++17 std::launder() has to be used to wrap the reinterpret_casts below"
-#endif
-#endif
-
-template <class T, size_t N>
+// Array that holds up to N elements inplace and uses memory obtained from
+// Allocator (e.g. std::pmr::polymorphic_allocator<T>) for the bigger sizes
+template <class T, size_t N, class Allocator = std::allocator<T>>
 class InplaceArray {
-    size_t size_{0}, max_size_{};
-    using Elem = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
-    Elem a_[N];
-    Elem* p_;
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>);
+
+    // Memory for trivially copyable elements that would come from
+    // std::allocator is managed with malloc() and realloc() instead, so that
+    // growing the array can often be done without copying
+    static constexpr bool uses_realloc = std::is_trivially_copyable_v<T> and
+        std::is_same_v<Allocator, std::allocator<T>> and
+        alignof(T) <= alignof(std::max_align_t);
+
+    size_t size_{0}, max_size_{N};
+    T* p_; // points to the first element of either a_ or the allocated memory
+    Allocator alloc_;
+    alignas(T) std::array<std::byte, N * sizeof(T)> a_;
+
+    template <class, size_t, class>
+    friend class InplaceArray;
 
-    [[nodiscard]] bool is_allocated() const noexcept { return p_ != a_; }
+    T* inplace_storage() noexcept { return reinterpret_cast<T*>(a_.data()); }
+
+    [[nodiscard]] bool is_allocated() const noexcept {
+        return p_ != reinterpret_cast<const T*>(a_.data());
+    }
+
+    T* allocate(size_t n) {
+        if constexpr (uses_realloc) {
+            if (n > SIZE_MAX / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            void* p = std::malloc(n * sizeof(T));
+            if (not p) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(p);
+        } else {
+            return AllocTraits::allocate(alloc_, n);
+        }
+    }
 
     void deallocate() noexcept {
         if (is_allocated()) {
-            delete[] p_;
+            if constexpr (uses_realloc) {
+                std::free(p_);
+            } else {
+                AllocTraits::deallocate(alloc_, p_, max_size_);
+            }
+            p_ = inplace_storage();
+            max_size_ = N;
         }
     }
 
     void destruct_and_deallocate() noexcept {
         std::destroy(begin(), end());
+        size_ = 0;
+        deallocate();
+    }
+
+    // Moves the elements to @p dest and destroys them in the old place
+    void relocate_to(T* dest) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size_ > 0) {
+                std::memcpy(static_cast<void*>(dest), p_, size_ * sizeof(T));
+            }
+        } else {
+            std::uninitialized_move(begin(), end(), dest);
+            std::destroy(begin(), end());
+        }
+    }
+
+    // Changes max_size to @p new_max_size (>= size()) preserving the elements
+    void reallocate(size_t new_max_size) {
+        if constexpr (uses_realloc) {
+            if (is_allocated()) {
+                if (new_max_size > SIZE_MAX / sizeof(T)) {
+                    throw std::bad_alloc();
+                }
+                void* new_p = std::realloc(p_, new_max_size * sizeof(T));
+                if (not new_p) {
+                    throw std::bad_alloc();
+                }
+                p_ = static_cast<T*>(new_p);
+                max_size_ = new_max_size;
+                return;
+            }
+        }
+
+        T* new_p = allocate(new_max_size);
+        try {
+            relocate_to(new_p);
+        } catch (...) {
+            if constexpr (uses_realloc) {
+                std::free(new_p);
+            } else {
+                AllocTraits::deallocate(alloc_, new_p, new_max_size);
+            }
+            throw;
+        }
         deallocate();
+        p_ = new_p;
+        max_size_ = new_max_size;
+    }
+
+    // Takes over elements of @p a (leaving it empty), its memory is taken over
+    // if it is allocated and compatible
+    template <size_t N1>
+    void take_over(InplaceArray<T, N1, Allocator>&& a) {
+        if (a.is_allocated() and a.size_ > N and alloc_ == a.alloc_) {
+            p_ = std::exchange(a.p_, a.inplace_storage());
+            size_ = std::exchange(a.size_, 0);
+            max_size_ = std::exchange(a.max_size_, N1);
+            return;
+        }
+
+        reserve_for(a.size_);
+        std::uninitialized_move(a.begin(), a.end(), begin());
+        size_ = a.size_;
+        a.destruct_and_deallocate();
     }
 
 public:
-    InplaceArray()
-    : max_size_(N)
-    , p_(a_) {}
-
-    explicit InplaceArray(size_t n)
-    : size_(n)
-    , max_size_(std::max(n, N))
-    , p_(n > N ? new Elem[n] : a_) {
-        std::uninitialized_default_construct(begin(), end());
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InplaceArray() noexcept(noexcept(Allocator()))
+    : InplaceArray(Allocator()) {}
+
+    explicit InplaceArray(const Allocator& alloc) noexcept
+    : p_(inplace_storage())
+    , alloc_(alloc) {}
+
+    // Elements are default-initialized, so e.g. for integers they are left
+    // uninitialized (handy for buffers that are about to be filled by read())
+    explicit InplaceArray(size_t n, const Allocator& alloc = Allocator())
+    : InplaceArray(alloc) {
+        resize(n);
     }
 
-    InplaceArray(size_t n, const T& val)
-    : size_(n)
-    , max_size_(std::max(n, N))
-    , p_(n > N ? new Elem[n] : a_) {
-        std::uninitialized_fill(begin(), end(), val);
+    InplaceArray(size_t n, const T& val, const Allocator& alloc = Allocator())
+    : InplaceArray(alloc) {
+        resize(n, val);
     }
 
 private:
     template <size_t N1>
-    InplaceArray(std::in_place_t /*unused*/, const InplaceArray<T, N1>& a)
-    : size_(a.size_)
-    , max_size_(std::max(size_, N))
-    , p_(size_ > N ? new Elem[size_] : a_) {
+    InplaceArray(std::in_place_t /*unused*/, const InplaceArray<T, N1, Allocator>& a)
+    : InplaceArray(AllocTraits::select_on_container_copy_construction(a.alloc_)) {
+        reserve_for(a.size_);
         std::uninitialized_copy(a.begin(), a.end(), begin());
+        size_ = a.size_;
     }
 
 public:
     template <size_t N1>
-    explicit InplaceArray(const InplaceArray<T, N1>& a)
+    explicit InplaceArray(const InplaceArray<T, N1, Allocator>& a)
     : InplaceArray(std::in_place, a) {}
 
     InplaceArray(const InplaceArray& a)
     : InplaceArray(std::in_place, a) {}
 
-private:
     template <size_t N1>
-    explicit InplaceArray(std::in_place_t /*unused*/, InplaceArray<T, N1>&& a)
-    : size_(a.size_)
-    , max_size_(std::max(size_, N)) {
-        if (size_ <= N) {
-            std::uninitialized_move(a.begin(), a.end(), begin());
-
-        } else if (a.is_allocated()) { // move the pointer
-            p_ = a.p_;
-            a.p_ = a.a_;
-            a.max_size_ = N1;
-
-        } else { // allocate memory and then move
-            p_ = new Elem[size_];
-            std::uninitialized_move(a.begin(), a.end(), begin());
-        }
-
-        a.size_ = 0;
+    explicit InplaceArray(InplaceArray<T, N1, Allocator>&& a)
+    : InplaceArray(a.alloc_) {
+        take_over(std::move(a));
     }
 
-public:
-    template <size_t N1>
-    explicit InplaceArray(InplaceArray<T, N1>&& a)
-    : InplaceArray(std::in_place, std::move(a)) {}
-
-    InplaceArray(InplaceArray&& a) noexcept
-    : InplaceArray(std::in_place, std::move(a)) {}
+    InplaceArray(InplaceArray&& a) noexcept(std::is_nothrow_move_constructible_v<T>)
+    : InplaceArray(a.alloc_) {
+        take_over(std::move(a));
+    }
 
     template <size_t N1>
-    InplaceArray& operator=(const InplaceArray<T, N1>& a) {
-        if (a.size_ <= N) {
-            destruct_and_deallocate();
-            p_ = a_;
-            max_size_ = N;
-            try {
-                std::uninitialized_copy(a.begin(), a.end(), begin());
-                size_ = a.size_;
-            } catch (...) {
-                size_ = 0;
-                throw;
-            }
-
-        } else if (a.size_ <= size_) {
-            // At first, potentially free memory
-            if (size_ > a.size_) {
-                std::destroy(begin() + a.size_, end());
-                size_ = a.size_;
-            }
+    InplaceArray& operator=(const InplaceArray<T, N1, Allocator>& a) {
+        if (static_cast<const void*>(&a) == this) {
+            return *this;
+        }
 
-            // It is OK to use std::copy as the objects in p_[0..a.size_] exist
+        if (a.size_ <= size_) {
+            // It is OK to use std::copy as the objects in [0, a.size_) exist
             std::copy(a.begin(), a.end(), begin());
-
+            std::destroy(begin() + a.size_, end());
+            size_ = a.size_;
+        } else if (a.size_ <= max_size_) {
+            std::copy(a.begin(), a.begin() + size_, begin());
+            std::uninitialized_copy(a.begin() + size_, a.end(), end());
+            size_ = a.size_;
         } else {
             destruct_and_deallocate();
-            try {
-                p_ = new Elem[a.size_];
-                max_size_ = size_ = a.size_;
-                std::uninitialized_copy(a.begin(), a.end(), begin());
-            } catch (...) {
-                p_ = a_;
-                size_ = 0;
-                max_size_ = N;
-                throw;
-            }
+            reserve_for(a.size_);
+            std::uninitialized_copy(a.begin(), a.end(), begin());
+            size_ = a.size_;
         }
 
         return *this;
     }
 
     InplaceArray& operator=(const InplaceArray& a) {
-        *this = InplaceArray(a);
-        return *this;
+        return operator=<N>(a);
     }
 
-private:
     template <size_t N1>
-    InplaceArray& assign(InplaceArray<T, N1>&& a) {
-        if (a.size_ <= N) {
-            destruct_and_deallocate();
-            p_ = a_;
-            max_size_ = N;
-            try {
-                std::uninitialized_move(a.begin(), a.end(), begin());
-                size_ = a.size_;
-            } catch (...) {
-                size_ = 0;
-                throw;
-            }
-        } else if (a.is_allocated()) {
-            destruct_and_deallocate();
-            p_ = a.p_;
-            size_ = a.size_;
-            max_size_ = a.max_size_;
-
-            a.p_ = a.a_;
-            a.max_size_ = N1;
-        } else if (a.size_ <= size_) {
-            // At first, potentially free memory
-            if (size_ > a.size_) {
-                std::destroy(begin() + a.size_, end());
-                size_ = a.size_;
-            }
-            // It is OK to use std::move as the objects in p_[0..a.size_] exist
-            std::move(a.begin(), a.end(), begin());
-        } else {
+    InplaceArray& operator=(InplaceArray<T, N1, Allocator>&& a) {
+        if (static_cast<const void*>(&a) != this) {
             destruct_and_deallocate();
-            try {
-                p_ = new Elem[a.size_];
-                std::uninitialized_move(a.begin(), a.end(), begin());
-                max_size_ = size_ = a.size_;
-            } catch (...) {
-                p_ = a_;
-                size_ = 0;
-                max_size_ = N;
-            }
+            take_over(std::move(a));
         }
-
-        a.size_ = 0;
-        return *this;
-    }
-
-public:
-    template <size_t N1>
-    InplaceArray& operator=(InplaceArray<T, N1>&& a) {
-        assign(std::in_place, std::move(a));
         return *this;
     }
 
     // NOLINTNEXTLINE(performance-noexcept-move-constructor)
     InplaceArray& operator=(InplaceArray&& a) {
-        if (&a != this) {
-            assign(std::in_place, std::move(a));
-        }
-        return *this;
+        return operator=<N>(std::move(a));
     }
 
     /**
@@ -215,10 +242,9 @@ public:
     void lossy_reserve_for(size_t n) {
         if (n > max_size_) {
             size_t new_max_size = std::max(max_size_ << 1, n);
-            auto new_p = std::make_unique<Elem[]>(new_max_size);
-            deallocate();
-            p_ = new_p.release();
-            size_ = 0;
+            auto new_p = allocate(new_max_size);
+            destruct_and_deallocate();
+            p_ = new_p;
             max_size_ = new_max_size;
         }
     }
@@ -230,24 +256,24 @@ public:
      */
     void reserve_for(size_t n) {
         if (n > max_size_) {
-            size_t new_max_size = std::max(max_size_ << 1, n);
-            auto new_p = std::make_unique<Elem[]>(new_max_size);
-            std::uninitialized_move(
-                iterator(new_p.get()), iterator(new_p.get() + size_), begin());
-            deallocate();
-            p_ = new_p.release();
-            max_size_ = new_max_size;
+            reallocate(std::max(max_size_ << 1, n));
         }
     }
 
     /**
-     * @brief Changes array's size and max_size if needed, preserves data
+     * @brief Changes array's size and max_size if needed, preserves data. New
+     *   elements are default-initialized, so e.g. integers are left
+     *   uninitialized.
      *
      * @param n new array's size
      */
     void resize(size_t n) {
-        reserve_for(n);
-        std::uninitialized_default_construct(begin(), begin() + n);
+        if (n < size_) {
+            std::destroy(begin() + n, end());
+        } else {
+            reserve_for(n);
+            std::uninitialized_default_construct(end(), begin() + n);
+        }
         size_ = n;
     }
 
@@ -258,133 +284,64 @@ public:
      * @param val the value to which the new elements will be set
      */
     void resize(size_t n, const T& val) {
-        reserve_for(n);
-
         if (n < size_) {
             std::destroy(begin() + n, end());
+        } else if (n > max_size_) {
+            T val_copy = val; // val may be an element of this array
+            reserve_for(n);
+            std::uninitialized_fill(end(), begin() + n, val_copy);
         } else {
             std::uninitialized_fill(end(), begin() + n, val);
         }
+        size_ = n;
     }
 
     template <class... Args>
     T& emplace_back(Args&&... args) {
-        reserve_for(size_ + 1);
-        return *(::new (std::addressof((*this)[size_++])) T(std::forward<Args>(args)...));
+        if (size_ == max_size_) {
+            T val(std::forward<Args>(args)...); // args may refer to an element
+            reserve_for(size_ + 1);
+            return *::new (static_cast<void*>(p_ + size_++)) T(std::move(val));
+        }
+        return *::new (static_cast<void*>(p_ + size_++)) T(std::forward<Args>(args)...);
     }
 
-    void clear() noexcept { size_ = 0; }
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
 
     [[nodiscard]] size_t size() const noexcept { return size_; }
 
-private:
-    template <class Type>
-    class Iterator {
-    public:
-        using iterator_category = std::random_access_iterator_tag;
-        using value_type = Type;
-        using difference_type = std::ptrdiff_t;
-        using pointer = Type*;
-        using reference = Type&;
-
-    private:
-        Elem* p = nullptr;
-
-        explicit Iterator(Elem* x)
-        : p(x) {}
-
-        friend class InplaceArray;
-
-    public:
-        Iterator() = default;
-
-        reference operator*() const noexcept { return *reinterpret_cast<T*>(p); }
-
-        pointer operator->() const noexcept { return reinterpret_cast<T*>(p); }
+    [[nodiscard]] size_t max_size() const noexcept { return max_size_; }
 
-        Iterator& operator++() noexcept {
-            ++p;
-            return *this;
-        }
-
-        // NOLINTNEXTLINE(readability-const-return-type)
-        const Iterator operator++(int) noexcept { return Iterator(p++); }
-
-        Iterator& operator--() noexcept {
-            --p;
-            return *this;
-        }
-
-        // NOLINTNEXTLINE(readability-const-return-type)
-        const Iterator operator--(int) noexcept { return Iterator(p++); }
-
-        reference operator[](difference_type n) const noexcept {
-            return *reinterpret_cast<T*>(p + n);
-        }
-
-        Iterator& operator+=(difference_type n) const noexcept {
-            p += n;
-            return *this;
-        }
-
-        Iterator operator+(difference_type n) const noexcept { return Iterator(p + n); }
-
-        Iterator& operator-=(difference_type n) const noexcept {
-            p -= n;
-            return *this;
-        }
-
-        Iterator operator-(difference_type n) const noexcept { return Iterator(p - n); }
-
-        friend bool operator==(Iterator a, Iterator b) noexcept { return (a.p == b.p); }
-
-        friend bool operator!=(Iterator a, Iterator b) noexcept { return (a.p != b.p); }
-
-        friend bool operator<(Iterator a, Iterator b) noexcept { return (a.p < b.p); }
-
-        friend bool operator>(Iterator a, Iterator b) noexcept { return (a.p > b.p); }
-
-        friend bool operator<=(Iterator a, Iterator b) noexcept { return (a.p <= b.p); }
-
-        friend bool operator>=(Iterator a, Iterator b) noexcept { return (a.p >= b.p); }
-
-        friend difference_type operator-(Iterator a, Iterator b) noexcept {
-            return (a.p - b.p);
-        }
-
-        friend Iterator operator+(difference_type n, Iterator b) noexcept {
-            return Iterator(n + b.p);
-        }
-    };
-
-public:
-    using iterator = Iterator<T>;
-    using const_iterator = Iterator<const T>;
+    [[nodiscard]] Allocator get_allocator() const noexcept { return alloc_; }
 
-    static_assert(sizeof(Elem) == sizeof(T), "Needed by data()");
-    T* data() noexcept { return std::addressof(front()); }
+    // The elements are created in the raw storage with placement new, so the
+    // pointer to the storage has to be laundered to point to the elements
+    T* data() noexcept { return size_ == 0 ? p_ : std::launder(p_); }
 
-    [[nodiscard]] const T* data() const noexcept { return std::addressof(front()); }
+    [[nodiscard]] const T* data() const noexcept { return size_ == 0 ? p_ : std::launder(p_); }
 
-    iterator begin() noexcept { return iterator(p_); }
+    iterator begin() noexcept { return data(); }
 
-    [[nodiscard]] const_iterator begin() const noexcept { return const_iterator(p_); }
+    [[nodiscard]] const_iterator begin() const noexcept { return data(); }
 
-    iterator end() noexcept { return iterator(p_ + size_); }
+    iterator end() noexcept { return data() + size_; }
 
-    [[nodiscard]] const_iterator end() const noexcept { return const_iterator(p_ + size_); }
+    [[nodiscard]] const_iterator end() const noexcept { return data() + size_; }
 
-    T& front() noexcept { return begin()[0]; }
+    T& front() noexcept { return data()[0]; }
 
-    [[nodiscard]] const T& front() const noexcept { return begin()[0]; }
+    [[nodiscard]] const T& front() const noexcept { return data()[0]; }
 
-    T& back() noexcept { return end()[-1]; }
+    T& back() noexcept { return data()[size_ - 1]; }
 
-    [[nodiscard]] const T& back() const noexcept { return end()[-1]; }
+    [[nodiscard]] const T& back() const noexcept { return data()[size_ - 1]; }
 
-    T& operator[](size_t i) noexcept { return begin()[i]; }
+    T& operator[](size_t i) noexcept { return data()[i]; }
 
-    const T& operator[](size_t i) const noexcept { return begin()[i]; }
+    const T& operator[](size_t i) const noexcept { return data()[i]; }
 
     ~InplaceArray() { destruct_and_deallocate(); }
 };
@@ -3,6 +3,11 @@
 #include "simlib/concat_common.hh"
 #include "simlib/string_view.hh"
 
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
 class InplaceBuffBase {
 public:
     size_t size = 0;
@@ -11,11 +16,14 @@ protected:
     size_t max_size_;
     char* p_;
     char* p_value_when_unallocated_;
+    // Memory for the data that does not fit inplace comes from resource_ or,
+    // if it is nullptr, from malloc() -- then growing uses realloc()
+    std::pmr::memory_resource* resource_ = nullptr;
 
 public:
     void make_copy_of(const char* data, size_t len) {
         if (len > max_size_) {
-            auto new_p = new char[len];
+            auto new_p = allocate(len);
             deallocate();
             p_ = new_p;
             max_size_ = len;
@@ -33,25 +41,37 @@ public:
     void lossy_resize(size_t n) {
         if (n > max_size_) {
             auto new_max_size = std::max(max_size_ << 1, n);
+            auto new_p = allocate(new_max_size);
             deallocate();
-            p_ = new char[new_max_size];
+            p_ = new_p;
             max_size_ = new_max_size;
         }
         size = n;
     }
 
     /**
-     * @brief Changes buffer's size and max_size if needed, preserves data
+     * @brief Changes buffer's size and max_size if needed, preserves data. The
+     *   new characters are left uninitialized, so the buffer can be filled
+     *   e.g. by read() without zeroing it first.
      *
      * @param n new buffer's size
      */
     constexpr void resize(size_t n) {
         if (n > max_size_) {
             size_t new_max_size = std::max(max_size_ << 1, n);
-            char* new_p = new char[new_max_size];
-            std::copy(p_, p_ + size, new_p);
-            deallocate();
-            p_ = new_p;
+            if (is_allocated() and not resource_) {
+                // realloc() can often grow the memory without copying it
+                auto new_p = static_cast<char*>(std::realloc(p_, new_max_size));
+                if (not new_p) {
+                    throw std::bad_alloc();
+                }
+                p_ = new_p;
+            } else {
+                char* new_p = allocate(new_max_size);
+                std::copy(p_, p_ + size, new_p);
+                deallocate();
+                p_ = new_p;
+            }
             max_size_ = new_max_size;
         }
         size = n;
@@ -129,9 +149,24 @@ protected:
         return (p_ != p_value_when_unallocated_);
     }
 
+    [[nodiscard]] char* allocate(size_t n) const {
+        if (resource_) {
+            return static_cast<char*>(resource_->allocate(n, 1));
+        }
+        auto p = static_cast<char*>(std::malloc(n));
+        if (not p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
     void deallocate() noexcept {
         if (is_allocated()) {
-            delete[] p_;
+            if (resource_) {
+                resource_->deallocate(p_, max_size_, 1);
+            } else {
+                std::free(p_);
+            }
             p_ = p_value_when_unallocated_;
             max_size_ = 0;
         }
@@ -140,6 +175,10 @@ protected:
 public:
     virtual ~InplaceBuffBase() { deallocate(); }
 
+    // Returns the memory resource used for the data that does not fit inplace
+    // or nullptr if it is malloc()
+    [[nodiscard]] std::pmr::memory_resource* resource() const noexcept { return resource_; }
+
     template <class... Args, std::enable_if_t<(is_string_argument<Args> and ...), int> = 0>
     constexpr InplaceBuffBase& append(Args&&... args) {
         [this](auto&&... str) {
@@ -178,7 +217,14 @@ public:
     constexpr explicit InplaceBuff(size_t n)
     : InplaceBuffBase(n, std::max(N, n), nullptr, nullptr) {
         p_value_when_unallocated_ = a_.data();
-        p_ = (n <= N ? p_value_when_unallocated_ : new char[n]);
+        p_ = (n <= N ? p_value_when_unallocated_ : allocate(n));
+    }
+
+    // The data that does not fit inplace will be stored in memory allocated
+    // from @p resource (nullptr means malloc())
+    explicit InplaceBuff(std::pmr::memory_resource* resource) noexcept
+    : InplaceBuff() {
+        resource_ = resource;
     }
 
     constexpr InplaceBuff(const InplaceBuff& ibuff)
@@ -187,7 +233,7 @@ public:
     }
 
     InplaceBuff(InplaceBuff&& ibuff) noexcept
-    : InplaceBuff() {
+    : InplaceBuff(ibuff.resource_) {
         if (ibuff.is_allocated()) {
             // Steal the allocated string
             p_ = std::exchange(ibuff.p_, ibuff.p_value_when_unallocated_);
@@ -202,7 +248,8 @@ public:
         class T,
         std::enable_if_t<
             not std::is_integral_v<std::decay_t<T>> and
-                not std::is_same_v<std::decay_t<T>, InplaceBuff>,
+                not std::is_same_v<std::decay_t<T>, InplaceBuff> and
+                not std::is_convertible_v<T, std::pmr::memory_resource*>,
             int> = 0>
     // NOLINTNEXTLINE(bugprone-forwarding-reference-overload): see enable_if
     constexpr explicit InplaceBuff(T&& str)
@@ -231,7 +278,7 @@ public:
 
     template <size_t M, std::enable_if_t<M != N, int> = 0>
     explicit InplaceBuff(InplaceBuff<M>&& ibuff) noexcept
-    : InplaceBuff() {
+    : InplaceBuff(ibuff.resource_) {
         if (ibuff.is_allocated() and ibuff.size > N) {
             // Steal the allocated string
             p_ = std::exchange(ibuff.p_, ibuff.p_value_when_unallocated_);
@@ -274,7 +321,9 @@ public:
 private:
     template <size_t M>
     InplaceBuff& assign_move_impl(InplaceBuff<M>&& ibuff) {
-        if (ibuff.is_allocated() and ibuff.max_size() >= max_size()) {
+        if (ibuff.is_allocated() and ibuff.max_size() >= max_size() and
+            ibuff.resource_ == resource_)
+        {
             // Steal the allocated string
             deallocate();
             p_ = std::exchange(ibuff.p_, ibuff.p_value_when_unallocated_);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "simlib/file_path.hh"
+#include "simlib/string_view.hh"
+
+#include <string>
+#include <sys/types.h>
+#include <utility>
+
+// Read-only view of the file contents. Regular files are mapped into memory
+// (so no copy is made), other files (pipes, procfs files etc.) are read into
+// a buffer.
+class MappedFile {
+    void* addr_ = nullptr; // nullptr if the file is not mapped
+    size_t mapped_len_ = 0;
+    size_t offset_ = 0; // offset of the contents within the mapping
+    size_t size_ = 0;
+    std::string buff_; // used if the file is not mapped
+
+    void unmap() noexcept;
+
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the contents of @p fd from @p beg to @p end
+     * @details If @p fd is not a regular file or its size is reported as 0
+     *   (e.g. procfs files), the contents are read from the current file
+     *   offset till EOF and then trimmed to [@p beg, @p end). The offset of
+     *   @p fd is not changed if the file is mapped. Note that truncating the
+     *   mapped file makes accessing the lost part of the contents raise
+     *   SIGBUS.
+     *
+     * @param fd file descriptor to read from
+     * @param beg begin offset (if negative, then is set to file_size + @p beg)
+     * @param end end offset (@p end < 0 means size of file)
+     *
+     * @errors If any error occurs an exception of type std::runtime_error is
+     *   thrown (may happen if fstat(2), mmap(2) or read(2) fails)
+     */
+    explicit MappedFile(int fd, off64_t beg = 0, off64_t end = -1);
+
+    /// Like MappedFile(int, off64_t, off64_t) but opens @p file first
+    explicit MappedFile(FilePath file, off64_t beg = 0, off64_t end = -1);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    : addr_(std::exchange(other.addr_, nullptr))
+    , mapped_len_(std::exchange(other.mapped_len_, 0))
+    , offset_(std::exchange(other.offset_, 0))
+    , size_(std::exchange(other.size_, 0))
+    , buff_(std::move(other.buff_)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            addr_ = std::exchange(other.addr_, nullptr);
+            mapped_len_ = std::exchange(other.mapped_len_, 0);
+            offset_ = std::exchange(other.offset_, 0);
+            size_ = std::exchange(other.size_, 0);
+            buff_ = std::move(other.buff_);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    [[nodiscard]] bool is_mapped() const noexcept { return addr_ != nullptr; }
+
+    [[nodiscard]] StringView contents() const noexcept {
+        if (addr_) {
+            return {static_cast<const char*>(addr_) + offset_, size_};
+        }
+        return buff_;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+/// Returns MappedFile with the contents of @p fd from @p beg to @p end. It is
+/// the zero-copy counterpart of get_file_contents(), see
+/// MappedFile::MappedFile(int, off64_t, off64_t) for details.
+inline MappedFile map_file_contents(int fd, off64_t beg = 0, off64_t end = -1) {
+    return MappedFile(fd, beg, end);
+}
+
+/// Returns MappedFile with the contents of @p file from @p beg to @p end. It is
+/// the zero-copy counterpart of get_file_contents(), see
+/// MappedFile::MappedFile(int, off64_t, off64_t) for details.
+inline MappedFile map_file_contents(FilePath file, off64_t beg = 0, off64_t end = -1) {
+    return MappedFile(file, beg, end);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "simlib/concat.hh"
+#include "simlib/file_descriptor.hh"
+#include "simlib/file_path.hh"
+
+/**
+ * @brief Creates an anonymous in-memory file (see memfd_create(2))
+ * @details The file is created with MFD_CLOEXEC | MFD_ALLOW_SEALING, so that
+ *   it can be sealed later with seal_memfd()
+ *
+ * @param name name of the file, visible only in /proc/<pid>/fd/
+ *
+ * @return file descriptor (opened for reading and writing) on success, -1 on
+ *   error
+ *
+ * @errors The same that occur for memfd_create(2)
+ */
+FileDescriptor open_memfd(CStringView name) noexcept;
+
+/**
+ * @brief Seals memfd @p fd against any modification and returns a read-only
+ *   file descriptor to it
+ * @details The returned file descriptor has O_CLOEXEC set. A process forked
+ *   by another thread while @p fd was open holds @p fd until it calls
+ *   execve(2), and executing the file fails with ETXTBSY in the meantime. To
+ *   get an executable memfd in a multi-threaded program, use
+ *   copy_to_sealed_memfd().
+ *
+ * @param fd file descriptor returned by open_memfd()
+ *
+ * @return read-only file descriptor on success, -1 on error
+ *
+ * @errors The same that occur for fcntl(2) with F_ADD_SEALS or open(2)
+ */
+FileDescriptor seal_memfd(int fd) noexcept;
+
+/**
+ * @brief Creates a sealed memfd with the contents of the file @p path
+ * @details The memfd is created, filled and sealed in a child process (see
+ *   call_in_vfork_like_child()) and passed back through a socket, so the
+ *   calling process never holds a writable file descriptor to it. Thus it can
+ *   be executed (e.g. with fexecve(3)) even if other threads fork
+ *   concurrently -- there is no file that could be busy (ETXTBSY).
+ *
+ * @param path path of the file to copy
+ * @param name name of the memfd, visible only in /proc/<pid>/fd/
+ *
+ * @return read-only file descriptor on success, -1 on error
+ *
+ * @errors The same that occur for open(2), socketpair(2),
+ *   call_in_vfork_like_child(), blast(), seal_memfd(), sendmsg(2) or
+ *   recvmsg(2)
+ */
+FileDescriptor copy_to_sealed_memfd(FilePath path, CStringView name) noexcept;
+
+/**
+ * @brief Returns a path under which the file descriptor @p fd can be
+ *   reopened by the current process or by any process that inherited @p fd
+ */
+inline auto fd_path(int fd) { return concat<32>("/dev/fd/", fd); }
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Process-wide metrics (counters, gauges and histograms) that can be rendered
+// in the Prometheus text exposition format. Updating a metric is lock-free and
+// does not allocate: counters and histograms are sharded between threads, so
+// that threads updating the same metric rarely touch the same cache line.
+//
+// Every metric registers itself upon construction and is never unregistered,
+// so metrics have to have static storage duration and unique names, e.g.
+//     metrics::Counter judged_tests{"judged_tests_total", "Number of judged tests"};
+namespace metrics {
+
+// To use as the Content-Type of the HTTP response containing render_prometheus()
+constexpr const char PROMETHEUS_CONTENT_TYPE[] = "text/plain; version=0.0.4; charset=utf-8";
+
+namespace detail {
+
+constexpr size_t SHARDS = 16;
+
+// Returns the next shard to assign to a thread (round-robin)
+size_t next_thread_shard() noexcept;
+
+inline size_t this_thread_shard() noexcept {
+    thread_local const size_t shard = next_thread_shard();
+    return shard;
+}
+
+struct alignas(64) PaddedCounter {
+    std::atomic<uint64_t> val{0};
+};
+
+} // namespace detail
+
+class Metric {
+    const char* name_;
+    const char* help_;
+    Metric* next_ = nullptr; // in the list of all metrics
+
+    friend std::string render_prometheus();
+
+protected:
+    Metric(const char* name, const char* help) noexcept;
+
+public:
+    Metric(const Metric&) = delete;
+    Metric(Metric&&) = delete;
+    Metric& operator=(const Metric&) = delete;
+    Metric& operator=(Metric&&) = delete;
+    // Does not unregister the metric, hence the static storage duration requirement
+    virtual ~Metric() = default;
+
+    [[nodiscard]] const char* name() const noexcept { return name_; }
+
+    [[nodiscard]] const char* help() const noexcept { return help_; }
+
+    // Appends the metric's samples in the Prometheus text format to @p out
+    virtual void append_samples(std::string& out) const = 0;
+
+    // Returns the Prometheus metric type e.g. "counter"
+    [[nodiscard]] virtual const char* type() const noexcept = 0;
+};
+
+// Monotonically increasing value
+class Counter : public Metric {
+    std::array<detail::PaddedCounter, detail::SHARDS> shards_{};
+
+public:
+    Counter(const char* name, const char* help) noexcept
+    : Metric(name, help) {}
+
+    void inc(uint64_t n = 1) noexcept {
+        shards_[detail::this_thread_shard()].val.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t value() const noexcept;
+
+    void append_samples(std::string& out) const override;
+
+    [[nodiscard]] const char* type() const noexcept override { return "counter"; }
+};
+
+// Value that can go up and down, e.g. queue length. Not sharded, as set()
+// has to be atomic.
+class Gauge : public Metric {
+    std::atomic<int64_t> val_{0};
+
+public:
+    Gauge(const char* name, const char* help) noexcept
+    : Metric(name, help) {}
+
+    void set(int64_t val) noexcept { val_.store(val, std::memory_order_relaxed); }
+
+    void add(int64_t n) noexcept { val_.fetch_add(n, std::memory_order_relaxed); }
+
+    void sub(int64_t n) noexcept { val_.fetch_sub(n, std::memory_order_relaxed); }
+
+    void inc() noexcept { add(1); }
+
+    void dec() noexcept { sub(1); }
+
+    [[nodiscard]] int64_t value() const noexcept {
+        return val_.load(std::memory_order_relaxed);
+    }
+
+    void append_samples(std::string& out) const override;
+
+    [[nodiscard]] const char* type() const noexcept override { return "gauge"; }
+};
+
+// Histogram of unsigned integer values with log-linear buckets: every range
+// [2^k, 2^(k+1)) is split into SUB_BUCKETS equal buckets, so the relative
+// error of the bucket bounds is at most 1 / SUB_BUCKETS. Only the non-empty
+// buckets are rendered (plus the "+Inf" one), so the histogram covers the
+// whole uint64_t range without producing hundreds of series.
+class Histogram : public Metric {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+
+    std::array<Shard, detail::SHARDS> shards_{};
+    unsigned unit_decimals_;
+
+public:
+    // Observed values are rendered divided by 10^@p unit_decimals, e.g. 9 for
+    // durations observed in nanoseconds and rendered in seconds
+    Histogram(const char* name, const char* help, unsigned unit_decimals = 0) noexcept
+    : Metric(name, help)
+    , unit_decimals_(unit_decimals) {}
+
+    static constexpr size_t bucket_of(uint64_t val) noexcept {
+        if (val < SUB_BUCKETS) {
+            return val;
+        }
+        size_t exp = 63 - __builtin_clzll(val);
+        size_t sub = (val >> (exp - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (exp - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+    }
+
+    // Returns the greatest value that falls into the bucket @p bucket
+    static constexpr uint64_t bucket_upper_bound(size_t bucket) noexcept {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        size_t exp = (bucket - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+        uint64_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        uint64_t width = uint64_t{1} << (exp - SUB_BUCKET_BITS);
+        return ((SUB_BUCKETS | sub) << (exp - SUB_BUCKET_BITS)) + (width - 1);
+    }
+
+    void observe(uint64_t val) noexcept {
+        auto& shard = shards_[detail::this_thread_shard()];
+        shard.buckets[bucket_of(val)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(val, std::memory_order_relaxed);
+    }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets;
+        uint64_t sum;
+        uint64_t count;
+    };
+
+    [[nodiscard]] Snapshot snapshot() const noexcept;
+
+    void append_samples(std::string& out) const override;
+
+    [[nodiscard]] const char* type() const noexcept override { return "histogram"; }
+};
+
+// Histogram of durations rendered in seconds (as Prometheus recommends)
+class DurationHistogram : public Histogram {
+public:
+    DurationHistogram(const char* name, const char* help) noexcept
+    : Histogram(name, help, 9) {}
+
+    void observe(std::chrono::nanoseconds duration) noexcept {
+        Histogram::observe(duration.count() < 0 ? 0 : duration.count());
+    }
+};
+
+// Returns all metrics in the Prometheus text exposition format, sorted by name
+std::string render_prometheus();
+
+} // namespace metrics
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "simlib/inplace_buff.hh"
+
+#include <array>
+#include <cstdint>
+
+// Incremental MurmurHash3 (x64, 128-bit variant). It is a fast
+// non-cryptographic hash, suitable e.g. for cache keys. Digests are equal to
+// the ones of the reference MurmurHash3_x64_128() (h1 and h2 stored
+// little-endian).
+class Murmur3Hash128 {
+    uint64_t h1_;
+    uint64_t h2_;
+    std::array<unsigned char, 16> buff_{};
+    size_t buff_len_ = 0;
+    uint64_t total_len_ = 0;
+
+    void process_blocks(const unsigned char* data, size_t blocks) noexcept;
+
+public:
+    static constexpr size_t digest_size = 16;
+    using Digest = std::array<unsigned char, digest_size>;
+
+    explicit Murmur3Hash128(uint32_t seed = 0) noexcept
+    : h1_(seed)
+    , h2_(seed) {}
+
+    // Appends @p str to the hashed data
+    void update(StringView str) noexcept;
+
+    // Returns hash of the data passed to update(). Does not modify the state,
+    // so more data may be appended afterwards.
+    [[nodiscard]] Digest digest() const noexcept;
+};
+
+// Returns raw (16 bytes long) hash
+inline Murmur3Hash128::Digest murmur3_128_digest(StringView str, uint32_t seed = 0) noexcept {
+    Murmur3Hash128 hash(seed);
+    hash.update(str);
+    return hash.digest();
+}
+
+// Returns 32 bytes long hash ([a-f0-9]+)
+InplaceBuff<32> murmur3_128(StringView str, uint32_t seed = 0);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "simlib/file_descriptor.hh"
+#include "simlib/string_view.hh"
+
+#include <string>
+#include <vector>
+
+struct PipeRelayChannel {
+    FileDescriptor source; // read end of a pipe
+    FileDescriptor sink; // write end of a pipe
+    CStringView name; // used in the transcript
+};
+
+/**
+ * @brief Relays data from source to sink of every channel until every source
+ *   reaches EOF or its sink loses all readers
+ * @details Data is moved with splice(2), so it is not copied through
+ *   userspace. The processes on both ends see the same as if they were
+ *   connected directly: once a source reaches EOF, its sink is closed, and
+ *   once a sink loses all readers, its source is closed. SIGPIPE is blocked in
+ *   the calling thread during the call.
+ *
+ * @param channels channels to relay, their file descriptors are closed on
+ *   return
+ * @param transcript_max_len if non-zero, up to this many bytes of the relayed
+ *   data are copied (with tee(2)) to the returned transcript, in the order they
+ *   were relayed. A line "[<channel name>]" precedes data relayed through a
+ *   different channel than the data before it, and "[truncated]" marks the end
+ *   of the truncated transcript.
+ *
+ * @return the transcript
+ *
+ * @errors Throws an exception std::runtime_error if any syscall fails
+ */
+std::string relay_pipes(std::vector<PipeRelayChannel>& channels, size_t transcript_max_len);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "simlib/file_descriptor.hh"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+// Memory and CPU usage of a process
+struct ProcSample {
+    std::chrono::nanoseconds time{0}; // since the start of periodic sampling
+    uint64_t vm_size = 0; // virtual memory size (in bytes)
+    uint64_t rss = 0; // resident set size (in bytes)
+    std::chrono::nanoseconds utime{0}; // CPU time spent in user mode
+    std::chrono::nanoseconds stime{0}; // CPU time spent in kernel mode
+    uint32_t threads = 0;
+};
+
+// Reads memory and CPU usage of a process from /proc/<pid>/{statm,stat}. The
+// files are kept open and are parsed without any allocation, so sampling is
+// cheap enough to be done e.g. on every traced syscall.
+class ProcSampler {
+    FileDescriptor statm_fd_;
+    FileDescriptor stat_fd_;
+
+public:
+    struct Statm {
+        uint64_t vm_size; // in pages
+        uint64_t rss; // in pages
+    };
+
+    /// Opens /proc/@p pid/statm and /proc/@p pid/stat. On error throws
+    /// std::runtime_error.
+    explicit ProcSampler(pid_t pid);
+
+    /// Returns virtual memory size and resident set size of the process. It
+    /// is cheaper than sample(). On error throws std::runtime_error.
+    [[nodiscard]] Statm read_statm() const;
+
+    /// Returns the current state of the process (time is set to 0). On error
+    /// throws std::runtime_error.
+    [[nodiscard]] ProcSample sample() const;
+};
+
+// Scheduler statistics of a thread
+struct ProcSchedStat {
+    std::chrono::nanoseconds run_time{0}; // time spent on a CPU
+    // time spent runnable but waiting for a CPU
+    std::chrono::nanoseconds run_queue_wait_time{0};
+    uint64_t timeslices = 0; // number of times the thread was run on a CPU
+
+    // Returns the statistics of the period between @p earlier and this
+    [[nodiscard]] ProcSchedStat since(const ProcSchedStat& earlier) const noexcept {
+        return {
+            run_time - earlier.run_time, run_queue_wait_time - earlier.run_queue_wait_time,
+            timeslices - earlier.timeslices};
+    }
+};
+
+/// Reads /proc/@p pid/schedstat. It describes only the thread @p pid, i.e. for
+/// a process only its main thread. It can be read also after the process
+/// exits, until it is waited. Returns std::nullopt if the kernel does not
+/// provide it (CONFIG_SCHED_INFO is disabled), on other errors throws
+/// std::runtime_error.
+std::optional<ProcSchedStat> read_proc_schedstat(pid_t pid);
+
+// Samples a process periodically in a separate thread. Sampling stops when
+// stop() is called or the process cannot be sampled anymore (e.g. it has been
+// waited).
+class PeriodicProcSampler {
+    std::mutex mtx_;
+    std::condition_variable stop_cv_;
+    bool stop_requested_ = false;
+    std::vector<ProcSample> samples_;
+    std::thread thread_;
+
+public:
+    /// The first sample is taken immediately. On error (e.g. if @p pid does
+    /// not exist) throws std::runtime_error.
+    PeriodicProcSampler(pid_t pid, std::chrono::nanoseconds interval);
+
+    PeriodicProcSampler(const PeriodicProcSampler&) = delete;
+    PeriodicProcSampler(PeriodicProcSampler&&) = delete;
+    PeriodicProcSampler& operator=(const PeriodicProcSampler&) = delete;
+    PeriodicProcSampler& operator=(PeriodicProcSampler&&) = delete;
+
+    ~PeriodicProcSampler() { (void)stop(); }
+
+    /// Stops sampling and returns the samples taken. Subsequent calls return
+    /// an empty vector.
+    std::vector<ProcSample> stop() noexcept;
+};
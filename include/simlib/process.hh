@@ -22,35 +22,60 @@ std::string executable_path(pid_t pid);
 /**
  * @brief Get a vector of processes pids which are instances of one of
  *   @p exec_set
- * @details Function check every accessible process if matches
+ * @details Function check every accessible process if matches. Processes are
+ *   listed with getdents64(2) on /proc and their executables are read with
+ *   readlinkat(2) relative to it.
  *
  * @param exec_set paths to executables (if all are absolute, then getting CWD
  *   is omitted)
  * @param include_me whether include the calling process in the result
  *   if matches or not
+ * @param threads_num number of threads checking the processes, 0 means the
+ *   number of hardware threads
  *
  * @return vector of pids of matched processes
  *
- * @errors Exceptions from get_cwd() or if opendir(2) fails then
+ * @errors Exceptions from get_cwd() or if opening or reading /proc fails then
  *   std::runtime_error will be thrown
  */
-std::vector<pid_t>
-find_processes_by_executable_path(std::vector<std::string> exec_set, bool include_me = false);
+std::vector<pid_t> find_processes_by_executable_path(
+    std::vector<std::string> exec_set, bool include_me = false, unsigned threads_num = 1);
 /**
  * @brief Kills processes that have executable files in @p exec_set
- * @details First tries with SIGTERM, but after @p wait_timeout sends SIGKILL if
- *   @p kill_after_waiting is true
+ * @details First tries with @p terminate_signal, but after @p wait_timeout
+ *   sends SIGKILL if @p kill_after_waiting is true. The processes are signaled
+ *   and waited for through pidfds, so a process that reuses the pid of a dead
+ *   one is never signaled.
  *
  * @param exec_set paths to executables (if absolute, getting CWD is omitted)
  * @param wait_timeout how long to wait for processes to die (if unset, wait
  *   indefinitely)
  * @param kill_after_waiting whether to send SIGKILL if process is still alive
  *   after wait_timeout
+ * @param threads_num number of threads looking for the processes (see
+ *   find_processes_by_executable_path())
  */
 void kill_processes_by_exec(
     std::vector<std::string> exec_set,
     std::optional<std::chrono::duration<double>> wait_timeout = std::nullopt,
-    bool kill_after_waiting = false, int terminate_signal = SIGTERM);
+    bool kill_after_waiting = false, int terminate_signal = SIGTERM, unsigned threads_num = 1);
+
+/**
+ * @brief Calls @p func(@p arg) in a child process that shares memory with the
+ *   calling process, but not its file descriptor table, and suspends the
+ *   calling thread until the child exits (like vfork(2))
+ * @details File descriptors opened by @p func are closed when the child exits,
+ *   so no process forked concurrently by another thread can inherit them. All
+ *   signals are blocked in the child, as it shares memory with the caller.
+ *   @p func runs on its own stack of 256 KiB.
+ *
+ * @return the value returned by @p func (as an exit status, so from [0, 255])
+ *   on success, -1 on error
+ *
+ * @errors The same that occur for mmap(2), clone(2) or waitid(2), or ECHILD if
+ *   the child was killed by a signal
+ */
+int call_in_vfork_like_child(int (*func)(void*), void* arg) noexcept;
 
 enum class ArchKind : int8_t {
     i386 = 0,
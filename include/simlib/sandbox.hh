@@ -1,8 +1,10 @@
 #pragma once
 
 #include "simlib/file_descriptor.hh"
+#include "simlib/proc_sampler.hh"
 #include "simlib/spawner.hh"
 
+#include <optional>
 #include <seccomp.h>
 #include <vector>
 
@@ -33,7 +35,24 @@ public:
 
 class Sandbox : protected Spawner {
 public:
-    using AllowedFile = std::pair<std::string, OpenAccess>;
+    struct AllowedFile {
+        std::string path;
+        OpenAccess access;
+        int fd = -1; // If non-negative, the file is granted by file descriptor
+
+        AllowedFile(std::string file_path, OpenAccess acc)
+        : path(std::move(file_path))
+        , access(acc) {}
+
+        // The file descriptor @p file_fd (that has to be greater than
+        // STDERR_FILENO) will stay open in the sandboxed process under the
+        // same number and the sandboxed process will be allowed to reopen it
+        // via fd_path(@p file_fd) or "/proc/self/fd/<file_fd>". If @p file_fd
+        // is opened with a different access mode than @p acc, the sandboxed
+        // process gets the file reopened with @p acc instead (with its own
+        // file offset), so e.g. a file granted RDONLY is never writable
+        AllowedFile(int file_fd, OpenAccess acc);
+    };
 
 private:
     pid_t tracee_pid_{};
@@ -45,8 +64,10 @@ private:
 
     std::string message_to_set_in_exit_stat_; // if non-empty it will be set in ExitStat
 
-    FileDescriptor tracee_statm_fd_; // For tracking vm_peak (vm stands for virtual memory)
+    // For tracking vm_peak (vm stands for virtual memory) and rss_peak
+    std::optional<ProcSampler> tracee_sampler_;
     uint64_t tracee_vm_peak_{}; // In pages
+    uint64_t tracee_rss_peak_{}; // In pages
 
     /// Adds rule to x86_ctx_ and x86_64_ctx_
     template <class... T>
@@ -59,11 +80,16 @@ private:
 
     void reset_callbacks() noexcept;
 
+    /// Returns the current VM size of the tracee (in pages) and updates
+    /// tracee_rss_peak_
     uint64_t get_tracee_vm_size();
 
     void update_tracee_vm_peak(uint64_t curr_vm_size);
 
-    void update_tracee_vm_peak() { update_tracee_vm_peak(get_tracee_vm_size()); }
+    /// Updates tracee_vm_peak_ and sets tracee_rss_peak_ to the peak RSS
+    /// since execve() kept by the kernel; used when the tracee may be about to
+    /// die
+    void update_tracee_peaks();
 
 public:
     Sandbox();
@@ -86,7 +112,8 @@ public:
      *   @p opts.time_limit and @p opts.memory_limit under seccomp(2) and
      *   ptrace(2)
      * @details
-     *   @p exec is called via execvp()
+     *   @p exec is called via execvp(), or if @p opts.exec_fd is set,
+     *   @p opts.exec_fd is executed via fexecve()
      *   This function is thread-safe.
      *   IMPORTANT: To function properly this function uses internally signal
      *     SIGRTMIN and installs handler for it. So be aware that using these
@@ -105,7 +132,8 @@ public:
      *   working_dir set to "", "." or "./" disables changing working
      *   directory)
      * @param allowed_files list of files (with access modes) that the
-     *   sandboxed program is allowed to open
+     *   sandboxed program is allowed to open; files granted by file descriptor
+     *   are inherited by the sandboxed program
      * @param do_in_parent_after_fork function taking child's pid as an argument
      *   that will be called in the parent process just after fork() -- useful
      *   for closing pipe ends
@@ -118,6 +146,14 @@ public:
      *     }
      *   - rusage: resource used (see getrusage(2)).
      *   - vm_peak: peak virtual memory size [bytes]
+     *   - rss_peak: peak resident set size [bytes] since execve(). It is
+     *       read from the kernel (VmHWM) whenever the tracee may be about to
+     *       die, so it accounts for the page faults too. If the tracee dies
+     *       without being stopped before (e.g. it is killed with SIGKILL by
+     *       someone else), only RSS sampled at the same moments as vm_peak
+     *       and in profile is accounted.
+     *   - profile: samples taken every @p opts.sampling_interval since
+     *       execve()
      *   - message: detailed info about error, etc.
      *
      * @errors Throws an exception std::runtime_error with appropriate
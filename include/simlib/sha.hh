@@ -2,9 +2,62 @@
 
 #include "simlib/inplace_buff.hh"
 
+#include <array>
+#include <cstdint>
+
 // SHA-3
 
-// Returns 48 bytes long hash ([a-f0-9]+)
+namespace detail {
+
+// Absorbs @p str into the Keccak @p state (of rate @p rate bytes) in which
+// @p pos bytes of the current block have already been absorbed. Returns the new
+// value of pos.
+size_t sha3_absorb(unsigned char* state, size_t rate, size_t pos, StringView str) noexcept;
+
+// Pads the absorbed data and squeezes @p out_len (<= @p rate) bytes of hash
+// into @p out
+void sha3_finalize(
+    unsigned char* state, size_t rate, size_t pos, unsigned char* out,
+    size_t out_len) noexcept;
+
+} // namespace detail
+
+// Incremental SHA-3 with digest of DIGEST_SIZE bytes
+template <size_t DIGEST_SIZE>
+class Sha3 {
+    static_assert(
+        DIGEST_SIZE == 28 or DIGEST_SIZE == 32 or DIGEST_SIZE == 48 or DIGEST_SIZE == 64);
+
+    std::array<unsigned char, 200> state_{};
+    size_t pos_ = 0; // in the current block
+
+public:
+    static constexpr size_t digest_size = DIGEST_SIZE;
+    static constexpr size_t rate = 200 - 2 * DIGEST_SIZE; // in bytes
+    using Digest = std::array<unsigned char, digest_size>;
+
+    // Appends @p str to the hashed data
+    void update(StringView str) noexcept {
+        pos_ = detail::sha3_absorb(state_.data(), rate, pos_, str);
+    }
+
+    // Returns hash of the data passed to update(). After this call the object
+    // has to be reset before being used again.
+    [[nodiscard]] Digest digest() noexcept {
+        Digest res;
+        detail::sha3_finalize(state_.data(), rate, pos_, res.data(), res.size());
+        return res;
+    }
+
+    void reset() noexcept { *this = Sha3{}; }
+};
+
+using Sha3_224 = Sha3<28>;
+using Sha3_256 = Sha3<32>;
+using Sha3_384 = Sha3<48>;
+using Sha3_512 = Sha3<64>;
+
+// Returns 56 bytes long hash ([a-f0-9]+)
 InplaceBuff<56> sha3_224(StringView str);
 
 // Returns 64 bytes long hash ([a-f0-9]+)
@@ -15,3 +68,38 @@ InplaceBuff<96> sha3_384(StringView str);
 
 // Returns 128 bytes long hash ([a-f0-9]+)
 InplaceBuff<128> sha3_512(StringView str);
+
+// SHA-256
+
+// Incremental SHA-256. Uses the SHA extensions of x86 CPUs if available.
+class Sha256 {
+    std::array<uint32_t, 8> state_;
+    std::array<unsigned char, 64> buff_{};
+    size_t buff_len_ = 0;
+    uint64_t total_len_ = 0;
+
+public:
+    static constexpr size_t digest_size = 32;
+    using Digest = std::array<unsigned char, digest_size>;
+
+    Sha256() noexcept;
+
+    // Appends @p str to the hashed data
+    void update(StringView str) noexcept;
+
+    // Returns hash of the data passed to update(). After this call the object
+    // has to be reset before being used again.
+    [[nodiscard]] Digest digest() noexcept;
+
+    void reset() noexcept { *this = Sha256{}; }
+};
+
+// Returns raw (32 bytes long) hash
+inline Sha256::Digest sha256_digest(StringView str) noexcept {
+    Sha256 sha;
+    sha.update(str);
+    return sha.digest();
+}
+
+// Returns 64 bytes long hash ([a-f0-9]+)
+InplaceBuff<64> sha256(StringView str);
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "simlib/debug.hh"
+
+#include <cerrno>
 #include <csignal>
 #include <utility>
 
-// Block all signals
+// Block all signals, or only the signals in the given mask
 template <int (*func)(int, const sigset_t*, sigset_t*)>
 class SignalBlockerBase {
 private:
@@ -12,7 +15,16 @@ private:
 public:
     const static sigset_t empty_mask, full_mask;
 
-    SignalBlockerBase() noexcept { block(); }
+    SignalBlockerBase() noexcept { (void)block(); }
+
+    // Throws if blocking fails, so that the signals are not left unblocked
+    // silently
+    explicit SignalBlockerBase(const sigset_t& mask) {
+        // sigprocmask() sets errno, pthread_sigmask() returns the error number
+        if (int rc = block(mask)) {
+            THROW("Failed to block signals", errmsg(rc == -1 ? errno : rc));
+        }
+    }
 
     SignalBlockerBase(const SignalBlockerBase&) = delete;
     SignalBlockerBase(SignalBlockerBase&&) = delete;
@@ -21,9 +33,19 @@ public:
 
     [[nodiscard]] int block() noexcept { return func(SIG_SETMASK, &full_mask, &old_mask); }
 
+    // Blocks signals from @p mask in addition to the already blocked ones
+    [[nodiscard]] int block(const sigset_t& mask) noexcept {
+        return func(SIG_BLOCK, &mask, &old_mask);
+    }
+
     [[nodiscard]] int unblock() noexcept { return func(SIG_SETMASK, &old_mask, nullptr); }
 
-    ~SignalBlockerBase() noexcept { unblock(); }
+    // Whether @p signum was blocked before the last block()
+    [[nodiscard]] bool was_blocked(int signum) const noexcept {
+        return sigismember(&old_mask, signum) == 1;
+    }
+
+    ~SignalBlockerBase() noexcept { (void)unblock(); }
 
 private:
     static sigset_t empty_mask_val() noexcept {
@@ -3,15 +3,18 @@
 #include "simlib/debug.hh"
 #include "simlib/file_manip.hh"
 #include "simlib/file_path.hh"
+#include "simlib/memfd.hh"
 #include "simlib/sandbox.hh"
 #include "simlib/sim/compile.hh"
 #include "simlib/sim/simfile.hh"
 #include "simlib/temporary_directory.hh"
 #include "simlib/time.hh"
 #include "simlib/to_string.hh"
+#include "simlib/tracing.hh"
 #include "simlib/utilities.hh"
 
 #include <utility>
+#include <vector>
 
 namespace sim {
 
@@ -48,6 +51,16 @@ public:
         std::chrono::nanoseconds runtime, time_limit;
         uint64_t memory_consumed, memory_limit; // in bytes
         std::string comment;
+        // Interaction between the solution and the checker (interactive
+        // problems only), recorded if JudgeWorker::interactive_transcript_max_len
+        // is non-zero
+        std::string transcript;
+        // Time the solution spent waiting for a CPU, set if
+        // JudgeWorker::read_schedstat is true
+        std::optional<std::chrono::nanoseconds> run_queue_wait_time;
+        // CPU runtimes of all the runs of the solution in the order of running,
+        // empty if the solution was run only once (see JudgeWorker::rerun_policy)
+        std::vector<std::chrono::nanoseconds> all_runtimes;
 
         Test(
             std::string n, Status s, std::chrono::nanoseconds rt, std::chrono::nanoseconds tl,
@@ -59,6 +72,16 @@ public:
         , memory_consumed(mc)
         , memory_limit(ml)
         , comment(std::move(c)) {}
+
+        // Appends "<runtime> / <time limit> s  <memory consumed> / <memory limit>
+        // KiB" (with the runtime right-aligned to 4 characters) to @p str
+        void append_resources_usage(std::string& str) const {
+            auto rt = ::to_string(floor_to_10ms(runtime), false);
+            append_padded(str, rt, 4);
+            back_insert(
+                str, " / ", ::to_string(floor_to_10ms(time_limit), false), " s  ",
+                memory_consumed >> 10, " / ", memory_limit >> 10, " KiB");
+        }
     };
 
     struct Group {
@@ -81,17 +104,22 @@ public:
     template <class Func>
     std::string pretty_dump(Func&& span_status) const {
         std::string res = "{\n";
+        // Reserve enough space up front, so that appending does not reallocate
+        size_t expected_len = res.size() + 1;
+        for (auto const& group : groups) {
+            expected_len += 64;
+            for (auto const& test : group.tests) {
+                expected_len += 128 + test.name.size() + test.comment.size();
+            }
+        }
+        res.reserve(expected_len);
+
         for (auto const& group : groups) {
             for (auto const& test : group.tests) {
-                back_insert(
-                    res, "  ", padded_string(test.name, 11, LEFT),
-                    padded_string(
-                        intentional_unsafe_string_view(
-                            ::to_string(floor_to_10ms(test.runtime), false)),
-                        4),
-                    " / ", ::to_string(floor_to_10ms(test.time_limit), false), " s  ",
-                    test.memory_consumed >> 10, " / ", test.memory_limit >> 10,
-                    " KiB    Status: ");
+                res += "  ";
+                append_padded(res, test.name, 11, LEFT);
+                test.append_resources_usage(res);
+                res += "    Status: ";
                 // Status
                 res += span_status(test.status);
 
@@ -209,6 +237,7 @@ class VerboseJudgeLogger : public JudgeLogger {
     bool first_test_after_final_score_{};
     InplaceBuff<8> last_gid;
     bool final_{};
+    std::string line_; // reused to format log lines
 
     template <class... Args, std::enable_if_t<(is_string_argument<Args> and ...), int> = 0>
     auto log(Args&&... args) {
@@ -219,6 +248,7 @@ class VerboseJudgeLogger : public JudgeLogger {
     void log_test(
         const StringView& test_name, const JudgeReport::Test& test_report,
         Sandbox::ExitStat es, Func&& func) {
+        TRACE_SPAN("log test");
         if (after_final_score_) {
             auto gid = sim::Simfile::TestNameComparator::split(test_name).gid;
             if (first_test_after_final_score_) {
@@ -230,15 +260,12 @@ class VerboseJudgeLogger : public JudgeLogger {
             last_gid = gid;
         }
 
-        auto tmplog =
-            log("  ", padded_string(test_name, 12, LEFT), ' ',
-                padded_string(
-                    intentional_unsafe_string_view(
-                        ::to_string(floor_to_10ms(test_report.runtime), false)),
-                    4),
-                " / ", ::to_string(floor_to_10ms(test_report.time_limit), false), " s  ",
-                test_report.memory_consumed >> 10, " / ", test_report.memory_limit >> 10,
-                " KiB  Status: ");
+        line_ = "  ";
+        append_padded(line_, test_name, 12, LEFT);
+        line_ += ' ';
+        test_report.append_resources_usage(line_);
+        line_ += "  Status: ";
+        auto tmplog = log(line_);
         // Status
         switch (test_report.status) {
         case JudgeReport::Test::TLE: tmplog("\033[1;33mTLE\033[m"); break;
@@ -255,7 +282,17 @@ class VerboseJudgeLogger : public JudgeLogger {
         // Rest
         tmplog(
             " [ CPU: ", ::to_string(es.cpu_runtime, false),
-            " RT: ", ::to_string(es.runtime, false), " ]");
+            " RT: ", ::to_string(es.runtime, false));
+        if (es.schedstat) {
+            tmplog(" RQ wait: ", ::to_string(es.schedstat->run_queue_wait_time, false));
+        }
+        if (not test_report.all_runtimes.empty()) {
+            tmplog(" Runs:");
+            for (auto runtime : test_report.all_runtimes) {
+                tmplog(' ', ::to_string(runtime, false));
+            }
+        }
+        tmplog(" ]");
 
         func(tmplog);
     }
@@ -362,6 +399,20 @@ public:
      * @return contents of the loaded file
      */
     virtual std::string load_as_str(FilePath path) = 0;
+
+    /**
+     * @brief Loads file with path @p path from package without creating
+     *   a file in the filesystem
+     *
+     * @param path path to file in package. If main dir == "foo/" and
+     *   desired file has path "foo/bar/test", then @p path should be
+     *   "bar/test"
+     * @param hint_name A proposition of the name if a memfd is created
+     *
+     * @return read-only file descriptor (with O_CLOEXEC set) of the loaded
+     *   file
+     */
+    virtual FileDescriptor load_as_fd(FilePath path, CStringView hint_name) = 0;
 };
 
 /**
@@ -377,7 +428,18 @@ class JudgeWorker {
 
     std::unique_ptr<PackageLoader> package_loader;
 
+    // Compiled programs, used only if use_memfds == true
+    FileDescriptor checker_memfd;
+    FileDescriptor solution_memfd;
+
 public:
+    // If true, compiled checker and solution are kept in sealed memfds and
+    // executed from them, and the test files are passed to the sandboxed
+    // programs as file descriptors, so that no files are created in tmp_dir
+    // during judging. Has to be set before compiling or loading the checker
+    // and the solution.
+    bool use_memfds = false;
+
     std::optional<std::chrono::nanoseconds> checker_time_limit = std::chrono::seconds(10);
     std::optional<uint64_t> checker_memory_limit = 256 << 20; // 256 MiB
     // It means that score ratio for runtime in range
@@ -397,6 +459,68 @@ public:
     // +------------------------------------------+
     double score_cut_lambda = 2.0 / 3; // has to be from [0, 1]
 
+    // Interactive problems only: if set, capacity (in bytes) of the pipes
+    // between the solution and the checker. Bigger pipes reduce the number of
+    // context switches for the protocols that send a lot of data, but sizes
+    // above /proc/sys/fs/pipe-max-size require CAP_SYS_RESOURCE.
+    std::optional<size_t> interactive_pipe_size;
+    // Interactive problems only: if non-zero, the data sent between the
+    // solution and the checker is relayed through the judge and up to this
+    // many bytes of it are recorded in JudgeReport::Test::transcript
+    size_t interactive_transcript_max_len = 0;
+    // If true, the time the solutions spend waiting for a CPU is read from
+    // /proc/<pid>/schedstat, reported in JudgeReport::Test::run_queue_wait_time
+    // and not counted in the real runtime compared with the time limit, so
+    // that judging on a loaded machine does not cause spurious TLEs
+    bool read_schedstat = false;
+
+    // Policy of re-running the solution on the tests on which its CPU runtime
+    // is close to the time limit or to the score cut (score_cut_lambda *
+    // time_limit, only if score_cut_lambda is from (0, 1)), so that the
+    // verdict and the score do not depend on a single measurement. Only runs
+    // that exit successfully or exceed the time limit are re-run, as runtime
+    // does not change other verdicts. Re-running stops early once the run
+    // picked so far is not close, as it is decisive, or once a run ends with
+    // a verdict that runtime does not change; that run decides then. The
+    // picked run decides the verdict and the score, and its output is the one
+    // checked. Applies only to non-interactive problems.
+    struct RerunPolicy {
+        enum class Pick : uint8_t {
+            MIN, // the fastest run decides
+            MEDIAN, // the run with the median runtime (the lower one for an
+                    // even number of runs) decides
+        };
+
+        // Runtime is close to x if it differs from x by at most band *
+        // time_limit, has to be from [0, 1]
+        double band = 0.1;
+        // Maximum number of runs on a test if the first run is close, has to be
+        // at least 1
+        unsigned runs = 3;
+        Pick pick = Pick::MEDIAN;
+
+        [[nodiscard]] bool is_close(
+            std::chrono::nanoseconds runtime, std::chrono::nanoseconds time_limit,
+            double score_cut_lambda) const noexcept {
+            auto max_diff = time_limit * band;
+            auto close_to = [&](auto x) {
+                return runtime >= x - max_diff and runtime <= x + max_diff;
+            };
+            // The score is scaled only if 0 < score_cut_lambda < 1 (see
+            // score_cut_lambda), otherwise there is no score cut to be close to
+            return close_to(time_limit) or
+                (score_cut_lambda > 0 and score_cut_lambda < 1 and
+                 close_to(time_limit * score_cut_lambda));
+        }
+
+        // Returns index of the run that decides, @p runtimes are CPU runtimes of
+        // the runs so far, has to be non-empty
+        [[nodiscard]] size_t
+        pick_run(const std::vector<std::chrono::nanoseconds>& runtimes) const;
+    };
+
+    std::optional<RerunPolicy> rerun_policy; // if not set, every test is run once
+
     JudgeWorker() = default;
 
     JudgeWorker(const JudgeWorker&) = delete;
@@ -421,7 +545,15 @@ private:
         FilePath source, SolutionLanguage lang,
         std::optional<std::chrono::nanoseconds> time_limit, std::string* c_errors,
         size_t c_errors_max_len, const std::string& proot_path,
-        StringView compilation_source_basename, StringView exec_dest_filename);
+        StringView compilation_source_basename, CStringView exec_dest_filename,
+        FileDescriptor& exec_dest_memfd);
+
+    void load_compiled_program(
+        FilePath compiled_program, CStringView filename, FileDescriptor& memfd);
+
+    void save_compiled_program(
+        FilePath destination, int (*copy_fn)(FilePath, FilePath, mode_t),
+        CStringView filename, int memfd) const;
 
 public:
     /// Compiles checker (using sim::compile())
@@ -437,7 +569,7 @@ public:
         STACK_UNWINDING_MARK;
         return compile_impl(
             source, lang, time_limit, c_errors, c_errors_max_len, proot_path, "source",
-            SOLUTION_FILENAME);
+            SOLUTION_FILENAME, solution_memfd);
     }
 
     /// Compiles solution (using sim::compile())
@@ -452,36 +584,29 @@ public:
         auto solution_path = package_loader->load_as_file(source, "source");
         return compile_impl(
             solution_path, lang, time_limit, c_errors, c_errors_max_len, proot_path, "source",
-            SOLUTION_FILENAME);
+            SOLUTION_FILENAME, solution_memfd);
     }
 
     void load_compiled_checker(FilePath compiled_checker) {
         STACK_UNWINDING_MARK;
-        thread_fork_safe_copy(
-            compiled_checker, concat<PATH_MAX>(tmp_dir.path(), CHECKER_FILENAME), S_0755);
+        load_compiled_program(compiled_checker, CHECKER_FILENAME, checker_memfd);
     }
 
     void load_compiled_solution(FilePath compiled_solution) {
         STACK_UNWINDING_MARK;
-        thread_fork_safe_copy(
-            compiled_solution, concat<PATH_MAX>(tmp_dir.path(), SOLUTION_FILENAME), S_0755);
+        load_compiled_program(compiled_solution, SOLUTION_FILENAME, solution_memfd);
     }
 
     void save_compiled_checker(
         FilePath destination, int (*copy_fn)(FilePath, FilePath, mode_t) = copy) const {
         STACK_UNWINDING_MARK;
-        if (copy_fn(concat<PATH_MAX>(tmp_dir.path(), CHECKER_FILENAME), destination, S_0755)) {
-            THROW("copy()", errmsg());
-        }
+        save_compiled_program(destination, copy_fn, CHECKER_FILENAME, checker_memfd);
     }
 
     void save_compiled_solution(
         FilePath destination, int (*copy_fn)(FilePath, FilePath, mode_t) = copy) const {
         STACK_UNWINDING_MARK;
-        if (copy_fn(concat<PATH_MAX>(tmp_dir.path(), SOLUTION_FILENAME), destination, S_0755))
-        {
-            THROW("copy()", errmsg());
-        }
+        save_compiled_program(destination, copy_fn, SOLUTION_FILENAME, solution_memfd);
     }
 
     /**
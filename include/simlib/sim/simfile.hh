@@ -350,24 +350,43 @@ public:
             return res;
         }
 
-        bool operator()(StringView a, StringView b) const {
-            auto x = split(a);
-            auto y = split(b);
+        // Test name split beforehand, so that comparing the same name many
+        // times (e.g. while sorting) does not rescan it
+        struct Key {
+            StringView name;
+            SplitResult split;
+            StringView gid_num; // split.gid without leading zeros
+            bool ocen; // split.tid == "ocen"
+        };
+
+        static inline Key key(StringView test_name) noexcept {
+            Key res;
+            res.name = test_name;
+            res.split = split(test_name);
+            res.gid_num = res.split.gid.without_leading('0');
+            res.ocen = (res.split.tid == "ocen");
+            return res;
+        }
+
+        bool operator()(const Key& x, const Key& y) const noexcept {
             // tid == "ocen" behaves the same as gid == "0"
-            if (x.tid == "ocen") {
-                if (y.tid == "ocen") {
-                    return StrNumCompare()(x.gid, y.gid);
+            if (x.ocen) {
+                if (y.ocen) {
+                    return StrNumCompare()(x.gid_num, y.gid_num);
                 }
-
-                y.gid.remove_leading('0');
-                return (not y.gid.empty()); // true iff y.gid was not equal to 0
+                return (not y.gid_num.empty()); // true iff y.gid was not equal to 0
             }
-            if (y.tid == "ocen") {
-                x.gid.remove_leading('0');
-                return x.gid.empty(); // true iff x.gid was equal to 0
+            if (y.ocen) {
+                return x.gid_num.empty(); // true iff x.gid was equal to 0
             }
 
-            return (x.gid == y.gid ? x.tid < y.tid : StrNumCompare()(x.gid, y.gid));
+            return (
+                x.split.gid == y.split.gid ? x.split.tid < y.split.tid
+                                           : StrNumCompare()(x.gid_num, y.gid_num));
+        }
+
+        bool operator()(StringView a, StringView b) const noexcept {
+            return operator()(key(a), key(b));
         }
     };
 };
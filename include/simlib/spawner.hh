@@ -3,7 +3,9 @@
 #include "simlib/file_contents.hh"
 #include "simlib/file_path.hh"
 #include "simlib/overloaded.hh"
+#include "simlib/proc_sampler.hh"
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <csignal>
@@ -17,6 +19,7 @@
 #include <unistd.h>
 #include <utility>
 #include <variant>
+#include <vector>
 
 class Spawner {
 protected:
@@ -32,6 +35,12 @@ public:
         } si{};
         struct rusage rusage = {}; // resource information
         uint64_t vm_peak = 0; // peak virtual memory size (in bytes)
+        uint64_t rss_peak = 0; // peak resident set size (in bytes)
+        // samples taken every Options::sampling_interval (if it was set)
+        std::vector<ProcSample> profile;
+        // scheduler statistics of the program's run (if Options::read_schedstat
+        // was true and the kernel provides them)
+        std::optional<ProcSchedStat> schedstat;
         std::string message;
 
         ExitStat() = default;
@@ -65,6 +74,17 @@ public:
                             // time limit will be set to round(real time limit
                             // in seconds) + 1 seconds
         CStringView working_dir; // directory at which program will be run
+        // if non-negative, the program is executed from this file descriptor
+        // via fexecve(3) (i.e. execveat(2) with AT_EMPTY_PATH) and exec is
+        // used only in error messages
+        int exec_fd = -1;
+        // if set, memory and CPU usage of the program is sampled with this
+        // interval since execve() and stored in ExitStat::profile
+        std::optional<std::chrono::nanoseconds> sampling_interval;
+        // if true, ExitStat::schedstat is read from /proc/<pid>/schedstat; it
+        // tells e.g. how long the program was waiting for a CPU, which is
+        // counted in its real runtime
+        bool read_schedstat = false;
 
         constexpr Options()
         : Options(STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO) {}
@@ -93,7 +113,8 @@ public:
     /**
      * @brief Runs @p exec with arguments @p exec_args and limits:
      *   @p opts.time_limit and @p opts.memory_limit
-     * @details @p exec is called via execvp()
+     * @details @p exec is called via execvp(), or if @p opts.exec_fd is set,
+     *   @p opts.exec_fd is executed via fexecve()
      *   This function is thread-safe.
      *   IMPORTANT: To function properly this function uses internally signal
      *     SIGRTMIN and installs handler for it. So be aware that using these
@@ -124,6 +145,12 @@ public:
      *     }
      *   - rusage: resource used (see getrusage(2)).
      *   - vm_peak: peak virtual memory size [bytes] (ignored - always 0)
+     *   - rss_peak: peak resident set size [bytes] among the samples in
+     *       profile (0 if @p opts.sampling_interval is not set)
+     *   - profile: samples taken every @p opts.sampling_interval since
+     *       execve()
+     *   - schedstat: scheduler statistics of the program's main thread (if
+     *       @p opts.read_schedstat is true)
      *   - message: detailed info about error, etc.
      *
      * @errors Throws an exception std::runtime_error with appropriate
@@ -135,6 +162,9 @@ public:
         const std::function<void(pid_t)>& do_in_parent_after_fork = [](pid_t /*unused*/) {});
 
 protected:
+    // Sets @p es.profile to @p profile and updates @p es.rss_peak accordingly
+    static void set_profile(ExitStat& es, std::vector<ProcSample> profile) noexcept;
+
     // Sends @p str through @p fd and _exits with -1
     static void send_error_message_and_exit(int fd, CStringView str) noexcept {
         (void)write_all(fd, str.data(), str.size());
@@ -144,10 +174,12 @@ protected:
     // Sends @p str followed by error message of @p errnum through @p fd and
     // _exits with -1
     static void send_error_message_and_exit(int fd, int errnum, CStringView str) noexcept {
-        (void)write_all(fd, str.data(), str.size());
-
         auto err = errmsg(errnum);
-        (void)write_all(fd, err.data(), err.size());
+        std::array<iovec, 2> iov = {{
+            {const_cast<char*>(str.data()), str.size()},
+            {const_cast<char*>(err.data()), err.size()},
+        }};
+        (void)writev_all(fd, iov.data(), iov.size());
 
         _exit(-1);
     };
@@ -180,11 +212,14 @@ protected:
      *   working_dir set to "", "." or "./" disables changing working
      *   directory)
      * @param fd file descriptor to which errors will be written
+     * @param inherited_fds file descriptors (other than stdin, stdout and
+     *   stderr) that will be left open (with FD_CLOEXEC cleared) for @p exec
      * @param do_before_exec function that is to be called before executing
      *   @p exec
      */
     static void run_child(
         FilePath exec, const std::vector<std::string>& exec_args, const Options& opts, int fd,
+        const std::vector<int>& inherited_fds,
         const std::function<void()>& do_before_exec) noexcept;
 
     class Timer {
@@ -4,8 +4,14 @@
 #include "simlib/inplace_buff.hh"
 #include "simlib/string_traits.hh"
 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <optional>
+#include <vector>
 
 inline std::string to_lower(std::string str) {
     for (auto& c : str) {
@@ -172,6 +178,56 @@ std::string json_stringify(Arg&&... arg) {
     return res;
 }
 
+namespace detail {
+
+// Whether all 8 bytes of @p chunk are ASCII digits
+constexpr bool are_8_digits(uint64_t chunk) noexcept {
+    return ((chunk & 0xf0f0f0f0f0f0f0f0) |
+            (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) == 0x3333333333333333;
+}
+
+// Converts 8 ASCII digits loaded (little-endian) into @p chunk to their value
+constexpr uint32_t parse_8_digits(uint64_t chunk) noexcept {
+    chunk -= 0x3030303030303030;
+    chunk = chunk * 10 + (chunk >> 8); // pairs of digits
+    chunk = ((chunk & 0x000000ff000000ff) * (100 + (1000000ULL << 32)) +
+             ((chunk >> 16) & 0x000000ff000000ff) * (1 + (10000ULL << 32))) >>
+        32;
+    return static_cast<uint32_t>(chunk);
+}
+
+// Converts @p str consisting of at most 20 digits to uint64_t or returns
+// std::nullopt if @p str contains a non-digit or the value does not fit
+inline std::optional<uint64_t> parse_up_to_20_digits(StringView str) noexcept {
+    assert(str.size() <= 20);
+    uint64_t res = 0;
+    size_t i = 0;
+    if constexpr (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) {
+        // At most two chunks, so res < 10^16 and cannot overflow here
+        for (; i + 8 <= str.size(); i += 8) {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, str.data() + i, sizeof(chunk));
+            if (not are_8_digits(chunk)) {
+                return std::nullopt;
+            }
+            res = res * 100000000 + parse_8_digits(chunk);
+        }
+    }
+    for (; i < str.size(); ++i) {
+        if (not is_digit(str[i])) {
+            return std::nullopt;
+        }
+        if (__builtin_mul_overflow(res, 10, &res) or
+            __builtin_add_overflow(res, str[i] - '0', &res))
+        {
+            return std::nullopt;
+        }
+    }
+    return res;
+}
+
+} // namespace detail
+
 // Converts whole @p str to @p T or returns std::nullopt on errors like value
 // represented in @p str is too big or invalid
 template <
@@ -200,6 +256,27 @@ constexpr std::optional<T> str2num(StringView str) noexcept {
             }
         }
 
+        // Fast path: parse the magnitude 8 digits at a time. Wider types may
+        // hold 20-digit values that do not fit in uint64_t.
+        constexpr size_t max_fast_digits = sizeof(T) > sizeof(uint64_t) ? 19 : 20;
+        if (not __builtin_is_constant_evaluated() and str.size() <= max_fast_digits) {
+            auto magnitude = detail::parse_up_to_20_digits(str);
+            if (not magnitude) {
+                return std::nullopt;
+            }
+            if constexpr (sizeof(T) < sizeof(uint64_t) or
+                          (sizeof(T) == sizeof(uint64_t) and std::is_signed_v<T>))
+            {
+                if (*magnitude > static_cast<uint64_t>(std::numeric_limits<T>::max()) + minus)
+                {
+                    return std::nullopt;
+                }
+            }
+            using U = std::make_unsigned_t<T>;
+            return minus ? static_cast<T>(U{0} - static_cast<U>(*magnitude))
+                         : static_cast<T>(*magnitude);
+        }
+
         if (not is_digit(str[0])) {
             return std::nullopt;
         }
@@ -232,20 +309,37 @@ template <
     std::enable_if_t<
         not std::is_integral_v<std::remove_cv_t<std::remove_reference_t<T>>>, int> = 0>
 std::optional<T> str2num(StringView str) noexcept {
-#if 0 // TODO: use it when std::from_chars for double becomes implemented in libstdc++ (also
-      // remove always false from the above and include <cstdlib>)
-    std::optional<T> res{std::in_place};
-    auto [ptr, ec] = std::from_chars(str.begin(), str.end(), &*res);
-    if (ptr != str.end() or ec != std::errc())
-        return std::nullopt;
-
-    return res;
-#else
     static_assert(std::is_floating_point_v<T>);
     if (str.empty() or is_space(str[0])) {
         return std::nullopt;
     }
 
+#ifdef __cpp_lib_to_chars
+    // Unlike strtod(), std::from_chars() accepts neither the leading '+' nor
+    // hexadecimal numbers, so the former is skipped and the latter are left to
+    // strtod()
+    if (str[0] == '+') {
+        str.remove_prefix(1);
+        if (str.empty() or str[0] == '-') {
+            return std::nullopt;
+        }
+    }
+    auto digits = str;
+    if (digits[0] == '-') {
+        digits.remove_prefix(1);
+    }
+    bool is_hex = (digits.size() >= 2 and digits[0] == '0' and to_lower(digits[1]) == 'x');
+    if (not is_hex) {
+        std::optional<T> res{std::in_place};
+        auto [ptr, ec] = std::from_chars(str.begin(), str.end(), *res);
+        // strtod() reports subnormal results as out of range, keep it that way
+        if (ptr != str.end() or ec != std::errc() or std::fpclassify(*res) == FP_SUBNORMAL) {
+            return std::nullopt;
+        }
+        return res;
+    }
+#endif
+
     try {
         InplaceBuff<4096> buff{str};
         CStringView cstr = buff.to_cstr();
@@ -274,8 +368,6 @@ std::optional<T> str2num(StringView str) noexcept {
     } catch (...) {
         return std::nullopt;
     }
-
-#endif
 }
 
 // Converts whole @p str to @p T or returns std::nullopt on errors like value
@@ -291,6 +383,24 @@ constexpr std::optional<T> str2num(StringView str, T min_val, T max_val) noexcep
     return res;
 }
 
+// Converts whitespace-separated numbers in @p str to a vector of @p T or
+// returns std::nullopt if any of them is invalid (see str2num())
+template <class T>
+std::optional<std::vector<T>> str2nums(StringView str) {
+    std::optional<std::vector<T>> res{std::in_place};
+    for (;;) {
+        str.remove_leading(is_space<char>);
+        if (str.empty()) {
+            return res;
+        }
+        auto num = str2num<T>(str.extract_leading([](char c) { return not is_space(c); }));
+        if (not num) {
+            return std::nullopt;
+        }
+        res->emplace_back(*num);
+    }
+}
+
 enum Adjustment : uint8_t { LEFT, RIGHT };
 
 /**
@@ -328,3 +438,30 @@ padded_string(StringView str, size_t len, Adjustment adj = RIGHT, char filler =
     res.append(str);
     return res;
 }
+
+/**
+ * @brief Appends @p str padded to at least @p len characters to @p buff
+ * @details Like padded_string(), but without the intermediate buffer, e.g.
+ *   append_padded(buff, "abc", 5, LEFT) appends "abc  "
+ *
+ * @param buff std::string or InplaceBuff to append to
+ * @param str string to pad
+ * @param len minimum length of the appended string
+ * @param adj adjustment direction to left or right
+ * @param filler character used to fill blank fields
+ */
+template <class Buff>
+void append_padded(
+    Buff& buff, StringView str, size_t len, Adjustment adj = RIGHT, char filler = ' ') {
+    size_t pos = string_length(buff);
+    size_t pad_len = (len > str.size() ? len - str.size() : 0);
+    buff.resize(pos + pad_len + str.size());
+    char* dest = buff.data() + pos;
+    if (adj == RIGHT) {
+        std::fill(dest, dest + pad_len, filler);
+        dest += pad_len;
+    } else {
+        std::fill(dest + str.size(), dest + str.size() + pad_len, filler);
+    }
+    std::copy(str.begin(), str.end(), dest);
+}
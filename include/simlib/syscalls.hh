@@ -22,6 +22,13 @@ waitid(int id_type, pid_t id, siginfo_t* info, int options, struct rusage* usage
 }
 #endif
 
+#ifdef SYS_getdents64
+// NOLINTNEXTLINE(google-runtime-int)
+inline long getdents64(int fd, void* dirp, size_t count) noexcept {
+    return syscall(SYS_getdents64, fd, dirp, count);
+}
+#endif
+
 #ifdef SYS_pidfd_open
 inline int pidfd_open(pid_t pid, unsigned int flags) noexcept {
     return static_cast<int>(syscall(SYS_pidfd_open, pid, flags));
@@ -18,11 +18,23 @@ inline std::string date(CStringView format, std::chrono::system_clock::time_poin
     return date(format, std::chrono::system_clock::to_time_t(tp));
 }
 
+// Maximum length of the date formatted by mysql_date_buff() and
+// mysql_localdate_buff(): "%Y-%m-%d %H:%M:%S" with a year that takes up to 11
+// characters, followed by '.' and at most 9 digits of the fraction
+constexpr size_t MYSQL_DATE_MAX_LEN = 36;
+
+// Returns UTC date @p tp in format of "%Y-%m-%d %H:%M:%S" (see strftime(3))
+// followed by '.' and @p subsecond_digits (at most 9) digits of the fraction
+// of the second if @p subsecond_digits > 0. Does not allocate: the formatted
+// seconds are cached per thread, so formatting many time points from the same
+// second (e.g. timestamps of log lines) only copies them and appends the
+// fraction. Returns an empty string if the conversion fails.
+StaticCStringBuff<MYSQL_DATE_MAX_LEN> mysql_date_buff(
+    std::chrono::system_clock::time_point tp, uint subsecond_digits = 0) noexcept;
+
 // Returns UTC date in format of "%Y-%m-%d %H:%M:%S" (see strftime(3)), if
 // @p curr_time >= 0 uses @p curr_time, otherwise uses the current time
-inline std::string mysql_date(time_t curr_time = -1) {
-    return date("%Y-%m-%d %H:%M:%S", curr_time);
-}
+std::string mysql_date(time_t curr_time = -1);
 
 // Returns UTC date @p tp in format of "%Y-%m-%d %H:%M:%S" (see strftime(3))
 inline std::string mysql_date(std::chrono::system_clock::time_point tp) {
@@ -38,11 +50,15 @@ inline std::string localdate(CStringView format, std::chrono::system_clock::time
     return localdate(format, std::chrono::system_clock::to_time_t(tp));
 }
 
+// Same as mysql_date_buff(), but returns the local date. Like localtime_r(3),
+// uses the timezone set by the last tzset(3) (changing it invalidates the
+// cache), so after changing the TZ environment variable call tzset(3).
+StaticCStringBuff<MYSQL_DATE_MAX_LEN> mysql_localdate_buff(
+    std::chrono::system_clock::time_point tp, uint subsecond_digits = 0) noexcept;
+
 // Returns local date in format of "%Y-%m-%d %H:%M:%S" (see strftime(3)), if
 // @p curr_time >= 0 uses @p curr_time, otherwise uses the current time
-inline std::string mysql_localdate(time_t curr_time = -1) {
-    return localdate("%Y-%m-%d %H:%M:%S", curr_time);
-}
+std::string mysql_localdate(time_t curr_time = -1);
 
 // Returns local date @p tp in format of "%Y-%m-%d %H:%M:%S" (see strftime(3))
 inline std::string mysql_localdate(std::chrono::system_clock::time_point tp) {
@@ -266,35 +282,40 @@ constexpr StaticCStringBuff<N>
 to_string(const std::chrono::duration<Rep, Period>& dur, bool trim_zeros = true) noexcept {
     static_assert(Period::num == 1, "Needed below");
     static_assert(is_power_of_10(Period::den), "Needed below");
-    auto dec_dur = std::chrono::duration_cast<std::chrono::duration<intmax_t>>(dur);
-    auto res = to_string<Rep, N>(dec_dur.count());
-    res[res.len_++] = '.';
-
-    auto x = std::chrono::duration<intmax_t, Period>(dur - dec_dur).count();
     constexpr int prec = to_string(Period::den).size() - 1;
-    for (auto i = res.len_ + prec - 1; i >= res.len_; --i) {
-        res[i] = '0' + x % 10;
-        x /= 10;
+
+    using std::chrono::duration;
+    auto count = std::chrono::duration_cast<duration<intmax_t, Period>>(dur).count();
+    bool minus = (count < 0);
+    uintmax_t magnitude = (minus ? uintmax_t{0} - static_cast<uintmax_t>(count) : count);
+
+    // Format as fixed-point number from the end of the buffer
+    StaticCStringBuff<N> res;
+    char* end = res.data() + N;
+    char* beg = detail::write_digits_backwards(end, magnitude % Period::den, prec);
+    char* dot = --beg;
+    *dot = '.';
+    beg = detail::write_digits_backwards(beg, magnitude / Period::den);
+    if (minus) {
+        *--beg = '-';
     }
 
     if (trim_zeros) {
         // Truncate trailing zeros
-        auto i = res.len_ + prec - 1;
-        // i will point to the last character of the result
-        while (i >= res.len_ and res[i] == '0') {
-            --i;
+        while (end > dot + 1 and end[-1] == '0') {
+            --end;
         }
-
-        if (i == res.len_ - 1) {
-            res.len_ = i; // Trim trailing '.'
-        } else {
-            res.len_ = i + 1;
+        if (end == dot + 1) {
+            end = dot; // Trim trailing '.'
         }
-    } else {
-        res.len_ += prec;
     }
 
-    *res.end() = '\0';
+    // Move the result to the beginning of the buffer
+    res.len_ = end - beg;
+    for (size_t i = 0; i < res.len_; ++i) {
+        res[i] = beg[i];
+    }
+    res[res.len_] = '\0';
     return res;
 }
 
@@ -93,11 +93,65 @@ std::string& operator+=(std::string& str, const StaticCStringBuff<N>& c_buff) {
     return str.append(c_buff.data(), c_buff.size());
 }
 
+namespace detail {
+
+// "00", "01", ..., "99"
+constexpr inline std::array<char, 200> digit_pairs = [] {
+    std::array<char, 200> res{};
+    for (int i = 0; i < 100; ++i) {
+        res[2 * i] = static_cast<char>('0' + i / 10);
+        res[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return res;
+}();
+
+// Writes decimal representation of @p val (two digits at a time) so that it
+// ends just before @p end. Returns pointer to its first character.
+template <class U>
+constexpr char* write_digits_backwards(char* end, U val) noexcept {
+    static_assert(std::is_unsigned_v<U>);
+    while (val >= 100) {
+        auto pair = static_cast<size_t>(val % 100) * 2;
+        val /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (val >= 10) {
+        auto pair = static_cast<size_t>(val) * 2;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    } else {
+        *--end = static_cast<char>('0' + val);
+    }
+    return end;
+}
+
+// Like write_digits_backwards(), but writes exactly @p len least significant
+// digits of @p val (padded with leading zeros)
+template <class U>
+constexpr char* write_digits_backwards(char* end, U val, size_t len) noexcept {
+    static_assert(std::is_unsigned_v<U>);
+    char* beg = end - len;
+    while (end - beg >= 2) {
+        auto pair = static_cast<size_t>(val % 100) * 2;
+        val /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (end != beg) {
+        *--end = static_cast<char>('0' + val % 10);
+    }
+    return beg;
+}
+
+} // namespace detail
+
 template <
     class T,
     std::enable_if_t<std::is_integral_v<std::remove_cv_t<std::remove_reference_t<T>>>, int> =
         0>
 constexpr auto to_string(T x) noexcept {
+    using U = std::make_unsigned_t<std::remove_cv_t<std::remove_reference_t<T>>>;
     constexpr auto digits = [](auto val) constexpr {
         size_t res = 0;
         while (val > 0) {
@@ -108,40 +162,23 @@ constexpr auto to_string(T x) noexcept {
         return res;
     };
 
-    StaticCStringBuff<digits(std::numeric_limits<T>::max()) + 1> res;
-    if (x == 0) {
-        res[0] = '0';
-        res[1] = '\0';
-        res.len_ = 1;
-        return res;
+    constexpr size_t N = digits(std::numeric_limits<T>::max()) + 1;
+    StaticCStringBuff<N> res;
+    bool minus = (std::is_signed_v<T> and x < 0);
+    // Two's complement negation of the unsigned value cannot overflow
+    U magnitude = (minus ? static_cast<U>(U{0} - static_cast<U>(x)) : static_cast<U>(x));
+    char* end = res.data() + N;
+    char* beg = detail::write_digits_backwards(end, magnitude);
+    if (minus) {
+        *--beg = '-';
     }
 
-    if (std::is_signed_v<T> and x < 0) {
-        while (x) {
-            auto x2 = x / 10;
-            res[res.len_++] = x2 * 10 - x + '0';
-            x = x2;
-        }
-        res[res.len_++] = '-';
-    } else {
-        while (x) {
-            auto x2 = x / 10;
-            res[res.len_++] = x - x2 * 10 + '0';
-            x = x2;
-        }
+    // Move the result to the beginning of the buffer
+    res.len_ = end - beg;
+    for (size_t i = 0; i < res.len_; ++i) {
+        res[i] = beg[i];
     }
-
     res[res.len_] = '\0';
-#if __cplusplus > 201703L
-#warning "std::reverse() can be used as it became constexpr"
-#endif
-    // Reverse res
-    for (int i = 0, j = res.len_ - 1; i < j; ++i, --j) {
-        char c = res[i];
-        res[i] = res[j];
-        res[j] = c;
-    }
-
     return res;
 }
 
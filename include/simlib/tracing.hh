@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Lightweight tracing of time spent in named scopes (spans). Every thread
+// records its finished spans in its own ring buffer, so recording is cheap and
+// does not need to allocate. The spans can be exported as Chrome trace event
+// JSON (viewable in chrome://tracing or https://ui.perfetto.dev).
+//
+// TRACE_SPAN*() macros are compiled out unless SIMLIB_TRACING is defined (see
+// the `tracing` meson option).
+namespace tracing {
+
+using Clock = std::chrono::steady_clock;
+
+struct SpanRecord {
+    const char* name; // a string with static storage duration
+    Clock::time_point start;
+    Clock::time_point end;
+    pid_t tid; // thread that recorded the span
+};
+
+// Only this many last spans of each thread are kept
+constexpr size_t SPANS_PER_THREAD = 4096;
+
+// Records a finished span in the ring buffer of the current thread.
+// @p name has to have static storage duration (e.g. be a string literal).
+void record(const char* name, Clock::time_point start, Clock::time_point end) noexcept;
+
+// Returns the recorded spans (of all threads, including the finished ones) that
+// started at or after @p since, ordered by start time
+std::vector<SpanRecord> spans_since(Clock::time_point since);
+
+// Returns @p spans formatted as Chrome trace event JSON
+std::string to_chrome_trace_json(const std::vector<SpanRecord>& spans);
+
+// Records the span from its construction until its destruction or end()
+class Span {
+    const char* name_;
+    Clock::time_point start_ = Clock::now();
+    bool ended_ = false;
+
+public:
+    explicit Span(const char* name) noexcept
+    : name_(name) {}
+
+    Span(const Span&) = delete;
+    Span(Span&&) = delete;
+    Span& operator=(const Span&) = delete;
+    Span& operator=(Span&&) = delete;
+
+    void end() noexcept {
+        if (not ended_) {
+            ended_ = true;
+            record(name_, start_, Clock::now());
+        }
+    }
+
+    ~Span() { end(); }
+};
+
+} // namespace tracing
+
+#define TRACE_SPAN_CONCATENATE_DETAIL(x, y) x##y
+#define TRACE_SPAN_CONCAT(x, y) TRACE_SPAN_CONCATENATE_DETAIL(x, y)
+
+#ifdef SIMLIB_TRACING
+// Traces the enclosing scope as a span named @p name
+#define TRACE_SPAN(name) \
+    ::tracing::Span TRACE_SPAN_CONCAT(trace_span_no_, __COUNTER__)(name)
+// Like TRACE_SPAN(), but the span can be ended earlier with TRACE_SPAN_END(var)
+#define TRACE_SPAN_NAMED(var, name) ::tracing::Span var(name)
+#define TRACE_SPAN_END(var) (var).end()
+#else
+#define TRACE_SPAN(name) static_cast<void>(0)
+#define TRACE_SPAN_NAMED(var, name) static_cast<void>(0)
+#define TRACE_SPAN_END(var) static_cast<void>(0)
+#endif
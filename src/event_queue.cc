@@ -1,4 +1,5 @@
 #include "simlib/event_queue.hh"
+#include "simlib/metrics.hh"
 #include "simlib/overloaded.hh"
 #include "simlib/shared_function.hh"
 #include "simlib/time.hh"
@@ -10,6 +11,22 @@
 using time_point = std::chrono::system_clock::time_point;
 using handler_id_t = EventQueue::handler_id_t;
 
+namespace {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Gauge pending_timed_handlers{
+    "simlib_event_queue_pending_timed_handlers",
+    "Number of timed handlers waiting in all event queues"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Counter handlers_run{
+    "simlib_event_queue_handlers_run_total", "Number of run timed and file handlers"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::DurationHistogram timed_handler_delay{
+    "simlib_event_queue_timed_handler_delay_seconds",
+    "Time by which timed handlers are run after their scheduled time"};
+
+} // namespace
+
 EventQueue::EventQueue()
 : immediate_pause_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
     if (not immediate_pause_fd_.is_open()) {
@@ -35,6 +52,7 @@ EventQueue::EventQueue(EventQueue&& other) noexcept
 , immediate_pause_fd_(std::move(other.immediate_pause_fd_)) {}
 
 EventQueue& EventQueue::operator=(EventQueue&& other) noexcept {
+    pending_timed_handlers.sub(timed_handlers_.size());
     next_handler_id_ = other.next_handler_id_;
     handlers_ = std::move(other.handlers_);
     timed_handlers_ = std::move(other.timed_handlers_);
@@ -46,6 +64,8 @@ EventQueue& EventQueue::operator=(EventQueue&& other) noexcept {
     return *this;
 }
 
+EventQueue::~EventQueue() { pending_timed_handlers.sub(timed_handlers_.size()); }
+
 void EventQueue::pause_immediately() noexcept {
     (void)immediate_pause_.exchange(true, std::memory_order_acq_rel);
     int fd = immediate_pause_fd_;
@@ -93,6 +113,7 @@ handler_id_t EventQueue::add_time_handler_impl(time_point tp, std::function<void
     handlers_.emplace(handler_id, TimedHandler{tp, std::move(handler)});
     try {
         timed_handlers_.emplace(tp, handler_id);
+        pending_timed_handlers.inc();
         return handler_id;
     } catch (...) {
         handlers_.erase(handler_id);
@@ -121,6 +142,7 @@ void EventQueue::remove_handler(handler_id_t handler_id) {
         overloaded{
             [&](TimedHandler& handler) {
                 timed_handlers_.erase({handler.time, handler_id});
+                pending_timed_handlers.dec();
             },
             [&](FileHandler& handler) {
                 poll_events_[handler.poll_event_idx].fd =
@@ -163,11 +185,14 @@ void EventQueue::run() {
             }
 
             timed_handlers_.erase(timed_handlers_.begin());
+            pending_timed_handlers.dec();
+            timed_handler_delay.observe(now - tp);
             const auto it = handlers_.find(handler_id);
             assert(it != handlers_.end());
             auto handler = std::move(std::get<TimedHandler>(it->second).handler);
             handlers_.erase(it);
 
+            handlers_run.inc();
             handler(); // It is ok if it throws
             if (immediate_pause_was_requested()) {
                 return;
@@ -236,6 +261,7 @@ void EventQueue::run() {
 
                 auto handler_shr_ptr =
                     WONT_THROW(std::get<FileHandler>(handlers_.at(handler_id)).handler);
+                handlers_run.inc();
                 (*handler_shr_ptr)(events);
                 if (immediate_pause_was_requested()) {
                     return;
@@ -1,7 +1,9 @@
 #include "simlib/file_contents.hh"
 #include "simlib/file_descriptor.hh"
 
+#include <climits>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 using std::array;
@@ -67,6 +69,67 @@ size_t write_all(int fd, const void* buf, size_t count) noexcept {
     return count;
 }
 
+namespace {
+
+// Moves @p iov and @p iovcnt past @p bytes bytes, skipping empty buffers
+void advance_iovecs(iovec*& iov, int& iovcnt, size_t bytes) noexcept {
+    while (iovcnt > 0 and bytes >= iov->iov_len) {
+        bytes -= iov->iov_len;
+        ++iov;
+        --iovcnt;
+    }
+
+    if (bytes > 0) {
+        iov->iov_base = static_cast<char*>(iov->iov_base) + bytes;
+        iov->iov_len -= bytes;
+    }
+}
+
+// @p transfer should take (iov, iovcnt, bytes transferred so far) and behave
+// like readv() / writev()
+template <class Func>
+size_t transfer_all_vectored(
+    iovec* iov, int iovcnt, bool stop_on_zero, Func&& transfer) noexcept {
+    size_t total = 0;
+    advance_iovecs(iov, iovcnt, 0);
+    while (iovcnt > 0) {
+        ssize_t k = transfer(iov, std::min(iovcnt, IOV_MAX), total);
+        if (k > 0) {
+            total += k;
+            advance_iovecs(iov, iovcnt, k);
+        } else if (k == 0) {
+            if (stop_on_zero) {
+                break; // EOF
+            }
+        } else if (errno != EINTR) {
+            return total; // Error
+        }
+    }
+
+    errno = 0; // No error
+    return total;
+}
+
+} // namespace
+
+size_t readv_all(int fd, iovec* iov, int iovcnt) noexcept {
+    return transfer_all_vectored(iov, iovcnt, true, [fd](iovec* v, int cnt, size_t /*done*/) {
+        return readv(fd, v, cnt);
+    });
+}
+
+size_t preadv_all(int fd, off64_t pos, iovec* iov, int iovcnt) noexcept {
+    return transfer_all_vectored(iov, iovcnt, true, [fd, pos](iovec* v, int cnt, size_t done) {
+        return preadv64(fd, v, cnt, pos + static_cast<off64_t>(done));
+    });
+}
+
+size_t writev_all(int fd, iovec* iov, int iovcnt) noexcept {
+    return transfer_all_vectored(iov, iovcnt, false, [fd](iovec* v, int cnt, size_t /*done*/) {
+        return writev(fd, v, cnt);
+    });
+}
+
 string get_file_contents(int fd, size_t bytes) {
     string res;
     array<char, 65536> buff{};
@@ -1,26 +1,34 @@
 #include "simlib/file_manip.hh"
 #include "simlib/call_in_destructor.hh"
+#include "simlib/concurrent/task_pool.hh"
 #include "simlib/directory.hh"
 #include "simlib/file_descriptor.hh"
 #include "simlib/file_path.hh"
 #include "simlib/inplace_buff.hh"
-#include "simlib/proc_stat_file_contents.hh"
+#include "simlib/metrics.hh"
+#include "simlib/proc_sampler.hh"
+#include "simlib/process.hh"
 #include "simlib/random.hh"
 #include "simlib/repeating.hh"
 #include "simlib/string_transform.hh"
 #include "simlib/syscalls.hh"
 #include "simlib/temporary_file.hh"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <fcntl.h>
+#include <linux/fs.h>
 #include <linux/limits.h>
+#include <memory>
 #include <new>
-#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <utility>
+#include <vector>
 
 using std::array;
 using std::string;
@@ -117,6 +125,159 @@ static int remove_rat_impl(int dirfd, FilePath path) noexcept {
 
 int remove_rat(int dirfd, FilePath path) noexcept { return remove_rat_impl(dirfd, path); }
 
+namespace {
+
+// Number of files that are unlinked or copied within one task of the parallel
+// recursive operations
+constexpr size_t parallel_files_batch_size = 64;
+
+// Keeps errno of the first error that occurred in a parallel operation
+class FirstError {
+    std::atomic<int> errnum_{0};
+
+public:
+    void set(int errnum) noexcept {
+        int expected = 0;
+        errnum_.compare_exchange_strong(expected, errnum);
+    }
+
+    [[nodiscard]] bool is_set() const noexcept {
+        return errnum_.load(std::memory_order_relaxed) != 0;
+    }
+
+    [[nodiscard]] int get() const noexcept { return errnum_.load(); }
+};
+
+class ParallelRemover {
+    concurrent::TaskPool pool_;
+    FirstError error_;
+
+    // The directory is removed once all the tasks referencing it are done
+    struct Dir {
+        ParallelRemover& remover;
+        std::shared_ptr<Dir> parent; // keeps open the directory that parent_fd refers to
+        int parent_fd;
+        std::string name;
+        Directory dir;
+        bool remove_on_destruction = false;
+
+        Dir(ParallelRemover& remover_, std::shared_ptr<Dir> parent_, int parent_fd_,
+            std::string name_)
+        : remover(remover_)
+        , parent(std::move(parent_))
+        , parent_fd(parent_fd_)
+        , name(std::move(name_)) {}
+
+        Dir(const Dir&) = delete;
+        Dir(Dir&&) = delete;
+        Dir& operator=(const Dir&) = delete;
+        Dir& operator=(Dir&&) = delete;
+
+        ~Dir() {
+            dir.close();
+            if (remove_on_destruction and not remover.error_.is_set() and
+                unlinkat(parent_fd, name.c_str(), AT_REMOVEDIR))
+            {
+                remover.error_.set(errno);
+            }
+        }
+    };
+
+    void unlink_files(const Dir& dir, const std::vector<std::string>& names) noexcept {
+        int fd = dirfd(dir.dir);
+        for (const auto& name : names) {
+            if (error_.is_set()) {
+                return;
+            }
+            if (unlinkat(fd, name.c_str(), 0)) {
+                error_.set(errno);
+            }
+        }
+    }
+
+    void add_remove_task(std::shared_ptr<Dir> dir) {
+        pool_.push([this, dir = std::move(dir)]() mutable { remove(std::move(dir)); });
+    }
+
+    // Does the same as remove_rat_impl() but removes subdirectories and files
+    // in separate tasks
+    void remove(std::shared_ptr<Dir> dir) {
+        if (error_.is_set()) {
+            return;
+        }
+
+        int fd = openat(
+            dir->parent_fd, dir->name.c_str(),
+            O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) {
+            if (unlinkat(dir->parent_fd, dir->name.c_str(), 0)) {
+                error_.set(errno);
+            }
+            return;
+        }
+
+        dir->dir = fdopendir(fd);
+        if (not dir->dir.is_open()) {
+            close(fd);
+            if (unlinkat(dir->parent_fd, dir->name.c_str(), AT_REMOVEDIR)) {
+                error_.set(errno);
+            }
+            return;
+        }
+
+        dir->remove_on_destruction = true;
+        std::vector<std::string> files;
+        for_each_dir_component(
+            dir->dir,
+            [&](dirent* file) -> repeating {
+                if (error_.is_set()) {
+                    return stop_repeating;
+                }
+#ifdef _DIRENT_HAVE_D_TYPE
+                if (file->d_type == DT_DIR || file->d_type == DT_UNKNOWN) {
+#endif
+                    add_remove_task(std::make_shared<Dir>(*this, dir, fd, file->d_name));
+#ifdef _DIRENT_HAVE_D_TYPE
+                } else {
+                    files.emplace_back(file->d_name);
+                    if (files.size() == parallel_files_batch_size) {
+                        pool_.push([this, dir, files = std::move(files)] {
+                            unlink_files(*dir, files);
+                        });
+                        files.clear();
+                    }
+                }
+#endif
+                return continue_repeating;
+            },
+            [&] { error_.set(errno); });
+
+        unlink_files(*dir, files);
+    }
+
+public:
+    int run(int dirfd, FilePath path, unsigned threads_num) noexcept {
+        try {
+            add_remove_task(std::make_shared<Dir>(*this, nullptr, dirfd, path.to_str()));
+            pool_.run(threads_num);
+        } catch (...) {
+            error_.set(ENOMEM);
+        }
+
+        if (error_.is_set()) {
+            errno = error_.get();
+            return -1;
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+int remove_rat_parallel(int dirfd, FilePath pathname, unsigned threads_num) noexcept {
+    return ParallelRemover{}.run(dirfd, pathname, threads_num);
+}
+
 int remove_dir_contents_at(int dirfd, FilePath pathname) noexcept {
     int fd = openat(dirfd, pathname, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
     if (fd == -1) {
@@ -178,7 +339,86 @@ int create_subdirectories(FilePath file) noexcept {
     return mkdir_r(path.to_string());
 }
 
-int blast(int infd, int outfd) noexcept {
+namespace {
+
+// Remembers pairs of filesystems (identified by st_dev) on which a kernel copy
+// mechanism turned out to be unsupported, so that blast() does not retry it on
+// every call. Only negative results are cached, so a hash collision may at
+// worst make blast() skip to a slower (but still correct) copying method.
+// The table is lock-free, as blast() is also used in forked children of
+// multi-threaded processes.
+class CopyCapabilityCache {
+public:
+    enum Capability : uint64_t {
+        FICLONE_UNSUPPORTED = 1,
+        COPY_FILE_RANGE_UNSUPPORTED = 2,
+        SENDFILE_UNSUPPORTED = 4,
+    };
+
+private:
+    static constexpr uint64_t capability_bits = 3;
+    static constexpr uint64_t capability_mask = (1 << capability_bits) - 1;
+    static constexpr size_t size = 64;
+    std::array<std::atomic<uint64_t>, size> entries_{};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+    static inline metrics::Counter hits{
+        "simlib_copy_capability_cache_hits_total",
+        "Number of kernel copy attempts skipped thanks to the copy capability cache"};
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+    static inline metrics::Counter misses{
+        "simlib_copy_capability_cache_misses_total",
+        "Number of copy capability cache lookups that did not skip a kernel copy attempt"};
+
+    static uint64_t key(dev_t src_dev, dev_t dest_dev) noexcept {
+        uint64_t h = static_cast<uint64_t>(src_dev) * 0x9e3779b97f4a7c15ULL;
+        h ^= static_cast<uint64_t>(dest_dev) + 0x7f4a7c159e3779b9ULL + (h << 6) + (h >> 2);
+        return h & ~capability_mask;
+    }
+
+    // The low bits of the key are always zero, so they must not select the slot
+    static size_t slot(uint64_t key) noexcept { return (key >> capability_bits) % size; }
+
+public:
+    bool is_unsupported(dev_t src_dev, dev_t dest_dev, Capability cap) const noexcept {
+        auto k = key(src_dev, dest_dev);
+        auto entry = entries_[slot(k)].load(std::memory_order_relaxed);
+        bool res = (entry & ~capability_mask) == k and (entry & cap);
+        (res ? hits : misses).inc();
+        return res;
+    }
+
+    void mark_unsupported(dev_t src_dev, dev_t dest_dev, Capability cap) noexcept {
+        auto k = key(src_dev, dest_dev);
+        auto& entry = entries_[slot(k)];
+        auto old = entry.load(std::memory_order_relaxed);
+        uint64_t val = 0;
+        do {
+            val = ((old & ~capability_mask) == k ? old : k) | cap;
+        } while (not entry.compare_exchange_weak(old, val, std::memory_order_relaxed));
+    }
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+CopyCapabilityCache copy_capability_cache;
+
+// Whether the error returned by a kernel copy mechanism means that this
+// mechanism cannot be used for the given pair of file descriptors
+constexpr bool is_copy_mechanism_unsupported_error(int errnum) noexcept {
+    switch (errnum) {
+    case EXDEV:
+    case EINVAL:
+    case ENOSYS:
+    case EOPNOTSUPP:
+    case ENOTTY:
+    case EBADF:
+    case EPERM:
+    case ETXTBSY: return true;
+    default: return false;
+    }
+}
+
+int blast_using_read_write(int infd, int outfd) noexcept {
     array<char, 65536> buff{};
     ssize_t len = 0;
     ssize_t written = 0;
@@ -202,6 +442,114 @@ int blast(int infd, int outfd) noexcept {
     return 0;
 }
 
+enum class KernelCopyResult { DONE, UNSUPPORTED, ERROR };
+
+// Clones the whole file (sharing the extents e.g. on btrfs or xfs), possible
+// only if both offsets are at the beginning of the files
+KernelCopyResult blast_using_ficlone(
+    int infd, const struct stat64& in_st, int outfd, const struct stat64& out_st) noexcept {
+    if (not S_ISREG(out_st.st_mode) or out_st.st_size != 0 or
+        copy_capability_cache.is_unsupported(
+            in_st.st_dev, out_st.st_dev, CopyCapabilityCache::FICLONE_UNSUPPORTED))
+    {
+        return KernelCopyResult::UNSUPPORTED;
+    }
+    if (lseek64(infd, 0, SEEK_CUR) != 0 or lseek64(outfd, 0, SEEK_CUR) != 0) {
+        return KernelCopyResult::UNSUPPORTED;
+    }
+
+    if (ioctl(outfd, FICLONE, infd) != 0) {
+        if (not is_copy_mechanism_unsupported_error(errno)) {
+            return KernelCopyResult::ERROR;
+        }
+        if (errno == EXDEV or errno == EOPNOTSUPP or errno == ENOTTY) {
+            copy_capability_cache.mark_unsupported(
+                in_st.st_dev, out_st.st_dev, CopyCapabilityCache::FICLONE_UNSUPPORTED);
+        }
+        return KernelCopyResult::UNSUPPORTED;
+    }
+
+    // blast() has to leave the offsets after the copied data
+    if (lseek64(infd, in_st.st_size, SEEK_SET) == -1 or
+        lseek64(outfd, in_st.st_size, SEEK_SET) == -1)
+    {
+        return KernelCopyResult::ERROR;
+    }
+    return KernelCopyResult::DONE;
+}
+
+// Copies using @p copy_fn until it returns 0. If the very first call fails
+// with error meaning that the mechanism is unsupported, the mechanism is
+// marked as unsupported in the capability cache.
+template <class CopyFn>
+KernelCopyResult blast_using_kernel_copy(
+    const struct stat64& in_st, const struct stat64& out_st,
+    CopyCapabilityCache::Capability cap, CopyFn&& copy_fn) noexcept {
+    if (copy_capability_cache.is_unsupported(in_st.st_dev, out_st.st_dev, cap)) {
+        return KernelCopyResult::UNSUPPORTED;
+    }
+
+    constexpr size_t chunk_size = 1 << 30;
+    bool copied_anything = false;
+    for (;;) {
+        ssize_t rc = copy_fn(chunk_size);
+        if (rc > 0) {
+            copied_anything = true;
+            continue;
+        }
+        if (rc == 0) {
+            // Some special files (e.g. in procfs) report 0 bytes even though
+            // they have contents -- let the read-write loop handle them
+            return copied_anything ? KernelCopyResult::DONE : KernelCopyResult::UNSUPPORTED;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (is_copy_mechanism_unsupported_error(errno)) {
+            if (errno == EXDEV or errno == ENOSYS or errno == EOPNOTSUPP) {
+                copy_capability_cache.mark_unsupported(in_st.st_dev, out_st.st_dev, cap);
+            }
+            // Offsets are updated only by the successful calls, so the next
+            // method may continue from where this one has stopped
+            return KernelCopyResult::UNSUPPORTED;
+        }
+        return KernelCopyResult::ERROR;
+    }
+}
+
+} // namespace
+
+int blast(int infd, int outfd) noexcept {
+    struct stat64 in_st {};
+    struct stat64 out_st {};
+    // Kernel copying mechanisms are reliable only for regular source files
+    if (fstat64(infd, &in_st) or not S_ISREG(in_st.st_mode) or in_st.st_size == 0 or
+        fstat64(outfd, &out_st))
+    {
+        return blast_using_read_write(infd, outfd);
+    }
+
+    auto res = blast_using_ficlone(infd, in_st, outfd, out_st);
+    if (res == KernelCopyResult::UNSUPPORTED and S_ISREG(out_st.st_mode)) {
+        res = blast_using_kernel_copy(
+            in_st, out_st, CopyCapabilityCache::COPY_FILE_RANGE_UNSUPPORTED, [&](size_t len) {
+                return copy_file_range(infd, nullptr, outfd, nullptr, len, 0);
+            });
+    }
+    if (res == KernelCopyResult::UNSUPPORTED) {
+        res = blast_using_kernel_copy(
+            in_st, out_st, CopyCapabilityCache::SENDFILE_UNSUPPORTED,
+            [&](size_t len) { return sendfile64(outfd, infd, nullptr, len); });
+    }
+
+    switch (res) {
+    case KernelCopyResult::DONE: return 0;
+    case KernelCopyResult::ERROR: return -1;
+    case KernelCopyResult::UNSUPPORTED: break;
+    }
+    return blast_using_read_write(infd, outfd);
+}
+
 int copyat_using_rename(
     int src_dirfd, FilePath src, int dest_dirfd, FilePath dest, mode_t mode) noexcept {
     FileDescriptor src_fd{openat(src_dirfd, src, O_RDONLY | O_CLOEXEC)};
@@ -300,11 +648,30 @@ int copyat(int src_dirfd, FilePath src, int dest_dirfd, FilePath dest) noexcept
 }
 
 static uint current_process_threads_num() {
-    auto opt = str2num<uint>(ProcStatFileContents::get(getpid()).field(19));
-    assert(opt.has_value());
-    return *opt;
+    return ProcSampler(getpid()).sample().threads;
+}
+
+namespace {
+
+struct ThreadForkSafeCopyArgs {
+    int src_dirfd;
+    FilePath src;
+    int dest_dirfd;
+    FilePath dest;
+    mode_t mode;
+    int rc;
+    int errnum;
+};
+
+int thread_fork_safe_copyat_child(void* arg) noexcept {
+    auto& args = *static_cast<ThreadForkSafeCopyArgs*>(arg);
+    args.rc = copyat(args.src_dirfd, args.src, args.dest_dirfd, args.dest, args.mode);
+    args.errnum = errno;
+    return 0;
 }
 
+} // namespace
+
 void thread_fork_safe_copyat(
     int src_dirfd, FilePath src, int dest_dirfd, FilePath dest, mode_t mode) {
     STACK_UNWINDING_MARK;
@@ -315,42 +682,22 @@ void thread_fork_safe_copyat(
         return;
     }
 
-    FileDescriptor efd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
-    if (not efd.is_open()) {
-        THROW("eventfd()", errmsg());
-    }
-
-    pid_t child = fork();
-    if (child == -1) {
-        THROW("fork()", errmsg());
-    }
-    if (child == 0) {
-        if (copyat(src_dirfd, src, dest_dirfd, dest, mode)) {
-            uint64_t data = errno;
-            if (write(efd, &data, sizeof(data)) != sizeof(data)) {
-                _exit(2);
-            }
-            _exit(1);
-        }
-        _exit(0);
-    }
-    // Parent process
-    siginfo_t si;
-    if (syscalls::waitid(P_PID, child, &si, WEXITED, nullptr) == -1) {
-        THROW("waitid()", errmsg());
+    // The copying is done by a child that shares memory with this process and
+    // suspends the calling thread until it exits (like vfork()). This way the
+    // destination file is opened for writing only in the child's file
+    // descriptor table, so no concurrent fork() can inherit it, and there is no
+    // need to copy the page tables of the whole process as fork() does.
+    ThreadForkSafeCopyArgs args = {src_dirfd, src, dest_dirfd, dest, mode, -1, 0};
+    int rc = call_in_vfork_like_child(thread_fork_safe_copyat_child, &args);
+    if (rc == -1) {
+        THROW("call_in_vfork_like_child()", errmsg());
     }
-    if (si.si_code != CLD_EXITED or (si.si_status | 1) != 1) {
+    if (rc != 0) {
         THROW("copying within child process failed");
     }
-    if (si.si_status == 0) {
-        return; // Success
-    }
-
-    uint64_t data{};
-    if (read(efd, &data, sizeof(data)) != sizeof(data)) {
-        THROW("read()", errmsg());
+    if (args.rc) {
+        THROW("copy()", errmsg(args.errnum));
     }
-    THROW("copy()", errmsg(data));
 }
 
 /**
@@ -447,6 +794,134 @@ int copy_rat(int src_dirfd, FilePath src, int dest_dirfd, FilePath dest) noexcep
     return copyat(src_dirfd, src, dest_dirfd, dest, sb.st_mode & ACCESSPERMS);
 }
 
+namespace {
+
+class ParallelCopier {
+    concurrent::TaskPool pool_;
+    FirstError error_;
+
+    struct Dir {
+        Directory src_dir;
+        FileDescriptor dest_fd;
+    };
+
+    void copy_files(const Dir& dir, const std::vector<std::string>& names) noexcept {
+        int src_fd = dirfd(dir.src_dir);
+        for (const auto& name : names) {
+            if (error_.is_set()) {
+                return;
+            }
+            if (copyat(src_fd, name, dir.dest_fd, name)) {
+                error_.set(errno);
+            }
+        }
+    }
+
+    // @p parent keeps open the directories that @p src_dirfd and
+    // @p dest_dirfd refer to
+    void add_copy_task(
+        std::shared_ptr<Dir> parent, int src_dirfd, int dest_dirfd, std::string src,
+        std::string dest) {
+        pool_.push([=, parent = std::move(parent), src = std::move(src),
+                    dest = std::move(dest)] { copy(src_dirfd, src, dest_dirfd, dest); });
+    }
+
+    // Does the same as copy_rat_impl() but copies subdirectories and files in
+    // separate tasks
+    void copy(int src_dirfd, const std::string& src, int dest_dirfd, const std::string& dest) {
+        if (error_.is_set()) {
+            return;
+        }
+
+        int src_fd = openat(src_dirfd, src.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (src_fd == -1) {
+            if (errno != ENOTDIR or copyat(src_dirfd, src, dest_dirfd, dest)) {
+                error_.set(errno);
+            }
+            return;
+        }
+
+        auto dir = std::make_shared<Dir>();
+        dir->src_dir = fdopendir(src_fd);
+        if (not dir->src_dir.is_open()) {
+            error_.set(errno);
+            close(src_fd);
+            return;
+        }
+
+        // Do not use src permissions
+        mkdirat(dest_dirfd, dest.c_str(), S_0755);
+
+        dir->dest_fd = openat(dest_dirfd, dest.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (not dir->dest_fd.is_open()) {
+            error_.set(errno);
+            return;
+        }
+
+        std::vector<std::string> files;
+        for_each_dir_component(
+            dir->src_dir,
+            [&](dirent* file) -> repeating {
+                if (error_.is_set()) {
+                    return stop_repeating;
+                }
+#ifdef _DIRENT_HAVE_D_TYPE
+                if (file->d_type == DT_DIR || file->d_type == DT_UNKNOWN) {
+#endif
+                    add_copy_task(dir, src_fd, dir->dest_fd, file->d_name, file->d_name);
+#ifdef _DIRENT_HAVE_D_TYPE
+                } else {
+                    files.emplace_back(file->d_name);
+                    if (files.size() == parallel_files_batch_size) {
+                        pool_.push([this, dir, files = std::move(files)] {
+                            copy_files(*dir, files);
+                        });
+                        files.clear();
+                    }
+                }
+#endif
+                return continue_repeating;
+            },
+            [&] { error_.set(errno); });
+
+        copy_files(*dir, files);
+    }
+
+public:
+    int run(int src_dirfd, FilePath src, int dest_dirfd, FilePath dest,
+            unsigned threads_num) noexcept {
+        try {
+            add_copy_task(nullptr, src_dirfd, dest_dirfd, src.to_str(), dest.to_str());
+            pool_.run(threads_num);
+        } catch (...) {
+            error_.set(ENOMEM);
+        }
+
+        if (error_.is_set()) {
+            errno = error_.get();
+            return -1;
+        }
+        return 0;
+    }
+};
+
+} // namespace
+
+int copy_rat_parallel(
+    int src_dirfd, FilePath src, int dest_dirfd, FilePath dest,
+    unsigned threads_num) noexcept {
+    struct stat64 sb {};
+    if (fstatat64(src_dirfd, src, &sb, 0) == -1) {
+        return -1;
+    }
+
+    if (S_ISDIR(sb.st_mode)) {
+        return ParallelCopier{}.run(src_dirfd, src, dest_dirfd, dest, threads_num);
+    }
+
+    return copyat(src_dirfd, src, dest_dirfd, dest, sb.st_mode & ACCESSPERMS);
+}
+
 int copy_r(FilePath src, FilePath dest, bool create_subdirs) noexcept {
     if (create_subdirs and create_subdirectories(CStringView(dest)) == -1) {
         return -1;
@@ -455,6 +930,15 @@ int copy_r(FilePath src, FilePath dest, bool create_subdirs) noexcept {
     return copy_rat(AT_FDCWD, src, AT_FDCWD, dest);
 }
 
+int copy_r_parallel(
+    FilePath src, FilePath dest, bool create_subdirs, unsigned threads_num) noexcept {
+    if (create_subdirs and create_subdirectories(CStringView(dest)) == -1) {
+        return -1;
+    }
+
+    return copy_rat_parallel(AT_FDCWD, src, AT_FDCWD, dest, threads_num);
+}
+
 int move(FilePath oldpath, FilePath newpath, bool create_subdirs) noexcept {
     if (create_subdirs and create_subdirectories(CStringView(newpath)) == -1) {
         return -1;
@@ -0,0 +1,125 @@
+#include "simlib/hash_file.hh"
+#include "simlib/concurrent/semaphore.hh"
+#include "simlib/concurrent/task_pool.hh"
+#include "simlib/defer.hh"
+#include "simlib/file_contents.hh"
+
+#include <array>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace {
+
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+} // namespace
+
+void read_file_in_chunks(int fd, const std::function<void(StringView)>& consume) {
+    // Only a hint, so errors are irrelevant
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    auto read_chunk = [fd](char* buff) {
+        size_t len = read_all(fd, buff, CHUNK_SIZE);
+        if (errno) {
+            THROW("read()", errmsg());
+        }
+        return len;
+    };
+
+    std::array<std::unique_ptr<char[]>, 2> buffs;
+    buffs[0] = std::make_unique<char[]>(CHUNK_SIZE);
+    size_t len = read_chunk(buffs[0].get());
+    if (len < CHUNK_SIZE) { // Small file -- no need for the second buffer
+        if (len > 0) {
+            consume({buffs[0].get(), len});
+        }
+        return;
+    }
+
+    buffs[1] = std::make_unique<char[]>(CHUNK_SIZE);
+    // One reader thread reads the next chunk into the other buffer while the
+    // current one is being consumed
+    concurrent::Semaphore buff_freed{1}; // buffs[1] is free
+    concurrent::Semaphore buff_filled{0};
+    std::array<size_t, 2> lens = {len, 0};
+    std::exception_ptr read_error;
+    std::atomic<bool> stop_reading{false};
+    std::thread reader([&] {
+        try {
+            for (size_t i = 1;; i ^= 1) {
+                buff_freed.wait();
+                if (stop_reading.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                lens[i] = read_chunk(buffs[i].get());
+                buff_filled.post();
+                if (lens[i] < CHUNK_SIZE) {
+                    return;
+                }
+            }
+        } catch (...) {
+            read_error = std::current_exception();
+            buff_filled.post();
+        }
+    });
+    // Stops the reader if consume() throws
+    Defer reader_joiner([&] {
+        stop_reading.store(true, std::memory_order_relaxed);
+        buff_freed.post();
+        reader.join();
+    });
+
+    for (size_t i = 0;; i ^= 1) {
+        consume({buffs[i].get(), lens[i]});
+        buff_freed.post();
+        buff_filled.wait();
+        if (read_error) {
+            std::rethrow_exception(read_error);
+        }
+        if (lens[i ^ 1] < CHUNK_SIZE) {
+            if (lens[i ^ 1] > 0) {
+                consume({buffs[i ^ 1].get(), lens[i ^ 1]});
+            }
+            return;
+        }
+    }
+}
+
+void read_file_leaves_in_parallel(
+    int fd, off64_t size, size_t leaf_size, unsigned threads_num,
+    const std::function<void(size_t leaf_no, StringView chunk)>& consume) {
+    if (leaf_size == 0) {
+        THROW("leaf_size has to be greater than 0");
+    }
+
+    size_t leaves_num = (size + leaf_size - 1) / leaf_size;
+    concurrent::TaskPool pool;
+    // The most recently pushed task is run first, so push them in the reverse
+    // order to read the file roughly sequentially
+    for (size_t leaf_no = leaves_num; leaf_no-- > 0;) {
+        pool.push([&, leaf_no] {
+            auto buff = std::make_unique<char[]>(CHUNK_SIZE);
+            off64_t pos = leaf_no * leaf_size;
+            off64_t end = std::min<off64_t>(size, pos + leaf_size);
+            while (pos < end) {
+                size_t len = pread_all(
+                    fd, pos, buff.get(), std::min<off64_t>(CHUNK_SIZE, end - pos));
+                if (errno) {
+                    THROW("pread()", errmsg());
+                }
+                if (len == 0) {
+                    break; // The file has been truncated
+                }
+                consume(leaf_no, {buff.get(), len});
+                pos += len;
+            }
+        });
+    }
+
+    if (threads_num == 0) {
+        threads_num = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    pool.run(std::max<size_t>(std::min<size_t>(threads_num, leaves_num), 1));
+}
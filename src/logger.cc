@@ -2,6 +2,8 @@
 #include "simlib/debug.hh"
 #include "simlib/time.hh"
 
+#include <chrono>
+
 using std::string;
 
 Logger::Logger(FilePath filename)
@@ -30,11 +32,12 @@ void Logger::Appender::flush_impl(
 
     if (logger_.lock()) {
         if (label_) {
-            try {
+            auto date = mysql_localdate_buff(std::chrono::system_clock::now());
+            if (date.size() > 0) {
                 fprintf(
-                    logger_.f_, format1, mysql_localdate().c_str(),
-                    static_cast<int>(buff_.size), buff_.data());
-            } catch (const std::exception&) {
+                    logger_.f_, format1, date.c_str(), static_cast<int>(buff_.size),
+                    buff_.data());
+            } else {
                 fprintf(logger_.f_, format2, static_cast<int>(buff_.size), buff_.data());
             }
         } else {
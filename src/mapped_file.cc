@@ -0,0 +1,108 @@
+#include "simlib/mapped_file.hh"
+#include "simlib/debug.hh"
+#include "simlib/file_contents.hh"
+#include "simlib/file_descriptor.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct Range {
+    off64_t beg, end;
+};
+
+// Clamps [beg, end) to the file of size @p size the same way
+// get_file_contents() does
+Range clamp_range(off64_t size, off64_t beg, off64_t end) noexcept {
+    if (beg < 0) {
+        beg = std::max<off64_t>(size + beg, 0);
+    }
+    if (beg > size) {
+        return {size, size};
+    }
+    if (size < end or end < 0) {
+        end = size;
+    }
+    if (end < beg) {
+        end = beg;
+    }
+    return {beg, end};
+}
+
+FileDescriptor open_for_reading(FilePath file) {
+    FileDescriptor fd;
+    for (;;) {
+        fd.open(file, O_RDONLY | O_CLOEXEC);
+        if (fd.is_open() or errno != EINTR) {
+            break;
+        }
+    }
+
+    if (not fd.is_open()) {
+        THROW("Failed to open file `", file, '`', errmsg());
+    }
+
+    return fd;
+}
+
+} // namespace
+
+MappedFile::MappedFile(int fd, off64_t beg, off64_t end) {
+    struct stat64 st {};
+    if (fstat64(fd, &st)) {
+        THROW("fstat64()", errmsg());
+    }
+
+    if (not S_ISREG(st.st_mode) or st.st_size == 0) {
+        // Pipes, sockets, procfs etc. -- they cannot be mapped (or their
+        // size is unknown)
+        buff_ = get_file_contents(fd);
+        auto [b, e] = clamp_range(buff_.size(), beg, end);
+        buff_.erase(e);
+        buff_.erase(0, b);
+        size_ = buff_.size();
+        return;
+    }
+
+    auto [b, e] = clamp_range(st.st_size, beg, end);
+    if (b == e) {
+        return; // Nothing to map
+    }
+
+    static const off64_t page_size = sysconf(_SC_PAGESIZE);
+    off64_t map_beg = b - b % page_size;
+    size_t len = e - map_beg;
+    void* addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, map_beg);
+    if (addr == MAP_FAILED) {
+        if (errno != ENODEV) {
+            THROW("mmap()", errmsg());
+        }
+
+        // The filesystem does not support mapping
+        buff_ = get_file_contents(fd, b, e);
+        size_ = buff_.size();
+        return;
+    }
+
+    // These are only hints, so errors are irrelevant
+    (void)madvise(addr, len, MADV_SEQUENTIAL);
+    (void)madvise(addr, len, MADV_WILLNEED);
+
+    addr_ = addr;
+    mapped_len_ = len;
+    offset_ = b - map_beg;
+    size_ = e - b;
+}
+
+MappedFile::MappedFile(FilePath file, off64_t beg, off64_t end)
+: MappedFile(open_for_reading(file), beg, end) {}
+
+void MappedFile::unmap() noexcept {
+    if (addr_) {
+        (void)munmap(addr_, mapped_len_);
+        addr_ = nullptr;
+    }
+}
@@ -0,0 +1,121 @@
+#include "simlib/memfd.hh"
+#include "simlib/file_manip.hh"
+#include "simlib/process.hh"
+
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+FileDescriptor open_memfd(CStringView name) noexcept {
+    return FileDescriptor(memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING));
+}
+
+FileDescriptor seal_memfd(int fd) noexcept {
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)) {
+        return FileDescriptor{};
+    }
+
+    // Reopening gives a new open file description, so its offset is 0 and
+    // it cannot be used for writing
+    return FileDescriptor(fd_path(fd), O_RDONLY | O_CLOEXEC);
+}
+
+namespace {
+
+constexpr size_t fd_control_len = CMSG_SPACE(sizeof(int));
+
+int send_fd(int socket_fd, int fd) noexcept {
+    char byte = 0;
+    iovec iov = {&byte, 1};
+    alignas(cmsghdr) std::array<char, fd_control_len> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    return (sendmsg(socket_fd, &msg, MSG_NOSIGNAL) == 1 ? 0 : -1);
+}
+
+FileDescriptor receive_fd(int socket_fd) noexcept {
+    char byte = 0;
+    iovec iov = {&byte, 1};
+    alignas(cmsghdr) std::array<char, fd_control_len> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    if (recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC) != 1) {
+        return FileDescriptor{};
+    }
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (not cmsg or cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) {
+        errno = EPROTO;
+        return FileDescriptor{};
+    }
+    int fd = -1;
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return FileDescriptor(fd);
+}
+
+struct CopyToSealedMemfdArgs {
+    int src_fd;
+    CStringView name;
+    int socket_fd; // the sealed memfd is sent through it
+    int errnum;
+};
+
+int copy_to_sealed_memfd_child(void* arg) noexcept {
+    auto& args = *static_cast<CopyToSealedMemfdArgs*>(arg);
+    FileDescriptor memfd = open_memfd(args.name);
+    if (not memfd.is_open() or blast(args.src_fd, memfd)) {
+        args.errnum = errno;
+        return 1;
+    }
+
+    FileDescriptor sealed = seal_memfd(memfd);
+    if (not sealed.is_open() or send_fd(args.socket_fd, sealed)) {
+        args.errnum = errno;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+FileDescriptor copy_to_sealed_memfd(FilePath path, CStringView name) noexcept {
+    FileDescriptor src(path, O_RDONLY | O_CLOEXEC);
+    if (not src.is_open()) {
+        return src;
+    }
+
+    std::array<int, 2> sockets{};
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sockets.data())) {
+        return FileDescriptor{};
+    }
+    FileDescriptor receiving_socket(sockets[0]);
+    FileDescriptor sending_socket(sockets[1]);
+
+    // The memfd is written only in the child's file descriptor table (see
+    // thread_fork_safe_copyat() for the race that this avoids)
+    CopyToSealedMemfdArgs args = {src, name, sending_socket, 0};
+    int rc = call_in_vfork_like_child(copy_to_sealed_memfd_child, &args);
+    if (rc == -1) {
+        return FileDescriptor{};
+    }
+    if (rc != 0) {
+        errno = args.errnum;
+        return FileDescriptor{};
+    }
+
+    return receive_fd(receiving_socket);
+}
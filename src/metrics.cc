@@ -0,0 +1,132 @@
+#include "simlib/metrics.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/string_view.hh"
+
+#include <algorithm>
+#include <vector>
+
+namespace metrics {
+
+namespace {
+
+// Head of the list of all metrics, constant-initialized, so that metrics may
+// be registered during the dynamic initialization of other translation units
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<Metric*> all_metrics{nullptr};
+
+// Formats @p val / 10^@p decimals without trailing zeros in the fractional part
+std::string to_decimal(uint64_t val, unsigned decimals) {
+    auto digits = concat_tostr(val);
+    if (decimals == 0) {
+        return digits;
+    }
+
+    if (digits.size() <= decimals) {
+        digits.insert(0, decimals + 1 - digits.size(), '0');
+    }
+    digits.insert(digits.size() - decimals, 1, '.');
+    while (digits.back() == '0') {
+        digits.pop_back();
+    }
+    if (digits.back() == '.') {
+        digits.pop_back();
+    }
+    return digits;
+}
+
+// Escapes the HELP text as the Prometheus text format requires
+std::string escape_help(const char* help) {
+    std::string res;
+    for (; *help; ++help) {
+        switch (*help) {
+        case '\\': res += "\\\\"; break;
+        case '\n': res += "\\n"; break;
+        default: res += *help;
+        }
+    }
+    return res;
+}
+
+} // namespace
+
+size_t detail::next_thread_shard() noexcept {
+    static std::atomic<size_t> next_shard{0};
+    return next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+}
+
+Metric::Metric(const char* name, const char* help) noexcept
+: name_(name)
+, help_(help)
+, next_(all_metrics.load(std::memory_order_relaxed)) {
+    while (not all_metrics.compare_exchange_weak(
+        next_, this, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t Counter::value() const noexcept {
+    uint64_t res = 0;
+    for (const auto& shard : shards_) {
+        res += shard.val.load(std::memory_order_relaxed);
+    }
+    return res;
+}
+
+void Counter::append_samples(std::string& out) const {
+    back_insert(out, name(), ' ', value(), '\n');
+}
+
+void Gauge::append_samples(std::string& out) const {
+    back_insert(out, name(), ' ', value(), '\n');
+}
+
+Histogram::Snapshot Histogram::snapshot() const noexcept {
+    Snapshot res{};
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            res.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        res.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    for (auto cnt : res.buckets) {
+        res.count += cnt;
+    }
+    return res;
+}
+
+void Histogram::append_samples(std::string& out) const {
+    auto snap = snapshot();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        if (snap.buckets[i] == 0) {
+            continue;
+        }
+        cumulative += snap.buckets[i];
+        back_insert(
+            out, name(), "_bucket{le=\"", to_decimal(bucket_upper_bound(i), unit_decimals_),
+            "\"} ", cumulative, '\n');
+    }
+    back_insert(out, name(), "_bucket{le=\"+Inf\"} ", snap.count, '\n');
+    back_insert(out, name(), "_sum ", to_decimal(snap.sum, unit_decimals_), '\n');
+    back_insert(out, name(), "_count ", snap.count, '\n');
+}
+
+std::string render_prometheus() {
+    std::vector<const Metric*> metrics;
+    for (auto* m = all_metrics.load(std::memory_order_acquire); m; m = m->next_) {
+        metrics.emplace_back(m);
+    }
+    std::sort(metrics.begin(), metrics.end(), [](const Metric* a, const Metric* b) {
+        return StringView(a->name()) < StringView(b->name());
+    });
+
+    std::string res;
+    for (const auto* m : metrics) {
+        back_insert(res, "# HELP ", m->name(), ' ', escape_help(m->help()), '\n');
+        back_insert(res, "# TYPE ", m->name(), ' ', m->type(), '\n');
+        m->append_samples(res);
+    }
+    return res;
+}
+
+} // namespace metrics
@@ -0,0 +1,112 @@
+#include "simlib/murmur_hash.hh"
+#include "simlib/string_transform.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+constexpr uint64_t rotl(uint64_t x, int n) noexcept { return (x << n) | (x >> (64 - n)); }
+
+uint64_t load_le64(const unsigned char* p) noexcept {
+    uint64_t res = 0;
+    for (int i = 7; i >= 0; --i) {
+        res = (res << 8) | p[i];
+    }
+    return res;
+}
+
+constexpr uint64_t mix_k1(uint64_t k1) noexcept { return rotl(k1 * C1, 31) * C2; }
+
+constexpr uint64_t mix_k2(uint64_t k2) noexcept { return rotl(k2 * C2, 33) * C1; }
+
+constexpr uint64_t fmix64(uint64_t k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+} // namespace
+
+void Murmur3Hash128::process_blocks(const unsigned char* data, size_t blocks) noexcept {
+    uint64_t h1 = h1_;
+    uint64_t h2 = h2_;
+    for (; blocks > 0; --blocks, data += 16) {
+        h1 ^= mix_k1(load_le64(data));
+        h1 = rotl(h1, 27) + h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        h2 ^= mix_k2(load_le64(data + 8));
+        h2 = rotl(h2, 31) + h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+    h1_ = h1;
+    h2_ = h2;
+}
+
+void Murmur3Hash128::update(StringView str) noexcept {
+    auto data = reinterpret_cast<const unsigned char*>(str.data());
+    size_t len = str.size();
+    total_len_ += len;
+
+    if (buff_len_ > 0) {
+        size_t n = std::min(len, buff_.size() - buff_len_);
+        std::memcpy(buff_.data() + buff_len_, data, n);
+        buff_len_ += n;
+        data += n;
+        len -= n;
+        if (buff_len_ < buff_.size()) {
+            return;
+        }
+        process_blocks(buff_.data(), 1);
+        buff_len_ = 0;
+    }
+
+    process_blocks(data, len / 16);
+    data += len / 16 * 16;
+    len %= 16;
+
+    std::memcpy(buff_.data(), data, len);
+    buff_len_ = len;
+}
+
+Murmur3Hash128::Digest Murmur3Hash128::digest() const noexcept {
+    uint64_t h1 = h1_;
+    uint64_t h2 = h2_;
+    // The tail, bytes past buff_len_ are zeros
+    std::array<unsigned char, 16> tail{};
+    std::copy(buff_.begin(), buff_.begin() + buff_len_, tail.begin());
+    if (buff_len_ > 8) {
+        h2 ^= mix_k2(load_le64(tail.data() + 8));
+    }
+    if (buff_len_ > 0) {
+        h1 ^= mix_k1(load_le64(tail.data()));
+    }
+
+    h1 ^= total_len_;
+    h2 ^= total_len_;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    Digest res;
+    for (int i = 0; i < 8; ++i) {
+        res[i] = static_cast<unsigned char>(h1 >> (i * 8));
+        res[i + 8] = static_cast<unsigned char>(h2 >> (i * 8));
+    }
+    return res;
+}
+
+InplaceBuff<32> murmur3_128(StringView str, uint32_t seed) {
+    auto digest = murmur3_128_digest(str, seed);
+    return to_hex<32>({reinterpret_cast<const char*>(digest.data()), digest.size()});
+}
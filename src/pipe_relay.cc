@@ -0,0 +1,238 @@
+#include "simlib/pipe_relay.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/debug.hh"
+#include "simlib/file_contents.hh"
+#include "simlib/pipe.hh"
+#include "simlib/signal_blocking.hh"
+
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <optional>
+#include <poll.h>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Blocks SIGPIPE in the calling thread, so that splicing to a pipe without
+// readers fails with EPIPE instead of killing the process
+class SigpipeBlocker {
+    static const sigset_t sigpipe_mask;
+
+    ThreadSignalBlocker blocker_{sigpipe_mask};
+
+    static sigset_t sigpipe_mask_val() noexcept {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGPIPE);
+        return mask;
+    }
+
+public:
+    SigpipeBlocker() = default;
+
+    SigpipeBlocker(const SigpipeBlocker&) = delete;
+    SigpipeBlocker(SigpipeBlocker&&) = delete;
+    SigpipeBlocker& operator=(const SigpipeBlocker&) = delete;
+    SigpipeBlocker& operator=(SigpipeBlocker&&) = delete;
+
+    ~SigpipeBlocker() {
+        if (blocker_.was_blocked(SIGPIPE)) {
+            return;
+        }
+        // Discard SIGPIPE generated while it was blocked, before blocker_
+        // restores the old mask
+        timespec no_wait{};
+        while (sigtimedwait(&sigpipe_mask, nullptr, &no_wait) == SIGPIPE) {
+        }
+    }
+};
+
+const sigset_t SigpipeBlocker::sigpipe_mask = SigpipeBlocker::sigpipe_mask_val();
+
+struct ChannelState {
+    PipeRelayChannel& channel;
+    // Holds data spliced from the source until it is spliced to the sink, so
+    // that it can be recorded exactly once
+    Pipe staging;
+    size_t pending = 0; // number of bytes in staging
+
+    [[nodiscard]] bool done() const noexcept { return channel.source < 0 and pending == 0; }
+};
+
+} // namespace
+
+string relay_pipes(vector<PipeRelayChannel>& channels, size_t transcript_max_len) {
+    STACK_UNWINDING_MARK;
+    SigpipeBlocker sigpipe_blocker;
+
+    vector<ChannelState> states;
+    states.reserve(channels.size());
+    for (auto& channel : channels) {
+        auto staging = pipe2(O_CLOEXEC);
+        if (not staging) {
+            THROW("pipe2()", errmsg());
+        }
+        states.push_back({channel, std::move(*staging)});
+    }
+    if (states.empty()) {
+        return {};
+    }
+
+    // A chunk fits into an empty pipe of the default capacity, so that it can
+    // be tee'd to the record pipe as a whole
+    int chunk_max_len = fcntl(states[0].staging.writable, F_GETPIPE_SZ);
+    if (chunk_max_len <= 0) {
+        THROW("fcntl(F_GETPIPE_SZ)", errmsg());
+    }
+
+    std::optional<Pipe> record;
+    if (transcript_max_len > 0) {
+        record = pipe2(O_CLOEXEC);
+        if (not record) {
+            THROW("pipe2()", errmsg());
+        }
+    }
+
+    string transcript;
+    size_t recorded_len = 0;
+    bool truncated = false;
+    const PipeRelayChannel* last_recorded_channel = nullptr;
+    auto end_line = [&] {
+        if (not transcript.empty() and transcript.back() != '\n') {
+            transcript += '\n';
+        }
+    };
+    // Records the @p len bytes that are in @p st.staging
+    auto record_staging = [&](ChannelState& st, size_t len) {
+        if (not record or truncated) {
+            return;
+        }
+
+        size_t len_to_record = std::min(len, transcript_max_len - recorded_len);
+        ssize_t rc = 0;
+        if (len_to_record > 0) {
+            rc = tee(st.staging.readable, record->writable, len_to_record, SPLICE_F_NONBLOCK);
+            if (rc < 0) {
+                THROW("tee()", errmsg());
+            }
+        }
+        if (rc > 0) {
+            if (&st.channel != last_recorded_channel) {
+                end_line();
+                back_insert(transcript, '[', st.channel.name, "]\n");
+                last_recorded_channel = &st.channel;
+            }
+            size_t old_len = transcript.size();
+            transcript.resize(old_len + rc);
+            if (read_all(record->readable, transcript.data() + old_len, rc) !=
+                static_cast<size_t>(rc))
+            {
+                THROW("read()", errmsg());
+            }
+            recorded_len += rc;
+        }
+        if (recorded_len == transcript_max_len and static_cast<size_t>(rc) < len) {
+            end_line();
+            transcript += "[truncated]\n";
+            truncated = true;
+        } else if (static_cast<size_t>(rc) < len_to_record) {
+            // tee() copied less than asked, and the rest of the chunk cannot be
+            // tee'd without its beginning, so mark the gap and record on
+            end_line();
+            transcript += "[truncated]\n";
+            last_recorded_channel = nullptr; // Repeat the channel name after the gap
+        }
+    };
+
+    // The sink has no readers, so neither has the source
+    auto drop = [&](ChannelState& st) {
+        (void)st.channel.source.close();
+        (void)st.channel.sink.close();
+        st.pending = 0;
+    };
+
+    auto deliver = [&](ChannelState& st) {
+        while (st.pending > 0) {
+            ssize_t rc = splice(
+                st.staging.readable, nullptr, st.channel.sink, nullptr, st.pending,
+                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (rc > 0) {
+                st.pending -= rc;
+            } else if (errno == EAGAIN) {
+                return; // The sink is full
+            } else if (errno == EPIPE) {
+                drop(st);
+                return;
+            } else {
+                THROW("splice()", errmsg());
+            }
+        }
+        if (st.channel.source < 0) {
+            (void)st.channel.sink.close(); // Pass EOF on
+        }
+    };
+
+    auto pull = [&](ChannelState& st) {
+        ssize_t rc = splice(
+            st.channel.source, nullptr, st.staging.writable, nullptr, chunk_max_len,
+            SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (rc > 0) {
+            st.pending = rc;
+            record_staging(st, rc);
+            deliver(st);
+        } else if (rc == 0) {
+            // EOF
+            (void)st.channel.source.close();
+            (void)st.channel.sink.close();
+        } else if (errno != EAGAIN) {
+            THROW("splice()", errmsg());
+        }
+    };
+
+    // pfds[2 * i] is the source and pfds[2 * i + 1] is the sink of channel i
+    vector<pollfd> pfds(2 * states.size());
+    for (;;) {
+        bool all_done = true;
+        for (size_t i = 0; i < states.size(); ++i) {
+            auto& st = states[i];
+            all_done &= st.done();
+            // Negative file descriptors are ignored by poll()
+            pfds[2 * i] = {st.pending == 0 ? int(st.channel.source) : -1, POLLIN, 0};
+            // Sink without readers is reported (POLLERR) even if no events are
+            // requested
+            short sink_events = (st.pending > 0 ? POLLOUT : 0);
+            pfds[2 * i + 1] = {st.channel.sink, sink_events, 0};
+        }
+        if (all_done) {
+            break;
+        }
+
+        if (poll(pfds.data(), pfds.size(), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            THROW("poll()", errmsg());
+        }
+
+        for (size_t i = 0; i < states.size(); ++i) {
+            auto& st = states[i];
+            auto sink_events = pfds[2 * i + 1].revents;
+            if ((sink_events & POLLERR) and st.pending == 0) {
+                drop(st);
+                continue;
+            }
+            if (sink_events) {
+                deliver(st);
+            }
+            if (pfds[2 * i].revents and st.pending == 0 and st.channel.source >= 0) {
+                pull(st);
+            }
+        }
+    }
+
+    return transcript;
+}
@@ -0,0 +1,185 @@
+#include "simlib/proc_sampler.hh"
+#include "simlib/concat.hh"
+#include "simlib/ctype.hh"
+#include "simlib/debug.hh"
+#include "simlib/fd_pread_buff.hh"
+#include "simlib/string_transform.hh"
+
+#include <array>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+
+using std::chrono::nanoseconds;
+
+namespace {
+
+FileDescriptor open_proc_file(pid_t pid, StringView name) {
+    auto path = concat<64>("/proc/", pid, '/', name);
+    FileDescriptor fd(path.to_cstr(), O_RDONLY | O_CLOEXEC);
+    if (not fd.is_open()) {
+        THROW("open(", path, ')', errmsg());
+    }
+    return fd;
+}
+
+uint64_t page_size() noexcept {
+    static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+nanoseconds clock_ticks_to_ns(uint64_t ticks) noexcept {
+    static const uint64_t ticks_per_sec = sysconf(_SC_CLK_TCK);
+    return nanoseconds{ticks * 1'000'000'000 / ticks_per_sec};
+}
+
+} // namespace
+
+ProcSampler::ProcSampler(pid_t pid)
+: statm_fd_(open_proc_file(pid, "statm"))
+, stat_fd_(open_proc_file(pid, "stat")) {}
+
+ProcSampler::Statm ProcSampler::read_statm() const {
+    BasicFdPreadBuff<64> fbuff(statm_fd_);
+    auto read_field = [&] {
+        auto token = fbuff.read_token();
+        if (not token) {
+            if (errno == 0) {
+                THROW("unexpected end of /proc/pid/statm file");
+            }
+            THROW("pread()", errmsg());
+        }
+        auto opt = str2num<uint64_t>(*token);
+        if (not opt) {
+            THROW("invalid field in /proc/pid/statm: \"", *token, '"');
+        }
+        return *opt;
+    };
+
+    Statm res{};
+    res.vm_size = read_field();
+    res.rss = read_field();
+    return res;
+}
+
+ProcSample ProcSampler::sample() const {
+    std::array<char, 4096> buff{};
+    ssize_t rc = pread(stat_fd_, buff.data(), buff.size(), 0);
+    if (rc < 0) {
+        THROW("pread()", errmsg());
+    }
+    if (rc == 0) {
+        THROW("unexpected end of /proc/pid/stat file");
+    }
+
+    StringView str(buff.data(), rc);
+    // The executable name (field 1) is in parentheses and may contain spaces
+    // and parentheses, so the fields are counted from the last ')'
+    auto pos = str.rfind(')');
+    if (pos == StringView::npos) {
+        THROW("invalid /proc/pid/stat: no ')' found");
+    }
+    str.remove_prefix(pos + 1);
+
+    ProcSample res;
+    constexpr size_t LAST_NEEDED_FIELD = 23;
+    for (size_t field_no = 2; field_no <= LAST_NEEDED_FIELD; ++field_no) {
+        str.remove_leading(is_space<char>);
+        auto field = str.extract_leading([](char c) { return not is_space(c); });
+        if (field.empty()) {
+            THROW("invalid /proc/pid/stat: too few fields");
+        }
+
+        auto get_num = [&] {
+            auto opt = str2num<uint64_t>(field);
+            if (not opt) {
+                THROW("invalid field ", field_no, " in /proc/pid/stat: \"", field, '"');
+            }
+            return *opt;
+        };
+
+        switch (field_no) {
+        case 13: res.utime = clock_ticks_to_ns(get_num()); break;
+        case 14: res.stime = clock_ticks_to_ns(get_num()); break;
+        case 19: res.threads = get_num(); break;
+        case 22: res.vm_size = get_num(); break;
+        case 23: res.rss = get_num() * page_size(); break;
+        default: break;
+        }
+    }
+    return res;
+}
+
+std::optional<ProcSchedStat> read_proc_schedstat(pid_t pid) {
+    auto path = concat<64>("/proc/", pid, "/schedstat");
+    FileDescriptor fd(path.to_cstr(), O_RDONLY | O_CLOEXEC);
+    if (not fd.is_open()) {
+        int errnum = errno;
+        auto proc_dir = concat<64>("/proc/", pid);
+        if (errnum == ENOENT and access(proc_dir.to_cstr().data(), F_OK) == 0) {
+            return std::nullopt; // The process exists, but the file does not
+        }
+        THROW("open(", path, ')', errmsg(errnum));
+    }
+
+    BasicFdPreadBuff<64> fbuff(fd);
+    auto read_field = [&] {
+        auto token = fbuff.read_token();
+        if (not token) {
+            if (errno == 0) {
+                THROW("unexpected end of /proc/pid/schedstat file");
+            }
+            THROW("pread()", errmsg());
+        }
+        auto opt = str2num<uint64_t>(*token);
+        if (not opt) {
+            THROW("invalid field in /proc/pid/schedstat: \"", *token, '"');
+        }
+        return *opt;
+    };
+
+    ProcSchedStat res;
+    res.run_time = nanoseconds{read_field()};
+    res.run_queue_wait_time = nanoseconds{read_field()};
+    res.timeslices = read_field();
+    return res;
+}
+
+PeriodicProcSampler::PeriodicProcSampler(pid_t pid, nanoseconds interval) {
+    thread_ = std::thread([this, sampler = ProcSampler(pid), interval] {
+        // Signals (e.g. the ones used by timers) should be handled by other
+        // threads
+        sigset_t mask;
+        sigfillset(&mask);
+        (void)pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto now = start;; now = std::chrono::steady_clock::now()) {
+            ProcSample sample;
+            try {
+                sample = sampler.sample();
+            } catch (...) {
+                return; // The process is not available anymore
+            }
+            sample.time = now - start;
+
+            std::unique_lock lock(mtx_);
+            samples_.emplace_back(sample);
+            if (stop_cv_.wait_for(lock, interval, [&] { return stop_requested_; })) {
+                return;
+            }
+        }
+    });
+}
+
+std::vector<ProcSample> PeriodicProcSampler::stop() noexcept {
+    {
+        std::lock_guard lock(mtx_);
+        stop_requested_ = true;
+    }
+    stop_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    return std::exchange(samples_, {});
+}
@@ -1,6 +1,7 @@
 #include "simlib/proc_status_file.hh"
 #include "simlib/debug.hh"
 #include "simlib/fd_pread_buff.hh"
+#include "simlib/string_traits.hh"
 
 FileDescriptor open_proc_status(pid_t tid) noexcept {
     constexpr StringView prefix = "/proc/";
@@ -20,51 +21,29 @@ FileDescriptor open_proc_status(pid_t tid) noexcept {
 }
 
 InplaceBuff<24> field_from_proc_status(int proc_status_fd, StringView field_name) {
-    InplaceBuff<24> res;
     FdPreadBuff fbuff(proc_status_fd);
-    auto get_char_or_eof = [&] {
-        auto c_opt = fbuff.get_char();
-        if (not c_opt) {
-            THROW("read()", errmsg());
-        }
-        return *c_opt;
-    };
-    auto get_char = [&] {
-        int c = get_char_or_eof();
-        if (c == EOF) {
-            THROW("field \"", field_name, "\" was not found");
-        }
-        return c;
-    };
-    auto skip_to_newline = [&] {
-        int c{};
-        do {
-            c = get_char();
-        } while (c != '\n');
-    };
     for (;;) {
-    next_iter:;
-        for (char fc : field_name) {
-            int c = get_char();
-            if (c != fc) {
-                skip_to_newline();
-                goto next_iter;
+        auto line = fbuff.read_line();
+        if (not line) {
+            if (errno) {
+                THROW("read()", errmsg());
             }
+            THROW("field \"", field_name, "\" was not found");
         }
-        int c = get_char();
-        if (c != ':') {
-            skip_to_newline();
-            continue;
+
+        if (line->size() > field_name.size() and has_prefix(*line, field_name) and
+            (*line)[field_name.size()] == ':')
+        {
+            line->remove_prefix(field_name.size() + 1);
+            return InplaceBuff<24>(
+                line->without_leading([](char c) { return c == ' ' or c == '\t'; }));
         }
-        // Skip white space
-        do {
-            c = get_char_or_eof();
-        } while (c == '\t' or c == '\n');
-        // Retrieve the field contents
-        while (c != '\n' and c != EOF) {
-            res.append(static_cast<char>(c));
-            c = get_char_or_eof();
+
+        if (line->size() == fbuff.buff_size) {
+            // The line is longer than the buffer, skip the rest of it
+            if (not fbuff.skip_until('\n')) {
+                THROW("read()", errmsg());
+            }
         }
-        return res;
     }
 }
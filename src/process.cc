@@ -1,21 +1,31 @@
 #include "simlib/process.hh"
+#include "simlib/call_in_destructor.hh"
+#include "simlib/concat.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/concurrent/task_pool.hh"
 #include "simlib/debug.hh"
-#include "simlib/directory.hh"
-#include "simlib/file_contents.hh"
+#include "simlib/file_descriptor.hh"
 #include "simlib/path.hh"
-#include "simlib/proc_stat_file_contents.hh"
-#include "simlib/string_traits.hh"
+#include "simlib/signal_blocking.hh"
 #include "simlib/string_transform.hh"
+#include "simlib/syscalls.hh"
+#include "simlib/utilities.hh"
 #include "simlib/working_directory.hh"
 
-#include <functional>
+#include <algorithm>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <sched.h>
+#include <sys/mman.h>
 #include <thread>
 #include <unistd.h>
+#include <utility>
 
 using std::array;
-using std::not_fn;
 using std::optional;
-using std::pair;
 using std::string;
 using std::vector;
 using std::chrono::duration;
@@ -41,18 +51,24 @@ string executable_path(pid_t pid) {
     return string(buff.data(), rc);
 }
 
-vector<pid_t> find_processes_by_executable_path(vector<string> exec_set, bool include_me) {
-    if (exec_set.empty()) {
-        return {};
-    }
+namespace {
 
-    pid_t pid = 0;
-    pid_t my_pid = (include_me ? -1 : getpid());
-    Directory dir("/proc");
-    if (dir == nullptr) {
+FileDescriptor open_proc_dir() {
+    FileDescriptor proc_fd("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (not proc_fd.is_open()) {
         THROW("Cannot open /proc directory", errmsg());
     }
+    return proc_fd;
+}
 
+/**
+ * @brief Makes paths in @p exec_set absolute, adds their " (deleted)" variants
+ *   and sorts @p exec_set
+ *
+ * @return size of a buffer that can hold any path from @p exec_set and a
+ *   terminating null character
+ */
+size_t prepare_exec_set(vector<string>& exec_set) {
     decltype(get_cwd()) cwd;
     for (auto& exec : exec_set) {
         if (exec.front() != '/') {
@@ -76,158 +92,220 @@ vector<pid_t> find_processes_by_executable_path(vector<string> exec_set, bool in
     }
 
     sort(exec_set); // To make binary search possible
-    ++buff_size; // For a terminating null character
-
-    vector<pid_t> res;
-    for_each_dir_component(dir, [&](dirent* file) {
-        auto pid_opt = str2num<pid_t>(file->d_name);
-        if (not pid_opt or *pid_opt < 1) {
-            return; // Not a process
-        }
+    return buff_size + 1; // For a terminating null character
+}
 
-        pid = *pid_opt;
-        if (pid == my_pid) {
-            return; // Do not need to check myself
+// Returns pids of all processes listed in /proc (@p proc_fd)
+vector<pid_t> list_pids(int proc_fd) {
+    // Big enough to read /proc with a few getdents64() calls even if there are
+    // tens of thousands of processes
+    constexpr size_t BUFF_SIZE = 256 << 10;
+    auto buff = std::make_unique<char[]>(BUFF_SIZE);
+    vector<pid_t> pids;
+    for (;;) {
+        auto len = syscalls::getdents64(proc_fd, buff.get(), BUFF_SIZE);
+        if (len == 0) {
+            break;
         }
-
-        // Process exe_path (/proc/pid/exe)
-        string exe_path = concat_tostr("/proc/", file->d_name, "/exe");
-
-        InplaceBuff<32> buff(buff_size);
-        ssize_t len = readlink(exe_path.c_str(), buff.data(), buff_size);
-        if (len == -1 || len >= static_cast<ssize_t>(buff_size)) {
-            return; // Error or name too long
+        if (len < 0) {
+            THROW("getdents64()", errmsg());
         }
 
-        buff.size = len;
-        buff[len] = '\0';
-
-        if (binary_search(exec_set, StringView{buff})) {
-            res.emplace_back(pid); // We have a match
+        for (long pos = 0; pos < len;) {
+            const auto* entry = reinterpret_cast<const dirent64*>(buff.get() + pos);
+            pos += entry->d_reclen;
+            auto pid = str2num<pid_t>(entry->d_name);
+            if (pid and *pid > 0) {
+                pids.emplace_back(*pid);
+            } // Otherwise it is not a process
         }
-    });
+    }
+    return pids;
+}
 
-    return res;
+// Returns whether the executable of the process @p pid is in @p exec_set
+// (prepared by prepare_exec_set()), @p buff has to be of the size returned by
+// prepare_exec_set()
+bool has_executable_in(
+    int proc_fd, pid_t pid, const vector<string>& exec_set, InplaceBuff<PATH_MAX>& buff) {
+    auto exe_path = concat<32>(pid, "/exe");
+    ssize_t len = readlinkat(proc_fd, exe_path.to_cstr().data(), buff.data(), buff.size);
+    if (len == -1 or len >= static_cast<ssize_t>(buff.size)) {
+        return false; // Error or name too long
+    }
+    return binary_search(exec_set, StringView{buff.data(), static_cast<size_t>(len)});
 }
 
-void kill_processes_by_exec(
-    vector<string> exec_set, optional<duration<double>> wait_timeout, bool kill_after_waiting,
-    int terminate_signal) {
-    STACK_UNWINDING_MARK;
-    // TODO: change every ProcStatFileContents::get() to open file by
-    // FileDescriptor and use ProcStatFileContents::from_proc_stat_contents()
-    // and don't fail if the file does not exists -- it means that the process
-    // is already dead
-    constexpr uint START_TIME_FID = 21; // Number of the field in /proc/[pid]/stat that
-                                        // contains process start time
-
-    using Victim = pair<pid_t, string>;
-    vector<Victim> victims;
-    for (pid_t pid : find_processes_by_executable_path(std::move(exec_set))) {
-        try {
-            victims.emplace_back(
-                pid, ProcStatFileContents::get(pid).field(START_TIME_FID).to_string());
-        } catch (...) {
-            // Ignore if process already died
-            if (kill(pid, 0) == 0 or errno != ESRCH) {
-                throw;
-            }
+vector<pid_t> find_processes(
+    int proc_fd, const vector<string>& exec_set, size_t buff_size, bool include_me,
+    unsigned threads_num) {
+    pid_t my_pid = (include_me ? -1 : getpid());
+    auto pids = list_pids(proc_fd);
+    // Every scan writes only its own range of matched, so no locking is needed
+    vector<uint8_t> matched(pids.size(), false);
+    auto scan = [&](size_t beg, size_t end) {
+        InplaceBuff<PATH_MAX> buff(buff_size);
+        for (size_t i = beg; i < end; ++i) {
+            matched[i] =
+                (pids[i] != my_pid and has_executable_in(proc_fd, pids[i], exec_set, buff));
         }
+    };
+
+    constexpr size_t PIDS_PER_TASK = 256;
+    if (threads_num == 1 or pids.size() <= PIDS_PER_TASK) {
+        scan(0, pids.size());
+    } else {
+        concurrent::TaskPool pool;
+        for (size_t beg = 0; beg < pids.size(); beg += PIDS_PER_TASK) {
+            pool.push([&, beg] { scan(beg, std::min(beg + PIDS_PER_TASK, pids.size())); });
+        }
+        pool.run(threads_num);
     }
 
-    if (victims.empty()) {
-        return;
+    vector<pid_t> res;
+    for (size_t i = 0; i < pids.size(); ++i) {
+        if (matched[i]) {
+            res.emplace_back(pids[i]); // We have a match
+        }
     }
+    return res;
+}
 
-    using std::chrono_literals::operator""s;
-
-    auto ticks_per_second = sysconf(_SC_CLK_TCK);
-    if (ticks_per_second == -1) {
-        THROW("sysconf(_SC_CLK_TCK) failed");
-    }
+} // namespace
 
-    StringView max_victim_start_time;
-    for (auto& [pid, start_time] : victims) {
-        if (start_time > max_victim_start_time) {
-            max_victim_start_time = start_time;
-        }
+vector<pid_t> find_processes_by_executable_path(
+    vector<string> exec_set, bool include_me, unsigned threads_num) {
+    if (exec_set.empty()) {
+        return {};
     }
 
-    auto proc_uptime = get_file_contents("/proc/uptime");
-    auto current_uptime = to_string(
-        str2num<double>(StringView(proc_uptime).extract_leading(not_fn(is_space<char>)))
-                .value() *
-            ticks_per_second,
-        0);
+    size_t buff_size = prepare_exec_set(exec_set);
+    return find_processes(open_proc_dir(), exec_set, buff_size, include_me, threads_num);
+}
 
-    // If one of the processes has just appeared, wait for a clock tick
-    // to distinguish it from a new process that may appear just after killing
-    // with the same pid
-    if (max_victim_start_time >= proc_uptime) {
-        std::this_thread::sleep_for(1s / ticks_per_second);
+void kill_processes_by_exec(
+    vector<string> exec_set, optional<duration<double>> wait_timeout, bool kill_after_waiting,
+    int terminate_signal, unsigned threads_num) {
+    STACK_UNWINDING_MARK;
+    if (exec_set.empty()) {
+        return;
     }
 
-    // First try terminate_signal
-    for (size_t i = 0; i < victims.size(); ++i) {
-        auto pid = victims[i].first;
-        if (kill(pid, terminate_signal) == 0) {
-            continue;
+    size_t buff_size = prepare_exec_set(exec_set);
+    auto proc_fd = open_proc_dir();
+    // Victims are referred to by pidfds, so a new process that reuses the pid
+    // of a dead victim cannot be signaled. The executable is checked again
+    // after opening the pidfd, as the pid might have been reused before.
+    vector<FileDescriptor> victims;
+    InplaceBuff<PATH_MAX> buff(buff_size);
+    for (pid_t pid : find_processes(proc_fd, exec_set, buff_size, false, threads_num)) {
+        FileDescriptor pidfd(syscalls::pidfd_open(pid, 0));
+        if (not pidfd.is_open()) {
+            if (errno == ESRCH) {
+                continue; // Process already died
+            }
+            THROW("pidfd_open()", errmsg());
         }
-
-        if (errno != ESRCH) {
-            THROW("kill(", pid, ")", errmsg());
+        if (has_executable_in(proc_fd, pid, exec_set, buff)) {
+            victims.emplace_back(std::move(pidfd));
         }
-
-        swap(victims[i--], victims.back());
-        victims.pop_back();
     }
 
-    // Wait for victims to terminate
-    auto wait_start_time = std::chrono::system_clock::now();
-    auto curr_time = wait_start_time;
-    while (curr_time < wait_start_time) {
-        // Remove dead victims
+    auto signal_victims = [&](int sig) {
         for (size_t i = 0; i < victims.size(); ++i) {
-            auto& [pid, start_time] = victims[i];
-            try {
-                auto proc_stat = ProcStatFileContents::get(pid);
-                if (proc_stat.field(START_TIME_FID) == start_time) {
-                    continue; // Still alive
-                }
-            } catch (...) {
-                // Exception means that the process is dead
+            if (syscalls::pidfd_send_signal(victims[i], sig, nullptr, 0) == 0) {
+                continue;
             }
 
-            swap(victims[i--], victims.back());
-            victims.pop_back();
-        }
+            if (errno != ESRCH) {
+                THROW("pidfd_send_signal()", errmsg());
+            }
 
-        if (victims.empty()) {
-            break;
+            std::swap(victims[i--], victims.back());
+            victims.pop_back();
         }
+    };
 
-        curr_time = std::chrono::system_clock::now();
-        auto sleep_interval = 0.04s;
-        if (wait_timeout.has_value()) {
-            auto remaining_wait = *wait_timeout - (curr_time - wait_start_time);
-            if (remaining_wait <= 0s) {
+    // First try terminate_signal
+    signal_victims(terminate_signal);
+
+    // Wait for victims to terminate, a pidfd becomes readable once its process
+    // terminates
+    using std::chrono::steady_clock;
+    optional<steady_clock::time_point> wait_deadline;
+    if (wait_timeout.has_value()) {
+        wait_deadline =
+            steady_clock::now() + std::chrono::ceil<steady_clock::duration>(*wait_timeout);
+    }
+    vector<pollfd> pfds;
+    while (not victims.empty()) {
+        int timeout_ms = -1;
+        if (wait_deadline.has_value()) {
+            auto remaining_wait = *wait_deadline - steady_clock::now();
+            if (remaining_wait <= steady_clock::duration::zero()) {
                 break;
             }
+            timeout_ms = std::min<std::chrono::milliseconds::rep>(
+                std::chrono::ceil<std::chrono::milliseconds>(remaining_wait).count(), INT_MAX);
+        }
 
-            if (remaining_wait < sleep_interval) {
-                sleep_interval = remaining_wait;
+        pfds.clear();
+        for (auto& pidfd : victims) {
+            pfds.push_back({pidfd, POLLIN, 0});
+        }
+        if (poll(pfds.data(), pfds.size(), timeout_ms) == -1) {
+            if (errno == EINTR) {
+                continue;
             }
+            THROW("poll()", errmsg());
         }
 
-        std::this_thread::sleep_for(sleep_interval);
+        // Remove dead victims (backwards, so that swapping does not mix up
+        // victims with pfds)
+        for (size_t i = pfds.size(); i-- > 0;) {
+            if (pfds[i].revents) {
+                std::swap(victims[i], victims.back());
+                victims.pop_back();
+            }
+        }
     }
 
     // Kill remaining victims
     if (kill_after_waiting) {
-        for (auto& [pid, start_time] : victims) {
-            (void)kill(pid, SIGKILL);
-        }
+        signal_victims(SIGKILL);
+    }
+}
+
+int call_in_vfork_like_child(int (*func)(void*), void* arg) noexcept {
+    constexpr size_t child_stack_size = 256 << 10;
+    void* child_stack = mmap(
+        nullptr, child_stack_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (child_stack == MAP_FAILED) {
+        return -1;
+    }
+    CallInDtor child_stack_unmapper = [&] { (void)munmap(child_stack, child_stack_size); };
+
+    pid_t child = [&] {
+        // Signal handlers must not run in the child as it shares memory with us
+        ThreadSignalBlocker sb;
+        return clone(
+            func, static_cast<char*>(child_stack) + child_stack_size,
+            CLONE_VM | CLONE_VFORK | SIGCHLD, arg);
+    }();
+    if (child == -1) {
+        return -1;
+    }
+
+    siginfo_t si;
+    if (syscalls::waitid(P_PID, child, &si, WEXITED, nullptr) == -1) {
+        return -1;
+    }
+    if (si.si_code != CLD_EXITED) {
+        errno = ECHILD;
+        return -1;
     }
+    return si.si_status;
 }
 
 ArchKind detect_architecture(pid_t pid) {
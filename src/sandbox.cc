@@ -3,11 +3,16 @@
 #include "simlib/ctype.hh"
 #include "simlib/defer.hh"
 #include "simlib/humanize.hh"
+#include "simlib/memfd.hh"
+#include "simlib/metrics.hh"
+#include "simlib/proc_status_file.hh"
 #include "simlib/process.hh"
 #include "simlib/string_transform.hh"
 #include "simlib/syscalls.hh"
 #include "simlib/time.hh"
+#include "simlib/tracing.hh"
 
+#include <algorithm>
 #include <climits>
 #include <linux/version.h>
 #include <stdexcept>
@@ -27,6 +32,14 @@ using std::make_unique;
 using std::unique_ptr;
 using std::vector;
 
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static metrics::DurationHistogram spawn_latency{
+    "simlib_sandbox_spawn_latency_seconds",
+    "Time from fork() until the tracee is ready to execute the sandboxed program"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static metrics::Counter trace_stops{
+    "simlib_sandbox_trace_stops_total", "Number of ptrace stops of the sandboxed processes"};
+
 #ifndef SYS_SECCOMP
 #define SYS_SECCOMP 1
 #endif
@@ -267,6 +280,11 @@ inline auto syscall_callback_lambda(Func&& f DEBUG_SANDBOX(, StringView callback
                                                         DEBUG_SANDBOX(, callback_name));
 }
 
+Sandbox::AllowedFile::AllowedFile(int file_fd, OpenAccess acc)
+: path(fd_path(file_fd).to_string())
+, access(acc)
+, fd(file_fd) {}
+
 Sandbox::Sandbox() {
     x86_ctx_ = seccomp_init(SCMP_ACT_TRAP);
     if (not x86_ctx_) {
@@ -376,9 +394,10 @@ Sandbox::Sandbox() {
         return id;
     };
 
-    // execve()
-    seccomp_rule_add_both_ctx(
-        SCMP_ACT_TRACE(add_limiting_callback(1, "execve")), SCMP_SYS(execve), 0);
+    // execve() and execveat() (used by fexecve()) share the limit
+    auto execve_callback_id = add_limiting_callback(1, "execve");
+    seccomp_rule_add_both_ctx(SCMP_ACT_TRACE(execve_callback_id), SCMP_SYS(execve), 0);
+    seccomp_rule_add_both_ctx(SCMP_ACT_TRACE(execve_callback_id), SCMP_SYS(execveat), 0);
 
     // prlimit64() - needed by callback to Sandbox::run_child() to limit the VM
     // size
@@ -429,6 +448,7 @@ Sandbox::Sandbox() {
                 siginfo_t si;
                 syscalls::waitid(
                     P_PID, sandbox_.tracee_pid_, &si, WSTOPPED | WEXITED | WNOWAIT, nullptr);
+                trace_stops.inc();
                 if (si.si_status != (SIGTRAP | 0x80))
                 { // Something other e.g. a signal (ignore)
                     return false; // Allow the signal to get to the tracee
@@ -470,7 +490,7 @@ Sandbox::Sandbox() {
         seccomp_rule_add_both_ctx(
             SCMP_ACT_TRACE(add_callback(
                 [&] {
-                    update_tracee_vm_peak();
+                    update_tracee_peaks();
                     return false;
                 },
                 "exit")),
@@ -479,7 +499,7 @@ Sandbox::Sandbox() {
         seccomp_rule_add_both_ctx(
             SCMP_ACT_TRACE(add_callback(
                 [&] {
-                    update_tracee_vm_peak();
+                    update_tracee_peaks();
                     return false;
                 },
                 "exit_group")),
@@ -544,9 +564,19 @@ Sandbox::Sandbox() {
                     case OpenAccess::RDWR: tmplog(" RDWR"); break;
                 })
 
+                auto matches = [&](const AllowedFile& af) {
+                    if (af.path == path) {
+                        return true;
+                    }
+
+                    constexpr CStringView proc_fd_prefix = "/proc/self/fd/";
+                    return af.fd >= 0 and has_prefix(path, proc_fd_prefix) and
+                        str2num<int>(path.substring(proc_fd_prefix.size())) == af.fd;
+                };
+
                 for (AllowedFile const& af : allowed_files) {
-                    if (af.first == path) {
-                        if (op == af.second) {
+                    if (matches(af)) {
+                        if (op == af.access) {
                             DEBUG_SANDBOX(tmplog(" - ok");)
                             return false; // Allow to open
                         }
@@ -718,24 +748,10 @@ inline void Sandbox::reset_callbacks() noexcept {
 }
 
 uint64_t Sandbox::get_tracee_vm_size() {
-    InplaceBuff<32> buff(32);
-    ssize_t rc = pread(tracee_statm_fd_, buff.data(), buff.size, 0);
-    if (rc <= 0) {
-        THROW("pread()", errmsg());
-    }
-
-    buff.size = rc;
-    if (auto space_pos = StringView(buff).find(' '); space_pos != StringView::npos) {
-        buff.size = space_pos;
-    }
+    auto statm = tracee_sampler_->read_statm();
+    tracee_rss_peak_ = std::max(tracee_rss_peak_, statm.rss);
 
-    // Obtain value
-    auto opt = str2num<uint64_t>(buff);
-    if (not opt) {
-        THROW("Read invalid VmSize from /proc/tracee_pid/statm: \"", buff, '"');
-    }
-
-    uint64_t vm_size = *opt;
+    uint64_t vm_size = statm.vm_size;
     DEBUG_SANDBOX(stdlog(
                       '[', tracee_pid_, "] get_vm_size: -> ", vm_size, " (",
                       humanize_file_size(vm_size * sysconf(_SC_PAGESIZE)), ")");)
@@ -752,11 +768,31 @@ void Sandbox::update_tracee_vm_peak(uint64_t curr_vm_size) {
                       humanize_file_size(tracee_vm_peak_ * sysconf(_SC_PAGESIZE)), ")");)
 }
 
+void Sandbox::update_tracee_peaks() {
+    update_tracee_vm_peak(get_tracee_vm_size());
+
+    // RSS also grows on page faults, which are not traced, but the kernel
+    // keeps the peak RSS since execve()
+    FileDescriptor status_fd = open_proc_status(tracee_pid_);
+    if (not status_fd.is_open()) {
+        THROW("open(/proc/pid/status)", errmsg());
+    }
+    auto field = field_from_proc_status(status_fd, "VmHWM");
+    StringView str = field;
+    auto kib = str2num<uint64_t>(str.extract_leading(is_digit<char>));
+    if (not kib or str != " kB") {
+        THROW("invalid VmHWM in /proc/pid/status: \"", field, '"');
+    }
+    tracee_rss_peak_ = std::max(tracee_rss_peak_, *kib * 1024 / sysconf(_SC_PAGESIZE));
+}
+
 Sandbox::ExitStat Sandbox::run(
     FilePath exec, const std::vector<std::string>& exec_args, const Options& opts,
     const std::vector<AllowedFile>& allowed_files,
     const std::function<void(pid_t)>& do_in_parent_after_fork) {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("Sandbox::run");
+    TRACE_SPAN_NAMED(setup_span, "sandbox setup");
     using std::chrono_literals::operator""ns;
 
     if (opts.real_time_limit.has_value() and opts.real_time_limit.value() <= 0ns) {
@@ -771,9 +807,47 @@ Sandbox::ExitStat Sandbox::run(
         THROW("If set, memory_limit has to be greater than 0");
     }
 
+    std::vector<int> inherited_fds;
+    // Descriptors that replace the inherited ones in the tracee, so that
+    // every file granted by descriptor is accessible only with the granted
+    // access: (reopened file descriptor, inherited file descriptor)
+    std::vector<std::pair<FileDescriptor, int>> reopened_fds;
+    for (const AllowedFile& af : allowed_files) {
+        if (af.fd < 0) {
+            continue;
+        }
+        if (af.fd <= STDERR_FILENO) {
+            THROW("File descriptor of an allowed file has to be greater than stderr");
+        }
+        inherited_fds.emplace_back(af.fd);
+
+        int fd_flags = fcntl(af.fd, F_GETFL);
+        if (fd_flags == -1) {
+            THROW("fcntl(F_GETFL)", errmsg());
+        }
+        int granted_flags = [&] {
+            switch (af.access) {
+            case OpenAccess::NONE: return O_PATH;
+            case OpenAccess::RDONLY: return O_RDONLY;
+            case OpenAccess::WRONLY: return O_WRONLY;
+            case OpenAccess::RDWR: return O_RDWR;
+            }
+            THROW("Invalid access of an allowed file: ", static_cast<int>(af.access));
+        }();
+        if ((fd_flags & (O_ACCMODE | O_PATH)) != granted_flags) {
+            FileDescriptor reopened(
+                concat_tostr("/proc/self/fd/", af.fd), granted_flags | O_CLOEXEC);
+            if (not reopened.is_open()) {
+                THROW("open()", errmsg());
+            }
+            reopened_fds.emplace_back(std::move(reopened), af.fd);
+        }
+    }
+
     // Reset the state
     reset_callbacks();
     tracee_vm_peak_ = 0;
+    tracee_rss_peak_ = 0;
     message_to_set_in_exit_stat_.clear();
     allowed_files_ = &allowed_files;
 
@@ -783,6 +857,7 @@ Sandbox::ExitStat Sandbox::run(
         THROW("pipe()", errmsg());
     }
 
+    auto fork_time = std::chrono::steady_clock::now();
     tracee_pid_ = fork();
     if (tracee_pid_ == -1) {
         THROW("fork()", errmsg());
@@ -794,6 +869,12 @@ Sandbox::ExitStat Sandbox::run(
             send_error_message_and_exit(pfd[1], std::forward<decltype(args)>(args)...);
         };
 
+        for (auto& [reopened_fd, inherited_fd] : reopened_fds) {
+            if (dup3(reopened_fd, inherited_fd, O_CLOEXEC) == -1) {
+                send_error_and_exit(errno, "dup3()");
+            }
+        }
+
         // BUG: Adding seccomp rules using libseccomp calls malloc()/calloc()
         // which under Sanitizers can cause deadlocks (because Sanitizers
         // allocators are not implemented in a fork-safe way) when the sandbox
@@ -939,7 +1020,7 @@ Sandbox::ExitStat Sandbox::run(
         Options run_child_opts = opts;
         run_child_opts.memory_limit = std::nullopt;
 
-        run_child(exec, exec_args, run_child_opts, pfd[1], [=] {
+        run_child(exec, exec_args, run_child_opts, pfd[1], inherited_fds, [=] {
             // Set max core dump size to 0 in order to avoid creating redundant
             // core dumps
             {
@@ -1020,6 +1101,7 @@ Sandbox::ExitStat Sandbox::run(
     if (syscalls::waitid(P_PID, tracee_pid_, &si, WSTOPPED | WEXITED, nullptr) == -1) {
         THROW("waitid()", errmsg());
     }
+    spawn_latency.observe(std::chrono::steady_clock::now() - fork_time);
 
     DEBUG_SANDBOX_VERBOSE_LOG(
         "waitid(): code: ", si.si_code, " status: ", si.si_status, " pid: ", si.si_pid,
@@ -1048,18 +1130,21 @@ Sandbox::ExitStat Sandbox::run(
     {
         THROW("ptrace(PTRACE_SETOPTIONS)", errmsg());
     }
+    TRACE_SPAN_END(setup_span);
 
-    // Open /proc/{tracee_pid_}/statm for tracking vm_peak (vm stands for
-    // virtual memory)
-    tracee_statm_fd_.open(concat("/proc/", tracee_pid_, "/statm"), O_RDONLY | O_CLOEXEC);
-    if (tracee_statm_fd_ == -1) {
-        THROW("open(/proc/{tracee_pid_ = ", tracee_pid_, "}/statm)", errmsg());
-    }
-
-    Defer tracee_statm_fd_guard([&] { (void)tracee_statm_fd_.close(); });
+    // Open /proc/{tracee_pid_}/{statm,stat} for tracking vm_peak (vm stands
+    // for virtual memory) and rss_peak
+    tracee_sampler_.emplace(tracee_pid_);
+    Defer tracee_sampler_guard([&] { tracee_sampler_.reset(); });
+    // Started just after execve()
+    std::optional<PeriodicProcSampler> periodic_sampler;
+    std::vector<ProcSample> profile;
 
     std::chrono::nanoseconds runtime{0};
     std::chrono::nanoseconds cpu_runtime{0};
+    // Read on execve() (if opts.read_schedstat is true)
+    std::optional<ProcSchedStat> schedstat_at_exec;
+    std::optional<ProcSchedStat> schedstat;
 
     // Set up timers
     unique_ptr<Timer> timer;
@@ -1081,9 +1166,22 @@ Sandbox::ExitStat Sandbox::run(
         // Get cpu runtime
         if (cpu_timer) {
             cpu_runtime = cpu_timer->deactivate_and_get_runtime();
+            if (schedstat_at_exec) {
+                auto schedstat_at_exit = read_proc_schedstat(tracee_pid_);
+                if (schedstat_at_exit) {
+                    schedstat = schedstat_at_exit->since(*schedstat_at_exec);
+                }
+            }
         } else { // The child did not execve() or the execve() failed
             cpu_runtime = 0ns;
-            tracee_vm_peak_ = 0; // It might contain the VM size from before execve()
+            // They might contain the memory usage from before execve()
+            tracee_vm_peak_ = 0;
+            tracee_rss_peak_ = 0;
+        }
+        // The tracee has to be sampled before it is waited, as its pid may be
+        // reused
+        if (periodic_sampler) {
+            profile = periodic_sampler->stop();
         }
 
         kill_and_wait_tracee_guard.cancel(); // Tracee has died
@@ -1103,6 +1201,7 @@ Sandbox::ExitStat Sandbox::run(
             (void)ptrace(PTRACE_CONT, tracee_pid_, 0, 0);
             // Waiting for events
             syscalls::waitid(P_PID, tracee_pid_, &si, WSTOPPED | WEXITED | WNOWAIT, nullptr);
+            trace_stops.inc();
 
             DEBUG_SANDBOX_VERBOSE_LOG(
                 "waitid(): code: ", si.si_code, " status: ", si.si_status, " pid: ", si.si_pid,
@@ -1148,7 +1247,7 @@ Sandbox::ExitStat Sandbox::run(
                         // The tracee will die, we have to update the vm_peak,
                         // as it will not be recoverable later (all this
                         // because stack segment grows without any syscall)
-                        update_tracee_vm_peak();
+                        update_tracee_peaks();
 
                         kill(-tracee_pid_, SIGKILL);
                         continue; // This is the SIGSYS from seccomp, others
@@ -1157,7 +1256,11 @@ Sandbox::ExitStat Sandbox::run(
                 }
 
                 if (si.si_status == (SIGTRAP | (PTRACE_EVENT_EXEC << 8))) {
+                    tracee_rss_peak_ = 0;
                     tracee_vm_peak_ = get_tracee_vm_size();
+                    if (opts.sampling_interval) {
+                        periodic_sampler.emplace(tracee_pid_, *opts.sampling_interval);
+                    }
                     DEBUG_SANDBOX_VERBOSE_LOG("TRAPPED (exec())");
                     // Fire timers. SIGSTOP is used because it cannot be blocked
                     // and we can intercept it via ptrace(), where we will check
@@ -1175,6 +1278,9 @@ Sandbox::ExitStat Sandbox::run(
                     cpu_timer = make_unique<Timer>(
                         tracee_pid_, opts.cpu_time_limit.value_or(0ns), tracee_cpu_clock_id,
                         SIGSTOP);
+                    if (opts.read_schedstat) {
+                        schedstat_at_exec = read_proc_schedstat(tracee_pid_);
+                    }
 
                     continue; // Nothing more to do for the exec() event
                 }
@@ -1192,7 +1298,7 @@ Sandbox::ExitStat Sandbox::run(
                         // The tracee will die, we have to update the vm_peak,
                         // as it will not be recoverable later (all this
                         // because stack segment grows without any syscall)
-                        update_tracee_vm_peak();
+                        update_tracee_peaks();
 
                         kill(-tracee_pid_, SIGKILL);
                     }
@@ -1211,7 +1317,7 @@ Sandbox::ExitStat Sandbox::run(
                     // Tracee will die, we have to update the vm_peak, as it
                     // will be unrecoverable later (all this because stack
                     // segment grows without any syscall)
-                    update_tracee_vm_peak();
+                    update_tracee_peaks();
 
                     kill(-tracee_pid_, SIGKILL);
                     continue;
@@ -1221,7 +1327,7 @@ Sandbox::ExitStat Sandbox::run(
                 // If the tracee is about to die, we have to update the
                 // vm_peak, as it will not be recoverable later (all this
                 // because stack segment grows without any syscall)
-                update_tracee_vm_peak();
+                update_tracee_peaks();
                 // Deliver intercepted signal to tracee
                 if (ptrace(PTRACE_CONT, tracee_pid_, 0, si.si_status)) {
                     DEBUG_SANDBOX(stdlog('[', tracee_pid_, "] ptrace(PTRACE_CONT)", errmsg()));
@@ -1288,22 +1394,20 @@ Sandbox::ExitStat Sandbox::run(
     }
 
 tracee_died:
+    ExitStat es(
+        runtime, cpu_runtime, si.si_code, si.si_status, ru,
+        tracee_vm_peak_ * sysconf(_SC_PAGESIZE));
+    es.rss_peak = tracee_rss_peak_ * sysconf(_SC_PAGESIZE);
+    set_profile(es, std::move(profile));
+    es.schedstat = schedstat;
+
     // Message was set
     if (not message_to_set_in_exit_stat_.empty()) {
-        return ExitStat(
-            runtime, cpu_runtime, si.si_code, si.si_status, ru,
-            tracee_vm_peak_ * sysconf(_SC_PAGESIZE), message_to_set_in_exit_stat_);
+        es.message = message_to_set_in_exit_stat_;
+    } else if (si.si_code != CLD_EXITED or si.si_status != 0) {
+        // Excited abnormally - probably killed by some signal
+        es.message = receive_error_message(si, pfd[0]);
     }
-
-    // Excited abnormally - probably killed by some signal
-    if (si.si_code != CLD_EXITED or si.si_status != 0) {
-        return ExitStat(
-            runtime, cpu_runtime, si.si_code, si.si_status, ru,
-            tracee_vm_peak_ * sysconf(_SC_PAGESIZE), receive_error_message(si, pfd[0]));
-    }
-
-    // Exited normally (maybe with some code != 0)
-    return ExitStat(
-        runtime, cpu_runtime, si.si_code, si.si_status, ru,
-        tracee_vm_peak_ * sysconf(_SC_PAGESIZE));
+    // Otherwise exited normally (maybe with some code != 0)
+    return es;
 }
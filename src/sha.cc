@@ -1,30 +1,62 @@
 #include "simlib/sha.hh"
 #include "simlib/string_transform.hh"
 
+#include <algorithm>
+
 extern "C" {
 #include <3rdparty/sha3.c> // NOLINT(bugprone-suspicious-include)
 }
 
-InplaceBuff<56> sha3_224(StringView str) {
-    unsigned char out[28];
-    FIPS202_SHA3_224(reinterpret_cast<const unsigned char*>(str.data()), str.size(), out);
-    return to_hex<56>({reinterpret_cast<const char*>(out), 28});
-}
+namespace detail {
 
-InplaceBuff<64> sha3_256(StringView str) {
-    unsigned char out[32];
-    FIPS202_SHA3_256(reinterpret_cast<const unsigned char*>(str.data()), str.size(), out);
-    return to_hex<64>({reinterpret_cast<const char*>(out), 32});
+size_t sha3_absorb(unsigned char* state, size_t rate, size_t pos, StringView str) noexcept {
+    auto data = reinterpret_cast<const unsigned char*>(str.data());
+    size_t len = str.size();
+    while (len > 0) {
+        size_t n = std::min(len, rate - pos);
+        for (size_t i = 0; i < n; ++i) {
+            state[pos + i] ^= data[i];
+        }
+        pos += n;
+        data += n;
+        len -= n;
+        if (pos == rate) {
+            KeccakF1600_StatePermute(state);
+            pos = 0;
+        }
+    }
+    return pos;
 }
 
-InplaceBuff<96> sha3_384(StringView str) {
-    unsigned char out[48];
-    FIPS202_SHA3_384(reinterpret_cast<const unsigned char*>(str.data()), str.size(), out);
-    return to_hex<96>({reinterpret_cast<const char*>(out), 48});
+void sha3_finalize(
+    unsigned char* state, size_t rate, size_t pos, unsigned char* out,
+    size_t out_len) noexcept {
+    // Domain separation bits (01) followed by the first padding bit, then the
+    // last padding bit at the end of the block
+    state[pos] ^= 0x06;
+    state[rate - 1] ^= 0x80;
+    KeccakF1600_StatePermute(state);
+    std::copy(state, state + out_len, out);
 }
 
-InplaceBuff<128> sha3_512(StringView str) {
-    unsigned char out[64];
-    FIPS202_SHA3_512(reinterpret_cast<const unsigned char*>(str.data()), str.size(), out);
-    return to_hex<128>({reinterpret_cast<const char*>(out), 64});
+} // namespace detail
+
+namespace {
+
+template <class Hasher, size_t N = Hasher::digest_size * 2>
+InplaceBuff<N> hex_hash(StringView str) {
+    Hasher hasher;
+    hasher.update(str);
+    auto digest = hasher.digest();
+    return to_hex<N>({reinterpret_cast<const char*>(digest.data()), digest.size()});
 }
+
+} // namespace
+
+InplaceBuff<56> sha3_224(StringView str) { return hex_hash<Sha3_224>(str); }
+
+InplaceBuff<64> sha3_256(StringView str) { return hex_hash<Sha3_256>(str); }
+
+InplaceBuff<96> sha3_384(StringView str) { return hex_hash<Sha3_384>(str); }
+
+InplaceBuff<128> sha3_512(StringView str) { return hex_hash<Sha3_512>(str); }
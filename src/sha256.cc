@@ -0,0 +1,220 @@
+#include "simlib/sha.hh"
+#include "simlib/string_transform.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SIMLIB_SHA256_X86 1
+#endif
+
+namespace {
+
+constexpr std::array<uint32_t, 64> K = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2,
+};
+
+constexpr uint32_t rotr(uint32_t x, int n) noexcept { return (x >> n) | (x << (32 - n)); }
+
+uint32_t load_be32(const unsigned char* p) noexcept {
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+}
+
+void compress_generic(uint32_t* state, const unsigned char* data, size_t blocks) noexcept {
+    for (; blocks > 0; --blocks, data += 64) {
+        std::array<uint32_t, 64> w; // NOLINT(cppcoreguidelines-pro-type-member-init)
+        for (int i = 0; i < 16; ++i) {
+            w[i] = load_be32(data + i * 4);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + K[i] + w[i];
+            uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if SIMLIB_SHA256_X86
+
+bool cpu_has_sha_extensions() noexcept {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (not __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool has_ssse3 = ecx & bit_SSSE3;
+    bool has_sse41 = ecx & bit_SSE4_1;
+    if (not __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool has_sha = ebx & bit_SHA;
+    return has_ssse3 and has_sse41 and has_sha;
+}
+
+// Based on the Intel SHA extensions reference code
+__attribute__((target("sha,sse4.1"))) void
+compress_sha_ni(uint32_t* state, const unsigned char* data, size_t blocks) noexcept {
+    const __m128i byte_swap_mask =
+        _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // Rearrange the state from ABCD EFGH to ABEF CDGH
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    for (; blocks > 0; --blocks, data += 64) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+        __m128i m[4]; // NOLINT(modernize-avoid-c-arrays)
+        // Each iteration does 4 rounds, m[i % 4] holds the message words
+        // 4i, ..., 4i + 3
+        for (int i = 0; i < 16; ++i) {
+            __m128i& curr = m[i % 4];
+            if (i < 4) {
+                curr = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+                    byte_swap_mask);
+            }
+            __m128i msg = _mm_add_epi32(
+                curr, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K.data() + i * 4)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (i >= 3 and i < 15) {
+                // Finish computing the next message words
+                __m128i& next = m[(i + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(curr, m[(i + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, curr);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (i >= 1 and i < 13) {
+                // Start computing the message words 4(i + 3), ..., 4(i + 3) + 3
+                __m128i& prev = m[(i + 3) % 4];
+                prev = _mm_sha256msg1_epu32(prev, curr);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    // Rearrange the state back to ABCD EFGH
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+#endif // SIMLIB_SHA256_X86
+
+void compress(uint32_t* state, const unsigned char* data, size_t blocks) noexcept {
+#if SIMLIB_SHA256_X86
+    static const bool use_sha_ni = cpu_has_sha_extensions();
+    if (use_sha_ni) {
+        return compress_sha_ni(state, data, blocks);
+    }
+#endif
+    compress_generic(state, data, blocks);
+}
+
+} // namespace
+
+Sha256::Sha256() noexcept
+: state_{
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab,
+      0x5be0cd19} {}
+
+void Sha256::update(StringView str) noexcept {
+    auto data = reinterpret_cast<const unsigned char*>(str.data());
+    size_t len = str.size();
+    total_len_ += len;
+
+    if (buff_len_ > 0) {
+        size_t n = std::min(len, buff_.size() - buff_len_);
+        std::memcpy(buff_.data() + buff_len_, data, n);
+        buff_len_ += n;
+        data += n;
+        len -= n;
+        if (buff_len_ < buff_.size()) {
+            return;
+        }
+        compress(state_.data(), buff_.data(), 1);
+        buff_len_ = 0;
+    }
+
+    if (len >= 64) {
+        compress(state_.data(), data, len / 64);
+        data += len / 64 * 64;
+        len %= 64;
+    }
+
+    std::memcpy(buff_.data(), data, len);
+    buff_len_ = len;
+}
+
+Sha256::Digest Sha256::digest() noexcept {
+    uint64_t bit_len = total_len_ * 8;
+    // Padding: 0x80, zeros and the 64-bit big-endian length of the data
+    std::array<unsigned char, 72> padding{};
+    padding[0] = 0x80;
+    size_t padding_len = (buff_len_ < 56 ? 56 - buff_len_ : 120 - buff_len_);
+    for (int i = 0; i < 8; ++i) {
+        padding[padding_len + i] = static_cast<unsigned char>(bit_len >> (56 - i * 8));
+    }
+    update({reinterpret_cast<const char*>(padding.data()), padding_len + 8});
+
+    Digest res;
+    for (size_t i = 0; i < state_.size(); ++i) {
+        res[i * 4] = static_cast<unsigned char>(state_[i] >> 24);
+        res[i * 4 + 1] = static_cast<unsigned char>(state_[i] >> 16);
+        res[i * 4 + 2] = static_cast<unsigned char>(state_[i] >> 8);
+        res[i * 4 + 3] = static_cast<unsigned char>(state_[i]);
+    }
+    return res;
+}
+
+InplaceBuff<64> sha256(StringView str) {
+    auto digest = sha256_digest(str);
+    return to_hex<64>({reinterpret_cast<const char*>(digest.data()), digest.size()});
+}
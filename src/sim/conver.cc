@@ -509,24 +509,22 @@ Conver::ConstructionResult Conver::construct_simfile(const Options& opts, bool b
     struct TestsGroup {
         std::optional<int64_t> score;
         // test name => test props
-        std::multimap<StringView, TestProperties, Simfile::TestNameComparator> tests;
+        std::multimap<
+            Simfile::TestNameComparator::Key, TestProperties, Simfile::TestNameComparator>
+            tests;
     };
 
     std::map<StringView, TestsGroup, StrNumCompare> tests_groups; // group name => test group
     // Fill tests_groups
     for (auto const& [test_name, test] : tests) {
-        auto sr = Simfile::TestNameComparator::split(test_name);
-        if (sr.gid.empty()) {
+        auto key = Simfile::TestNameComparator::key(test_name);
+        if (key.split.gid.empty()) {
             continue; // Ignore the tests with no group id
         }
 
-        if (sr.tid == "ocen") {
-            sr.gid = "0";
-        }
-
-        auto [it, _] = tests_groups.try_emplace(sr.gid);
+        auto [it, _] = tests_groups.try_emplace(key.ocen ? "0" : key.split.gid);
         auto& group = it->second;
-        group.tests.emplace(test_name, test);
+        group.tests.emplace(key, test);
     }
 
     // Load scoring
@@ -600,11 +598,12 @@ Conver::ConstructionResult Conver::construct_simfile(const Options& opts, bool b
     for (auto const& [_, group] : tests_groups) {
         Simfile::TestGroup tg;
         tg.score = group.score.value();
-        for (auto const& [test_name, test] : group.tests) {
+        for (auto const& [test_key, test] : group.tests) {
             run_main_solution |= not test.time_limit.has_value();
 
             Simfile::Test t(
-                test_name.to_string(), test.time_limit.value_or(std::chrono::nanoseconds(0)),
+                test_key.name.to_string(),
+                test.time_limit.value_or(std::chrono::nanoseconds(0)),
                 test.memory_limit.value());
             t.in = test.in.value().to_string();
             if (sf.interactive) {
@@ -1,28 +1,50 @@
 #include "simlib/sim/judge_worker.hh"
+#include "simlib/concurrent/semaphore.hh"
+#include "simlib/defer.hh"
 #include "simlib/enum_val.hh"
 #include "simlib/file_info.hh"
 #include "simlib/libzip.hh"
+#include "simlib/metrics.hh"
+#include "simlib/pipe.hh"
+#include "simlib/pipe_relay.hh"
 #include "simlib/sim/checker.hh"
 #include "simlib/sim/problem_package.hh"
 #include "simlib/simple_parser.hh"
+#include "simlib/tracing.hh"
 #include "simlib/unlinked_temporary_file.hh"
 #include "src/sim/default_checker_dump.h"
 
+#include <algorithm>
 #include <atomic>
+#include <climits>
 #include <cmath>
 #include <cstdio>
+#include <deque>
+#include <exception>
 #include <fcntl.h>
-#include <future>
+#include <numeric>
 #include <thread>
 #include <unistd.h>
 
-using std::promise;
 using std::string;
 using std::thread;
 using std::vector;
 
 namespace sim {
 
+namespace {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::DurationHistogram compile_duration{
+    "simlib_judge_compile_duration_seconds", "Real time of compiling checkers and solutions"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::DurationHistogram checker_duration{
+    "simlib_judge_checker_duration_seconds", "Real time of checker runs"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Counter judged_tests{"simlib_judge_tests_total", "Number of judged tests"};
+
+} // namespace
+
 class DirPackageLoader : public PackageLoader {
     InplaceBuff<PATH_MAX> pkg_root_;
 
@@ -54,6 +76,16 @@ public:
     std::string load_as_str(FilePath path) override {
         return get_file_contents(concat(pkg_root_, path));
     }
+
+    FileDescriptor load_as_fd(FilePath path, CStringView /*hint_name*/) override {
+        auto file_path = concat(pkg_root_, path);
+        FileDescriptor fd(file_path, O_RDONLY | O_CLOEXEC);
+        if (not fd.is_open()) {
+            THROW("Failed to open file `", file_path, '`', errmsg());
+        }
+
+        return fd;
+    }
 };
 
 class ZipPackageLoader : public PackageLoader {
@@ -70,19 +102,38 @@ public:
     , pkg_main_dir_(sim::zip_package_main_dir(zip_)) {}
 
     std::string load_into_dest_file(FilePath path, FilePath dest) override {
+        TRACE_SPAN("zip extraction");
         zip_.extract_to_file(zip_.get_index(as_pkg_path(path)), dest, S_0600);
         return dest.to_str();
     }
 
     std::string load_as_file(FilePath path, FilePath hint_name) override {
+        TRACE_SPAN("zip extraction");
         auto dest = concat_tostr(tmp_dir_.path(), "from_zip_pgk:", hint_name);
         zip_.extract_to_file(zip_.get_index(as_pkg_path(path)), dest, S_0600);
         return dest;
     }
 
     std::string load_as_str(FilePath path) override {
+        TRACE_SPAN("zip extraction");
         return zip_.extract_to_str(zip_.get_index(as_pkg_path(path)));
     }
+
+    FileDescriptor load_as_fd(FilePath path, CStringView hint_name) override {
+        TRACE_SPAN("zip extraction");
+        FileDescriptor memfd = open_memfd(hint_name);
+        if (not memfd.is_open()) {
+            THROW("memfd_create()", errmsg());
+        }
+
+        zip_.extract_to_fd(zip_.get_index(as_pkg_path(path)), memfd);
+        FileDescriptor fd = seal_memfd(memfd);
+        if (not fd.is_open()) {
+            THROW("seal_memfd()", errmsg());
+        }
+
+        return fd;
+    }
 };
 
 inline static vector<string>
@@ -122,8 +173,10 @@ compile_command(SolutionLanguage lang, const StringView& source, StringView exec
 int JudgeWorker::compile_impl(
     FilePath source, SolutionLanguage lang, std::optional<std::chrono::nanoseconds> time_limit,
     string* c_errors, size_t c_errors_max_len, const string& proot_path,
-    StringView compilation_source_basename, StringView exec_dest_filename) {
+    StringView compilation_source_basename, CStringView exec_dest_filename,
+    FileDescriptor& exec_dest_memfd) {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("compile");
 
     auto compilation_dir = concat<PATH_MAX>(tmp_dir.path(), "compilation/");
     if (remove_r(compilation_dir) and errno != ENOENT) {
@@ -151,21 +204,62 @@ int JudgeWorker::compile_impl(
         THROW("copy()", errmsg());
     }
 
+    auto compile_start = std::chrono::steady_clock::now();
     int rc = compile(
         compilation_dir, compile_command(lang, src_filename, exec_dest_filename), time_limit,
         c_errors, c_errors_max_len, proot_path);
+    compile_duration.observe(std::chrono::steady_clock::now() - compile_start);
 
-    if (rc == 0 and
-        move(
-            concat<PATH_MAX>(compilation_dir, exec_dest_filename),
-            concat<PATH_MAX>(tmp_dir.path(), exec_dest_filename)))
-    {
-        THROW("move()", errmsg());
+    if (rc != 0) {
+        return rc;
+    }
+
+    auto compiled_program = concat<PATH_MAX>(compilation_dir, exec_dest_filename);
+    if (use_memfds) {
+        exec_dest_memfd = copy_to_sealed_memfd(compiled_program, exec_dest_filename);
+        if (not exec_dest_memfd.is_open()) {
+            THROW("copy_to_sealed_memfd()", errmsg());
+        }
+    } else {
+        (void)exec_dest_memfd.close();
+        if (move(compiled_program, concat<PATH_MAX>(tmp_dir.path(), exec_dest_filename))) {
+            THROW("move()", errmsg());
+        }
     }
 
     return rc;
 }
 
+void JudgeWorker::load_compiled_program(
+    FilePath compiled_program, CStringView filename, FileDescriptor& memfd) {
+    STACK_UNWINDING_MARK;
+
+    if (use_memfds) {
+        memfd = copy_to_sealed_memfd(compiled_program, filename);
+        if (not memfd.is_open()) {
+            THROW("copy_to_sealed_memfd()", errmsg());
+        }
+        return;
+    }
+
+    (void)memfd.close();
+    thread_fork_safe_copy(
+        compiled_program, concat<PATH_MAX>(tmp_dir.path(), filename), S_0755);
+}
+
+void JudgeWorker::save_compiled_program(
+    FilePath destination, int (*copy_fn)(FilePath, FilePath, mode_t), CStringView filename,
+    int memfd) const {
+    STACK_UNWINDING_MARK;
+
+    auto compiled_program =
+        (memfd < 0 ? concat<PATH_MAX>(tmp_dir.path(), filename)
+                   : concat<PATH_MAX>(fd_path(memfd)));
+    if (copy_fn(compiled_program, destination, S_0755)) {
+        THROW("copy()", errmsg());
+    }
+}
+
 int JudgeWorker::compile_checker(
     std::optional<std::chrono::nanoseconds> time_limit, std::string* c_errors,
     size_t c_errors_max_len, const std::string& proot_path) {
@@ -187,11 +281,12 @@ int JudgeWorker::compile_checker(
 
     return compile_impl(
         checker_path_and_lang.first, checker_path_and_lang.second, time_limit, c_errors,
-        c_errors_max_len, proot_path, "checker", CHECKER_FILENAME);
+        c_errors_max_len, proot_path, "checker", CHECKER_FILENAME, checker_memfd);
 }
 
 void JudgeWorker::load_package(FilePath package_path, std::optional<string> simfile) {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("load package");
 
     if (is_directory(package_path)) {
         package_loader = std::make_unique<DirPackageLoader>(package_path);
@@ -216,6 +311,13 @@ cpu_time_limit_to_real_time_limit(std::chrono::nanoseconds cpu_tl) noexcept {
     return cpu_tl * 3 / 2 + std::chrono::milliseconds(500);
 }
 
+// Real runtime of the solution without the time it spent waiting for a CPU, if
+// the latter is known
+static inline std::chrono::nanoseconds
+solution_real_runtime(const Sandbox::ExitStat& es) noexcept {
+    return es.schedstat ? es.runtime - es.schedstat->run_queue_wait_time : es.runtime;
+}
+
 Sandbox::ExitStat JudgeWorker::run_solution(
     FilePath input_file, FilePath output_file,
     std::optional<std::chrono::nanoseconds> time_limit,
@@ -251,11 +353,14 @@ Sandbox::ExitStat JudgeWorker::run_solution(
         real_time_limit = cpu_time_limit_to_real_time_limit(time_limit.value());
     }
 
+    Sandbox::Options opts = {
+        test_in, solution_stdout, -1, real_time_limit, memory_limit, time_limit};
+    opts.exec_fd = solution_memfd;
+    opts.read_schedstat = read_schedstat;
+
     // Run solution on the test
-    Sandbox::ExitStat es = sandbox.run(
-        solution_path, {},
-        {test_in, solution_stdout, -1, real_time_limit, memory_limit,
-         time_limit}); // Allow exceptions to fly upper
+    Sandbox::ExitStat es =
+        sandbox.run(solution_path, {}, opts); // Allow exceptions to fly upper
 
     return es;
 }
@@ -360,6 +465,7 @@ JudgeReport JudgeWorker::process_tests(
     using std::chrono_literals::operator""s;
 
     JudgeReport report;
+    report.groups.reserve(sf.tgroups.size());
     judge_log.begin(final);
 
     // First round - judge as little as possible to compute total score
@@ -375,6 +481,7 @@ JudgeReport JudgeWorker::process_tests(
 
         report.groups.emplace_back();
         auto& report_group = report.groups.back();
+        report_group.tests.reserve(group.tests.size());
 
         double group_score_ratio = 1.0;
         auto calc_group_score = [&] {
@@ -464,151 +571,250 @@ JudgeReport JudgeWorker::judge_interactive(
     const std::optional<std::function<void(const JudgeReport&)>>& partial_report_callback)
     const {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("judge interactive");
 
-    struct NextJob {
+    // The checker has to be supervised by a separate thread, as a sandboxed
+    // process is traced by the thread that spawned it. The thread and the
+    // handoffs below are reused by all tests, so passing a test to the checker
+    // supervisor and getting the checker's status back does not allocate.
+    struct CheckerJob {
         FileDescriptor checker_stdin;
         FileDescriptor checker_stdout;
-        const string& test_in_path;
+        const string* test_in_path;
+        int test_in_fd; // -1 if the test is not passed by file descriptor
         std::chrono::nanoseconds solution_real_time_limit;
     };
 
-    std::promise<void> checker_supervisor_ready; // Used to pass exceptions
-    std::promise<std::optional<NextJob>> next_job_promise;
-    std::promise<CheckerStatus> checker_status_promise;
+    std::optional<CheckerJob> checker_job; // std::nullopt means no more jobs
+    concurrent::Semaphore checker_job_posted{0};
+    // Exactly one of them is set when checker_status_posted is posted
+    std::optional<CheckerStatus> checker_status;
+    std::exception_ptr checker_exception;
+    concurrent::Semaphore checker_status_posted{0};
+    bool checker_job_pending = false;
+
     std::atomic_bool checker_finished{false};
-    std::promise<std::optional<pid_t>> solution_pid_promise;
+    // The solution is killed after the checker exits with a verdict other than
+    // OK, by the thread that learns about the second of these two events
+    std::atomic<pid_t> solution_pid{0};
+    std::atomic_bool kill_solution{false};
     Sandbox::ExitStat ces;
 
-    auto checker_supervisor = [&] {
-        try {
-            STACK_UNWINDING_MARK;
+    // Setup
+    FileDescriptor checker_stderr_file(open_unlinked_tmp_file());
+    if (not checker_stderr_file.is_open()) { // Needs to be done this way because
+                                             // constructing exception may throw
+        THROW("Cannot create checker stderr file descriptor");
+    }
+    Sandbox checker_sandbox;
+    const auto checker_path = concat_tostr(tmp_dir.path(), CHECKER_FILENAME);
+    // Reused by all jobs, so that they keep their capacity
+    vector<string> checker_args = {checker_path, ""};
+    vector<Sandbox::AllowedFile> checker_allowed_files(1, {"", OpenAccess::RDONLY});
 
-            // Setup
-            FileDescriptor output(open_unlinked_tmp_file());
-            if (not output.is_open()) { // Needs to be done this way because
-                                        // constructing exception may throw
-                THROW("Cannot create checker output file descriptor");
-            }
+    auto run_checker = [&](CheckerJob& job) {
+        STACK_UNWINDING_MARK;
 
-            Sandbox sandbox;
-            const auto checker_path = concat_tostr(tmp_dir.path(), CHECKER_FILENAME);
+        auto rtl = checker_time_limit;
+        if (rtl.has_value()) {
+            rtl.value() += job.solution_real_time_limit;
+        }
 
-            checker_supervisor_ready.set_value();
-            for (;;) {
-                STACK_UNWINDING_MARK;
+        // Checker parameters
+        Sandbox::Options opts = {
+            job.checker_stdin, job.checker_stdout,
+            checker_stderr_file, // STDERR
+            rtl, checker_memory_limit};
+        opts.exec_fd = checker_memfd;
 
-                auto job_opt = next_job_promise.get_future().get();
-                next_job_promise = {}; // reset promise
-                if (not job_opt.has_value()) {
-                    return;
-                }
+        checker_args[1] = *job.test_in_path;
+        // The test_in_path is fd_path(test_in_fd) if test_in_fd is valid
+        checker_allowed_files[0].path = *job.test_in_path;
+        checker_allowed_files[0].fd = job.test_in_fd;
 
-                auto& job = job_opt.value();
+        // Prepare checker fds
+        (void)ftruncate(checker_stderr_file, 0);
+        (void)lseek(checker_stderr_file, 0, SEEK_SET);
 
-                STACK_UNWINDING_MARK;
+        // Run checker
+        TRACE_SPAN_NAMED(checker_span, "run checker");
+        ces = checker_sandbox.run(checker_path, checker_args, opts, checker_allowed_files);
+        TRACE_SPAN_END(checker_span);
+        checker_duration.observe(ces.runtime);
+
+        checker_finished.store(true, std::memory_order_seq_cst);
+        (void)job.checker_stdin.close(); // This may kill solution with SIGPIPE
+        (void)job.checker_stdout.close(); // This allows solution to continue if it
+                                          // waits on read()
+
+        CheckerStatus cs = exit_to_checker_status(ces, opts, checker_stderr_file, "stderr");
+        // Since checker exited, killing solution will protect from unnecessary TLE
+        if (cs.status != CheckerStatus::OK or cs.ratio < 1) {
+            kill_solution.store(true, std::memory_order_seq_cst);
+            pid_t pid = solution_pid.load(std::memory_order_seq_cst);
+            if (pid > 0) {
+                kill(pid, SIGKILL);
+            }
+        }
+        return cs;
+    };
 
-                auto rtl = checker_time_limit;
-                if (rtl.has_value()) {
-                    rtl.value() += job.solution_real_time_limit;
-                }
+    auto checker_supervisor = [&] {
+        for (;;) {
+            checker_job_posted.wait();
+            if (not checker_job.has_value()) {
+                return;
+            }
 
-                // Checker parameters
-                Sandbox::Options opts = {
-                    job.checker_stdin, job.checker_stdout,
-                    output, // STDERR
-                    rtl, checker_memory_limit};
-
-                // Prepare checker fds
-                (void)ftruncate(output, 0);
-                (void)lseek(output, 0, SEEK_SET);
-
-                checker_finished.store(false, std::memory_order_seq_cst);
-
-                checker_supervisor_ready.set_value(); // Notify solution supervisor that we are
-                                                      // ready to run checker
-
-                try {
-                    // Run checker
-                    ces = sandbox.run(
-                        checker_path, {checker_path, job.test_in_path}, opts,
-                        {{job.test_in_path, OpenAccess::RDONLY}});
-
-                    checker_finished.store(true, std::memory_order_seq_cst);
-                    (void)job.checker_stdin.close(); // This may kill solution with SIGPIPE
-                    (void)job.checker_stdout.close(); // This allows solution to continue if it
-                                                      // waits on read()
-
-                    CheckerStatus cs = exit_to_checker_status(ces, opts, output, "stderr");
-                    // Since checker exited, killing solution will protect from
-                    // unnecessary TLE
-                    auto sol_pid_opt = solution_pid_promise.get_future().get();
-                    solution_pid_promise = {}; // reset promise
-                    if (sol_pid_opt and (cs.status != CheckerStatus::OK or cs.ratio < 1)) {
-                        kill(sol_pid_opt.value(), SIGKILL);
-                    }
+            try {
+                checker_status = run_checker(checker_job.value());
+            } catch (...) {
+                ERRLOG_CATCH();
+                checker_exception = std::current_exception();
+            }
+            checker_status_posted.post();
+        }
+    };
 
-                    checker_status_promise.set_value(std::move(cs));
+    auto wait_for_checker_status = [&] {
+        checker_status_posted.wait();
+        checker_job_pending = false;
+        checker_job.reset();
+        if (checker_exception) {
+            std::rethrow_exception(std::exchange(checker_exception, nullptr));
+        }
+        CheckerStatus cs = std::move(checker_status).value();
+        checker_status.reset();
+        return cs;
+    };
 
-                } catch (...) {
-                    ERRLOG_CATCH();
-                    checker_status_promise.set_exception(std::current_exception());
-                }
+    // If the transcript is recorded, the solution and the checker write to the
+    // pipes read by the relay, which splices the data to the pipes they read
+    // from. The relay runs in a thread reused by all tests, like the checker
+    // supervisor.
+    std::thread relay_thread;
+    vector<PipeRelayChannel> relay_channels;
+    bool relay_stop = false;
+    string relay_transcript;
+    std::exception_ptr relay_exception;
+    concurrent::Semaphore relay_job_posted{0};
+    concurrent::Semaphore relay_done{0};
+    bool relay_job_pending = false;
+
+    auto relay = [&] {
+        for (;;) {
+            relay_job_posted.wait();
+            if (relay_stop) {
+                return;
             }
-        } catch (...) {
-            ERRLOG_CATCH();
-            checker_supervisor_ready.set_exception(std::current_exception());
+
+            try {
+                relay_transcript = relay_pipes(relay_channels, interactive_transcript_max_len);
+            } catch (...) {
+                ERRLOG_CATCH();
+                relay_exception = std::current_exception();
+                // Closing the pipes lets the solution and the checker end
+                relay_channels.clear();
+            }
+            relay_done.post();
+        }
+    };
+
+    auto wait_for_relay = [&] {
+        relay_done.wait();
+        relay_job_pending = false;
+        if (relay_exception) {
+            std::rethrow_exception(std::exchange(relay_exception, nullptr));
         }
+        return std::move(relay_transcript);
+    };
+
+    auto make_pipe = [&] {
+        auto p = pipe2(O_CLOEXEC);
+        if (not p) {
+            THROW("pipe2()", errmsg());
+        }
+        if (interactive_pipe_size.has_value() and
+            fcntl(p->writable, F_SETPIPE_SZ, static_cast<int>(*interactive_pipe_size)) == -1)
+        {
+            THROW("fcntl(F_SETPIPE_SZ)", errmsg());
+        }
+        return std::move(*p);
     };
 
     Sandbox sandbox;
     const auto solution_path = concat_tostr(tmp_dir.path(), SOLUTION_FILENAME);
+    // The checker uses them until its status is received, which on exception
+    // happens after the test is abandoned, so they outlive all the tests
+    FileDescriptor test_in;
+    string test_in_path;
 
     auto judge_on_test = [&](const sim::Simfile::Test& test, double& group_score_ratio) {
         STACK_UNWINDING_MARK;
+        TRACE_SPAN("judge test");
+        judged_tests.inc();
         // Prepare pipes
-        int pfds[2];
-        if (pipe2(pfds, O_CLOEXEC)) {
-            THROW("pipe2()", errmsg());
+        auto solution_to_checker = make_pipe();
+        FileDescriptor checker_input = std::move(solution_to_checker.readable);
+        FileDescriptor solution_output = std::move(solution_to_checker.writable);
+
+        auto checker_to_solution = make_pipe();
+        FileDescriptor solution_input = std::move(checker_to_solution.readable);
+        FileDescriptor checker_output = std::move(checker_to_solution.writable);
+
+        if (relay_thread.joinable()) {
+            auto relayed_to_checker = make_pipe();
+            auto relayed_to_solution = make_pipe();
+            relay_channels.clear();
+            relay_channels.push_back(
+                {std::move(checker_input), std::move(relayed_to_checker.writable),
+                 "solution"});
+            relay_channels.push_back(
+                {std::move(solution_input), std::move(relayed_to_solution.writable),
+                 "checker"});
+            checker_input = std::move(relayed_to_checker.readable);
+            solution_input = std::move(relayed_to_solution.readable);
+            relay_job_pending = true;
+            relay_job_posted.post();
         }
-        FileDescriptor checker_input(pfds[0]);
-        FileDescriptor solution_output(pfds[1]);
 
-        if (pipe2(pfds, O_CLOEXEC)) {
-            THROW("pipe2()", errmsg());
+        TRACE_SPAN_NAMED(load_span, "load test files");
+        if (use_memfds) {
+            test_in = package_loader->load_as_fd(test.in, "test.in");
+            test_in_path = fd_path(test_in).to_string();
+        } else {
+            test_in_path = package_loader->load_as_file(test.in, "test.in");
         }
-        FileDescriptor solution_input(pfds[0]);
-        FileDescriptor checker_output(pfds[1]);
-
-        string test_in_path = package_loader->load_as_file(test.in, "test.in");
+        TRACE_SPAN_END(load_span);
         auto solution_real_time_limit = cpu_time_limit_to_real_time_limit(test.time_limit);
 
         // Schedule checker supervisor
-        next_job_promise.set_value(NextJob{
-            std::move(checker_input), std::move(checker_output), test_in_path,
+        checker_finished.store(false, std::memory_order_seq_cst);
+        solution_pid.store(0, std::memory_order_seq_cst);
+        kill_solution.store(false, std::memory_order_seq_cst);
+        checker_job.emplace(CheckerJob{
+            std::move(checker_input), std::move(checker_output), &test_in_path, test_in,
             solution_real_time_limit});
-        // Synchronize with checker supervisor to safely recover later in case
-        // of exceptions (need to set next_job_promise to std::nullopt)
-        checker_supervisor_ready.get_future().get();
-        checker_supervisor_ready = {}; // reset promise
+        checker_job_pending = true;
+        checker_job_posted.post();
+
+        Sandbox::Options opts = {
+            solution_input, solution_output, -1, solution_real_time_limit, test.memory_limit,
+            test.time_limit};
+        opts.exec_fd = solution_memfd;
+        opts.read_schedstat = read_schedstat;
 
         // Run solution
-        Sandbox::ExitStat es;
-        bool solution_pid_was_set = false;
-        try {
-            es = sandbox.run(
-                solution_path, {},
-                {solution_input, solution_output, -1, solution_real_time_limit,
-                 test.memory_limit, test.time_limit},
-                {}, [&](pid_t pid) {
-                    solution_pid_promise.set_value(pid);
-                    solution_pid_was_set = true;
-                }); // Allow exceptions to fly upper
-        } catch (...) {
-            if (not solution_pid_was_set) {
-                solution_pid_promise.set_value(std::nullopt);
+        TRACE_SPAN_NAMED(solution_span, "run solution");
+        auto es = sandbox.run(solution_path, {}, opts, {}, [&](pid_t pid) {
+            solution_pid.store(pid, std::memory_order_seq_cst);
+            if (kill_solution.load(std::memory_order_seq_cst)) {
+                kill(pid, SIGKILL); // Checker has already exited
             }
-            throw;
-        }
+        }); // Allow exceptions to fly upper
+        TRACE_SPAN_END(solution_span);
+        // The solution is reaped, so its pid cannot be used to kill it anymore
+        solution_pid.store(0, std::memory_order_seq_cst);
 
         bool checker_finished_before_solution =
             checker_finished.load(std::memory_order_seq_cst);
@@ -624,12 +830,17 @@ JudgeReport JudgeWorker::judge_interactive(
         (void)solution_output.close();
 
         // Get checker status
-        auto checker_result = checker_status_promise.get_future().get();
-        checker_status_promise = {}; // reset promise
+        auto checker_result = wait_for_checker_status();
 
         JudgeReport::Test test_report(
             test.name, JudgeReport::Test::OK, es.cpu_runtime, test.time_limit, es.vm_peak,
             test.memory_limit, string{});
+        if (es.schedstat) {
+            test_report.run_queue_wait_time = es.schedstat->run_queue_wait_time;
+        }
+        if (relay_job_pending) {
+            test_report.transcript = wait_for_relay();
+        }
 
         // Update group_score_ratio
         group_score_ratio = std::min(group_score_ratio, checker_result.ratio);
@@ -652,7 +863,8 @@ JudgeReport JudgeWorker::judge_interactive(
              test_report.runtime <= test_report.time_limit) or
             (checker_finished_before_solution and
              (checker_result.status != CheckerStatus::OK or checker_result.ratio < 1) and
-             test_report.runtime < test_report.time_limit and es.runtime < test.time_limit))
+             test_report.runtime < test_report.time_limit and
+             solution_real_runtime(es) < test.time_limit))
         {
             switch (checker_result.status) {
             case CheckerStatus::OK:
@@ -679,7 +891,9 @@ JudgeReport JudgeWorker::judge_interactive(
 
         // After checking status for OK >= comparison is safe to detect
         // exceeding
-        if (test_report.runtime >= test_report.time_limit or es.runtime >= test.time_limit) {
+        if (test_report.runtime >= test_report.time_limit or
+            solution_real_runtime(es) >= test.time_limit)
+        {
             // Solution: TLE
             // es.runtime >= tl meas that real_time_limit has been exceeded
             if (test_report.runtime < test_report.time_limit) {
@@ -709,30 +923,66 @@ JudgeReport JudgeWorker::judge_interactive(
         return test_report;
     };
 
-    auto solution_supervisor = [&] {
-        STACK_UNWINDING_MARK;
-        // Wait for checker supervisor to set up
-        checker_supervisor_ready.get_future().get();
-        checker_supervisor_ready = {}; // reset promise
-
-        return process_tests(final, judge_log, partial_report_callback, judge_on_test);
-    };
-
     std::thread checker_supervisor_thread(checker_supervisor);
-    try {
-        // This thread is a solution supervisor thread
-        auto report = solution_supervisor();
-        next_job_promise.set_value(std::nullopt); // No more jobs
+    Defer checker_supervisor_guard([&] {
+        try {
+            if (checker_job_pending) {
+                // Solution's pipe ends are already closed, so the checker will
+                // end soon
+                checker_status_posted.wait();
+            }
+            checker_job.reset(); // No more jobs
+            checker_job_posted.post();
+        } catch (...) {
+            ERRLOG_CATCH();
+        }
         checker_supervisor_thread.join();
-        return report;
+    });
 
-    } catch (...) {
-        next_job_promise.set_value(std::nullopt);
-        if (checker_supervisor_thread.joinable()) { // Join above may have thrown
-            checker_supervisor_thread.join();
+    Defer relay_guard([&] {
+        if (not relay_thread.joinable()) {
+            return;
+        }
+        try {
+            if (relay_job_pending) {
+                // Solution's pipe ends are already closed, so the relay will
+                // end soon
+                relay_done.wait();
+            }
+            relay_stop = true;
+            relay_job_posted.post();
+        } catch (...) {
+            ERRLOG_CATCH();
         }
-        throw;
+        relay_thread.join();
+    });
+    if (interactive_transcript_max_len > 0) {
+        relay_thread = std::thread(relay);
     }
+
+    // This thread is a solution supervisor thread
+    return process_tests(final, judge_log, partial_report_callback, judge_on_test);
+}
+
+size_t
+JudgeWorker::RerunPolicy::pick_run(const vector<std::chrono::nanoseconds>& runtimes) const {
+    assert(not runtimes.empty());
+    switch (pick) {
+    case Pick::MIN:
+        return static_cast<size_t>(
+            std::min_element(runtimes.begin(), runtimes.end()) - runtimes.begin());
+    case Pick::MEDIAN: {
+        vector<size_t> indexes(runtimes.size());
+        std::iota(indexes.begin(), indexes.end(), 0);
+        auto median = indexes.begin() + (indexes.size() - 1) / 2;
+        std::nth_element(indexes.begin(), median, indexes.end(), [&](size_t a, size_t b) {
+            return runtimes[a] < runtimes[b];
+        });
+        return *median;
+    }
+    }
+
+    THROW("Invalid pick: ", EnumVal(pick).to_int());
 }
 
 JudgeReport JudgeWorker::judge(
@@ -740,6 +990,7 @@ JudgeReport JudgeWorker::judge(
     const std::optional<std::function<void(const JudgeReport&)>>& partial_report_callback)
     const {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("judge");
 
     using std::chrono_literals::operator""ns;
 
@@ -755,11 +1006,22 @@ JudgeReport JudgeWorker::judge(
         THROW("score_cut_lambda has to be from [0, 1]");
     }
 
+    if (rerun_policy.has_value() and
+        (rerun_policy->band < 0 or rerun_policy->band > 1 or rerun_policy->runs < 1))
+    {
+        THROW("If set, rerun_policy has to have band from [0, 1] and runs >= 1");
+    }
+
+    if (interactive_pipe_size.has_value() and
+        (interactive_pipe_size.value() == 0 or interactive_pipe_size.value() > INT_MAX))
+    {
+        THROW("If set, interactive_pipe_size has to be from [1, INT_MAX]");
+    }
+
     if (sf.interactive) {
         return judge_interactive(final, judge_log, partial_report_callback);
     }
 
-    string sol_stdout_path{tmp_dir.path() + "sol_stdout"};
     // Checker output
     FileDescriptor checker_stderr{open_unlinked_tmp_file(O_CLOEXEC)};
     FileDescriptor checker_stdout{open_unlinked_tmp_file(O_CLOEXEC)}; // backward compatibility
@@ -767,13 +1029,35 @@ JudgeReport JudgeWorker::judge(
         THROW("Failed to create unlinked temporary file", errmsg());
     }
 
-    // Solution STDOUT
-    FileDescriptor solution_stdout(sol_stdout_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
-    if (not solution_stdout.is_open()) {
-        THROW("Failed to open file `", sol_stdout_path, '`', errmsg());
-    }
-
-    FileRemover solution_stdout_remover{sol_stdout_path}; // Save disk space
+    // Solution STDOUT, one for each run on a test, so that the output of the
+    // picked run can be checked if the test is re-run
+    struct SolutionOutput {
+        FileDescriptor fd;
+        string path;
+        FileRemover remover; // Save disk space
+    };
+    std::deque<SolutionOutput> solution_outputs;
+    auto add_solution_output = [&] {
+        auto& output = solution_outputs.emplace_back();
+        if (use_memfds) {
+            output.fd = open_memfd("sol_stdout");
+            if (not output.fd.is_open()) {
+                THROW("memfd_create()", errmsg());
+            }
+            output.path = fd_path(output.fd).to_string();
+        } else {
+            output.path = concat_tostr(tmp_dir.path(), "sol_stdout");
+            if (solution_outputs.size() > 1) {
+                back_insert(output.path, '.', solution_outputs.size() - 1);
+            }
+            output.fd.open(output.path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC);
+            if (not output.fd.is_open()) {
+                THROW("Failed to open file `", output.path, '`', errmsg());
+            }
+            output.remover.reset(output.path);
+        }
+    };
+    add_solution_output(); // Used by the first run on each test
 
     // Checker parameters
     Sandbox::Options checker_opts = {
@@ -781,38 +1065,123 @@ JudgeReport JudgeWorker::judge(
         checker_stdout, // STDOUT (backward compatibility)
         checker_stderr, // STDERR
         checker_time_limit, checker_memory_limit};
+    checker_opts.exec_fd = checker_memfd;
 
     Sandbox sandbox;
 
     string checker_path{concat_tostr(tmp_dir.path(), CHECKER_FILENAME)};
     string solution_path{concat_tostr(tmp_dir.path(), SOLUTION_FILENAME)};
 
+    // Scratch data of a single test. It lives as long as the whole run, so that
+    // the strings and vectors keep their capacity and judging subsequent tests
+    // does not allocate them anew.
+    string test_in_path;
+    string test_out_path;
+    vector<string> checker_args = {checker_path, "", "", ""};
+    vector<Sandbox::AllowedFile> checker_allowed_files(3, {"", OpenAccess::RDONLY});
+    vector<Sandbox::ExitStat> solution_runs; // used if the test is re-run
+
     using std::chrono_literals::operator""s;
 
     auto judge_on_test = [&](const sim::Simfile::Test& test, double& group_score_ratio) {
         STACK_UNWINDING_MARK;
+        TRACE_SPAN("judge test");
+        judged_tests.inc();
 
         // Prepare solution fds
-        (void)ftruncate(solution_stdout, 0);
-        (void)lseek(solution_stdout, 0, SEEK_SET);
-
-        string test_in_path = package_loader->load_as_file(test.in, "test.in");
-        string test_out_path = package_loader->load_as_file(test.out.value(), "test.out");
-
-        FileDescriptor test_in(test_in_path, O_RDONLY | O_CLOEXEC);
-        if (not test_in.is_open()) {
-            THROW("Failed to open file `", test_in_path, '`', errmsg());
+        auto prepare_solution_output = [&](size_t run) {
+            if (run == solution_outputs.size()) {
+                add_solution_output();
+            }
+            (void)ftruncate(solution_outputs[run].fd, 0);
+            (void)lseek(solution_outputs[run].fd, 0, SEEK_SET);
+        };
+        prepare_solution_output(0);
+
+        TRACE_SPAN_NAMED(load_span, "load test files");
+        FileDescriptor test_in;
+        FileDescriptor test_out;
+        if (use_memfds) {
+            test_in = package_loader->load_as_fd(test.in, "test.in");
+            test_out = package_loader->load_as_fd(test.out.value(), "test.out");
+            test_in_path = fd_path(test_in).to_string();
+            test_out_path = fd_path(test_out).to_string();
+        } else {
+            test_in_path = package_loader->load_as_file(test.in, "test.in");
+            test_out_path = package_loader->load_as_file(test.out.value(), "test.out");
+            test_in.open(test_in_path, O_RDONLY | O_CLOEXEC);
+            if (not test_in.is_open()) {
+                THROW("Failed to open file `", test_in_path, '`', errmsg());
+            }
         }
+        TRACE_SPAN_END(load_span);
+
+        Sandbox::Options opts = {
+            test_in, solution_outputs[0].fd, -1,
+            cpu_time_limit_to_real_time_limit(test.time_limit), test.memory_limit,
+            test.time_limit};
+        opts.exec_fd = solution_memfd;
+        opts.read_schedstat = read_schedstat;
 
         // Run solution on the test
-        Sandbox::ExitStat es = sandbox.run(
-            solution_path, {},
-            {test_in, solution_stdout, -1, cpu_time_limit_to_real_time_limit(test.time_limit),
-             test.memory_limit, test.time_limit}); // Allow exceptions to fly upper
+        TRACE_SPAN_NAMED(solution_span, "run solution");
+        Sandbox::ExitStat es =
+            sandbox.run(solution_path, {}, opts); // Allow exceptions to fly upper
+        TRACE_SPAN_END(solution_span);
+
+        // Only OK and TLE depend on the runtime, other verdicts do not change
+        // however long the solution runs
+        auto verdict_depends_on_runtime = [&](const Sandbox::ExitStat& run) {
+            return (run.si.code == CLD_EXITED and run.si.status == 0) or
+                run.cpu_runtime >= test.time_limit or
+                solution_real_runtime(run) >= test.time_limit;
+        };
+
+        // Re-run the solution if the first measurement is not decisive
+        size_t picked_run = 0;
+        vector<std::chrono::nanoseconds> all_runtimes;
+        if (rerun_policy.has_value() and rerun_policy->runs > 1 and
+            verdict_depends_on_runtime(es) and
+            rerun_policy->is_close(es.cpu_runtime, test.time_limit, score_cut_lambda))
+        {
+            TRACE_SPAN("rerun solution");
+            solution_runs.clear();
+            all_runtimes.emplace_back(es.cpu_runtime);
+            solution_runs.emplace_back(std::move(es));
+            do {
+                size_t run = solution_runs.size();
+                prepare_solution_output(run);
+                if (lseek(test_in, 0, SEEK_SET)) {
+                    THROW("lseek()", errmsg());
+                }
+                opts.new_stdout_fd = solution_outputs[run].fd;
+                solution_runs.emplace_back(sandbox.run(solution_path, {}, opts));
+                all_runtimes.emplace_back(solution_runs.back().cpu_runtime);
+                if (not verdict_depends_on_runtime(solution_runs.back())) {
+                    picked_run = run; // Runtime cannot change its verdict
+                    break;
+                }
+                picked_run = rerun_policy->pick_run(all_runtimes);
+            } while (solution_runs.size() < rerun_policy->runs and
+                     rerun_policy->is_close(
+                         all_runtimes[picked_run], test.time_limit, score_cut_lambda));
+
+            es = std::move(solution_runs[picked_run]);
+            // Free the outputs of the runs that were not picked
+            for (size_t run = 0; run < solution_runs.size(); ++run) {
+                if (run != picked_run) {
+                    (void)ftruncate(solution_outputs[run].fd, 0);
+                }
+            }
+        }
 
         JudgeReport::Test test_report(
             test.name, JudgeReport::Test::OK, es.cpu_runtime, test.time_limit, es.vm_peak,
             test.memory_limit, string{});
+        test_report.all_runtimes = std::move(all_runtimes);
+        if (es.schedstat) {
+            test_report.run_queue_wait_time = es.schedstat->run_queue_wait_time;
+        }
 
         if (es.si.code == CLD_EXITED and es.si.status == 0 and
             test_report.runtime <= test_report.time_limit)
@@ -820,7 +1189,8 @@ JudgeReport JudgeWorker::judge(
             // OK
 
         } else if (
-            test_report.runtime >= test_report.time_limit or es.runtime >= test.time_limit)
+            test_report.runtime >= test_report.time_limit or
+            solution_real_runtime(es) >= test.time_limit)
         { // After checking status for
           // OK `>=` comparison is
           // safe to detect exceeding
@@ -870,13 +1240,24 @@ JudgeReport JudgeWorker::judge(
         (void)ftruncate(checker_stdout, 0);
         (void)lseek(checker_stdout, 0, SEEK_SET);
 
+        auto allow_file = [&](size_t idx, const string& path, int fd) {
+            checker_allowed_files[idx].path = path;
+            checker_allowed_files[idx].fd = (use_memfds ? fd : -1);
+        };
+        allow_file(0, test_in_path, test_in);
+        allow_file(1, test_out_path, test_out);
+        allow_file(2, solution_outputs[picked_run].path, solution_outputs[picked_run].fd);
+        checker_args[1] = test_in_path;
+        checker_args[2] = test_out_path;
+        checker_args[3] = solution_outputs[picked_run].path;
+
         // Run checker
+        TRACE_SPAN_NAMED(checker_span, "run checker");
         auto ces = sandbox.run(
-            checker_path, {checker_path, test_in_path, test_out_path, sol_stdout_path},
-            checker_opts,
-            {{test_in_path, OpenAccess::RDONLY},
-             {test_out_path, OpenAccess::RDONLY},
-             {sol_stdout_path, OpenAccess::RDONLY}}); // Allow exceptions to fly higher
+            checker_path, checker_args, checker_opts,
+            checker_allowed_files); // Allow exceptions to fly higher
+        TRACE_SPAN_END(checker_span);
+        checker_duration.observe(ces.runtime);
 
         auto checker_result = [&] {
             auto checker_stderr_pos = lseek(checker_stderr, 0, SEEK_CUR);
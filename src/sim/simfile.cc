@@ -8,6 +8,7 @@
 #include <cmath>
 #include <map>
 #include <utility>
+#include <vector>
 
 using std::pair;
 using std::string;
@@ -439,11 +440,26 @@ void Simfile::load_tests() {
         tgroups.emplace_back(std::move(group));
     }
 
-    // Sort tests in groups
+    // Sort tests in groups (every name is split once, not in every comparison)
+    std::vector<std::pair<TestNameComparator::Key, Test*>> order;
+    std::vector<Test> sorted_tests;
     for (auto& group : tgroups) {
-        sort(group.tests, [](const Test& a, const Test& b) {
-            return TestNameComparator()(a.name, b.name);
+        order.clear();
+        order.reserve(group.tests.size());
+        for (auto& test : group.tests) {
+            order.emplace_back(TestNameComparator::key(test.name), &test);
+        }
+        sort(order, [](const auto& a, const auto& b) {
+            return TestNameComparator()(a.first, b.first);
         });
+
+        // Keys refer to the names, so tests are moved only after sorting
+        sorted_tests.clear();
+        sorted_tests.reserve(group.tests.size());
+        for (auto& [_, test] : order) {
+            sorted_tests.emplace_back(std::move(*test));
+        }
+        group.tests.swap(sorted_tests);
     }
 }
 
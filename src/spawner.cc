@@ -2,15 +2,20 @@
 #include "simlib/call_in_destructor.hh"
 #include "simlib/directory.hh"
 #include "simlib/file_descriptor.hh"
+#include "simlib/metrics.hh"
 #include "simlib/overloaded.hh"
 #include "simlib/string_transform.hh"
 #include "simlib/syscalls.hh"
 #include "simlib/time.hh"
+#include "simlib/tracing.hh"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <ctime>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <utility>
 #include <variant>
@@ -20,6 +25,11 @@ using std::array;
 using std::string;
 using std::vector;
 
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static metrics::DurationHistogram spawn_latency{
+    "simlib_spawner_spawn_latency_seconds",
+    "Time from fork() until the child is ready to execute the spawned program"};
+
 string Spawner::receive_error_message(const siginfo_t& si, int fd) {
     STACK_UNWINDING_MARK;
 
@@ -193,6 +203,7 @@ Spawner::ExitStat Spawner::run(
     FilePath exec, const vector<string>& exec_args, const Spawner::Options& opts,
     const std::function<void(pid_t)>& do_in_parent_after_fork) {
     STACK_UNWINDING_MARK;
+    TRACE_SPAN("Spawner::run");
 
     using std::chrono_literals::operator""ns;
 
@@ -214,13 +225,14 @@ Spawner::ExitStat Spawner::run(
         THROW("pipe()", errmsg());
     }
 
+    auto fork_time = std::chrono::steady_clock::now();
     int cpid = fork();
     if (cpid == -1) {
         THROW("fork()", errmsg());
     }
     if (cpid == 0) {
         close(pfd[0]);
-        run_child(exec, exec_args, opts, pfd[1], [] {});
+        run_child(exec, exec_args, opts, pfd[1], {}, [] {});
     }
 
     close(pfd[1]);
@@ -232,6 +244,7 @@ Spawner::ExitStat Spawner::run(
     if (syscalls::waitid(P_PID, cpid, &si, WSTOPPED | WEXITED, &ru) == -1) {
         THROW("waitid()", errmsg());
     }
+    spawn_latency.observe(std::chrono::steady_clock::now() - fork_time);
 
     // If something went wrong
     if (si.si_code != CLD_STOPPED) {
@@ -255,29 +268,61 @@ Spawner::ExitStat Spawner::run(
     // Set up timers
     Timer timer(cpid, opts.real_time_limit.value_or(0ns), CLOCK_MONOTONIC);
     Timer cpu_timer(cpid, opts.cpu_time_limit.value_or(0ns), child_cpu_clock_id);
+    // The child is stopped, so the statistics are not affected by reading them
+    auto schedstat_at_start =
+        (opts.read_schedstat ? read_proc_schedstat(cpid) : std::nullopt);
     kill(cpid, SIGCONT); // There is only one process now, so '-' is not needed
 
+    std::optional<PeriodicProcSampler> sampler;
+    if (opts.sampling_interval) {
+        // Before execve() the child shares the memory of this process, so
+        // sampling starts after it. The pipe is closed on a successful
+        // execve(), and receives an error message if execve() fails.
+        pollfd exec_pfd = {pfd[0], POLLIN, 0};
+        while (poll(&exec_pfd, 1, -1) == -1) {
+            if (errno != EINTR) {
+                THROW("poll()", errmsg());
+            }
+        }
+        if (not(exec_pfd.revents & POLLIN)) {
+            sampler.emplace(cpid, *opts.sampling_interval);
+        }
+    }
+
     // Wait for death of the child
     syscalls::waitid(P_PID, cpid, &si, WEXITED | WNOWAIT, nullptr);
 
     // Get runtime and cpu runtime
     auto runtime = timer.deactivate_and_get_runtime();
     auto cpu_runtime = cpu_timer.deactivate_and_get_runtime();
+    // The child has to be sampled before it is waited, as its pid may be reused
+    auto profile = (sampler ? sampler->stop() : vector<ProcSample>{});
+    auto schedstat = (schedstat_at_start ? read_proc_schedstat(cpid) : std::nullopt);
 
     kill_and_wait_child_guard.cancel();
     syscalls::waitid(P_PID, cpid, &si, WEXITED, &ru);
 
+    ExitStat es(runtime, cpu_runtime, si.si_code, si.si_status, ru, 0);
     if (si.si_code != CLD_EXITED or si.si_status != 0) {
-        return ExitStat(
-            runtime, cpu_runtime, si.si_code, si.si_status, ru, 0,
-            receive_error_message(si, pfd[0]));
+        es.message = receive_error_message(si, pfd[0]);
+    }
+    set_profile(es, std::move(profile));
+    if (schedstat) {
+        es.schedstat = schedstat->since(*schedstat_at_start);
     }
+    return es;
+}
 
-    return ExitStat(runtime, cpu_runtime, si.si_code, si.si_status, ru, 0);
+void Spawner::set_profile(ExitStat& es, vector<ProcSample> profile) noexcept {
+    for (const auto& sample : profile) {
+        es.rss_peak = std::max(es.rss_peak, sample.rss);
+    }
+    es.profile = std::move(profile);
 }
 
 void Spawner::run_child(
     FilePath exec, const std::vector<std::string>& exec_args, const Options& opts, int fd,
+    const std::vector<int>& inherited_fds,
     const std::function<void()>& do_before_exec) noexcept {
     STACK_UNWINDING_MARK;
     // Sends error to parent
@@ -406,6 +451,7 @@ void Spawner::run_child(
             (opts.new_stdin_fd < 0 ? fd : STDIN_FILENO),
             (opts.new_stdout_fd < 0 ? fd : STDOUT_FILENO),
             (opts.new_stderr_fd < 0 ? fd : STDERR_FILENO),
+            (opts.exec_fd < 0 ? fd : opts.exec_fd),
         };
 
         for_each_dir_component(
@@ -418,6 +464,11 @@ void Spawner::run_child(
                             return;
                         }
                     }
+                    for (int fd_no : inherited_fds) {
+                        if (*filename == fd_no) {
+                            return;
+                        }
+                    }
                 }
 
                 if (auto opt = str2num<int>(file->d_name); opt) {
@@ -427,6 +478,18 @@ void Spawner::run_child(
             [&] { send_error_and_exit(errno, "readdir()"); });
     }
 
+    // Make inherited file descriptors survive exec
+    for (int fd_no : inherited_fds) {
+        if (fcntl(fd_no, F_SETFD, 0)) {
+            send_error_and_exit(errno, "fcntl(F_SETFD)");
+        }
+    }
+
+    // The executed file descriptor should not leak into the executed program
+    if (opts.exec_fd >= 0 and fcntl(opts.exec_fd, F_SETFD, FD_CLOEXEC)) {
+        send_error_and_exit(errno, "fcntl(F_SETFD)");
+    }
+
     try {
         do_before_exec();
     } catch (std::exception& e) {
@@ -436,10 +499,14 @@ void Spawner::run_child(
     // Signal parent process that child is ready to execute @p exec
     kill(getpid(), SIGSTOP);
 
-    execvp(exec, const_cast<char* const*>(args.get()));
+    if (opts.exec_fd >= 0) {
+        fexecve(opts.exec_fd, const_cast<char* const*>(args.get()), environ);
+    } else {
+        execvp(exec, const_cast<char* const*>(args.get()));
+    }
     int errnum = errno;
 
-    // execvp() failed
+    // execvp() or fexecve() failed
     if (exec.size() <= PATH_MAX) {
         send_error_and_exit(
             errnum,
@@ -1,6 +1,9 @@
+#include "simlib/time.hh"
 #include "simlib/debug.hh"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <ctime>
 #include <string>
 #include <sys/time.h>
@@ -41,6 +44,106 @@ string localdate(CStringView format, time_t curr_time) {
     return date_impl(format, curr_time, localtime_r);
 }
 
+namespace {
+
+// Date formatted as "%Y-%m-%d %H:%M:%S"
+struct CachedDate {
+    bool valid = false;
+    time_t time = 0;
+    // Timezone (set by the last tzset(3)) that the local date was computed for
+    const char* std_tzname = nullptr;
+    const char* dst_tzname = nullptr;
+    long tz_offset = 0;
+    size_t len = 0;
+    std::array<char, MYSQL_DATE_MAX_LEN - 10 + 1> str{}; // +1 for strftime()'s null
+};
+
+thread_local CachedDate cached_utc_date;
+thread_local CachedDate cached_local_date;
+
+bool has_current_timezone(const CachedDate& cd) noexcept {
+    return cd.std_tzname == tzname[0] and cd.dst_tzname == tzname[1] and
+        cd.tz_offset == ::timezone;
+}
+
+template <bool local>
+StaticCStringBuff<MYSQL_DATE_MAX_LEN>
+cached_mysql_date(std::chrono::system_clock::time_point tp, uint subsecond_digits) noexcept {
+    auto secs = std::chrono::floor<std::chrono::seconds>(tp);
+    time_t time = secs.time_since_epoch().count();
+
+    auto& cache = (local ? cached_local_date : cached_utc_date);
+    if (not cache.valid or cache.time != time or (local and not has_current_timezone(cache)))
+    {
+        cache.valid = false;
+        tm ptm{};
+        if (not(local ? localtime_r(&time, &ptm) : gmtime_r(&time, &ptm))) {
+            return {};
+        }
+        cache.len = strftime(cache.str.data(), cache.str.size(), "%Y-%m-%d %H:%M:%S", &ptm);
+        if (cache.len == 0) {
+            return {};
+        }
+
+        cache.time = time;
+        // localtime_r() may have just loaded the timezone
+        cache.std_tzname = tzname[0];
+        cache.dst_tzname = tzname[1];
+        cache.tz_offset = ::timezone;
+        cache.valid = true;
+    }
+
+    StaticCStringBuff<MYSQL_DATE_MAX_LEN> res;
+    std::copy(cache.str.data(), cache.str.data() + cache.len, res.data());
+    res.len_ = cache.len;
+    if (subsecond_digits > 0) {
+        subsecond_digits = std::min(subsecond_digits, 9U);
+        using std::chrono::nanoseconds;
+        uint64_t frac = std::chrono::duration_cast<nanoseconds>(tp - secs).count();
+        for (auto i = subsecond_digits; i < 9; ++i) {
+            frac /= 10;
+        }
+        res[res.len_++] = '.';
+        res.len_ += subsecond_digits;
+        detail::write_digits_backwards(res.data() + res.len_, frac, subsecond_digits);
+    }
+    res[res.len_] = '\0';
+    return res;
+}
+
+std::chrono::system_clock::time_point time_point_of(time_t curr_time) noexcept {
+    return curr_time < 0 ? std::chrono::system_clock::now()
+                         : std::chrono::system_clock::from_time_t(curr_time);
+}
+
+} // namespace
+
+StaticCStringBuff<MYSQL_DATE_MAX_LEN>
+mysql_date_buff(std::chrono::system_clock::time_point tp, uint subsecond_digits) noexcept {
+    return cached_mysql_date<false>(tp, subsecond_digits);
+}
+
+StaticCStringBuff<MYSQL_DATE_MAX_LEN> mysql_localdate_buff(
+    std::chrono::system_clock::time_point tp, uint subsecond_digits) noexcept {
+    return cached_mysql_date<true>(tp, subsecond_digits);
+}
+
+string mysql_date(time_t curr_time) {
+    auto res = mysql_date_buff(time_point_of(curr_time));
+    if (res.size() == 0) {
+        THROW("Failed to convert time");
+    }
+    return string(res.data(), res.size());
+}
+
+string mysql_localdate(time_t curr_time) {
+    auto res = mysql_localdate_buff(time_point_of(curr_time));
+    if (res.size() == 0) {
+        THROW("Failed to convert time");
+    }
+    return string(res.data(), res.size());
+}
+
 bool is_datetime(const CStringView& str) noexcept {
     struct tm t {};
     return (str.size() == 19 && strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &t) != nullptr);
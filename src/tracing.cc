@@ -0,0 +1,150 @@
+#include "simlib/tracing.hh"
+#include "simlib/concat.hh"
+#include "simlib/inplace_buff.hh"
+#include "simlib/json_str/json_str.hh"
+#include "simlib/syscalls.hh"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+
+namespace tracing {
+
+namespace {
+
+// Spans of the finished threads are kept up to this limit
+constexpr size_t FINISHED_THREADS_SPANS_LIMIT = 4 * SPANS_PER_THREAD;
+
+class ThreadSpans;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadSpans*> threads;
+    std::deque<SpanRecord> finished_threads_spans;
+};
+
+// Never destroyed, as threads may finish after the static objects are destroyed
+Registry& registry() {
+    static auto* reg = new Registry; // NOLINT(cppcoreguidelines-owning-memory)
+    return *reg;
+}
+
+class ThreadSpans {
+    // Contended only by spans_since() and finishing threads
+    std::mutex mutex_;
+    std::unique_ptr<SpanRecord[]> records_ = std::make_unique<SpanRecord[]>(SPANS_PER_THREAD);
+    size_t recorded_ = 0; // number of all spans recorded by the thread
+    pid_t tid_ = syscalls::gettid();
+
+public:
+    ThreadSpans() {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.threads.emplace_back(this);
+    }
+
+    ThreadSpans(const ThreadSpans&) = delete;
+    ThreadSpans(ThreadSpans&&) = delete;
+    ThreadSpans& operator=(const ThreadSpans&) = delete;
+    ThreadSpans& operator=(ThreadSpans&&) = delete;
+
+    ~ThreadSpans() {
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        reg.threads.erase(std::find(reg.threads.begin(), reg.threads.end(), this));
+        try {
+            for_each([&](const SpanRecord& span) {
+                reg.finished_threads_spans.emplace_back(span);
+            });
+        } catch (...) {
+            // Nothing we can do here
+        }
+        while (reg.finished_threads_spans.size() > FINISHED_THREADS_SPANS_LIMIT) {
+            reg.finished_threads_spans.pop_front();
+        }
+    }
+
+    void push(const char* name, Clock::time_point start, Clock::time_point end) noexcept {
+        std::lock_guard lock(mutex_);
+        records_[recorded_++ % SPANS_PER_THREAD] = {name, start, end, tid_};
+    }
+
+    template <class Func>
+    void for_each(Func&& func) {
+        std::lock_guard lock(mutex_);
+        size_t first = recorded_ - std::min(recorded_, SPANS_PER_THREAD);
+        for (size_t i = first; i < recorded_; ++i) {
+            func(records_[i % SPANS_PER_THREAD]);
+        }
+    }
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local ThreadSpans thread_spans;
+
+// Formats @p ns nanoseconds as microseconds with 3 decimal places
+InplaceBuff<32> to_micros(std::chrono::nanoseconds ns) {
+    auto count = ns.count();
+    auto frac = count % 1000;
+    return concat<32>(
+        count / 1000, '.', static_cast<char>('0' + frac / 100),
+        static_cast<char>('0' + frac / 10 % 10), static_cast<char>('0' + frac % 10));
+}
+
+} // namespace
+
+void record(const char* name, Clock::time_point start, Clock::time_point end) noexcept {
+    try {
+        thread_spans.push(name, start, end);
+    } catch (...) {
+        // Creating the buffer of the current thread failed, so drop the span
+    }
+}
+
+std::vector<SpanRecord> spans_since(Clock::time_point since) {
+    std::vector<SpanRecord> res;
+    auto collect = [&](const SpanRecord& span) {
+        if (span.start >= since) {
+            res.emplace_back(span);
+        }
+    };
+
+    auto& reg = registry();
+    {
+        std::lock_guard lock(reg.mutex);
+        std::for_each(
+            reg.finished_threads_spans.begin(), reg.finished_threads_spans.end(), collect);
+        for (auto* thread : reg.threads) {
+            thread->for_each(collect);
+        }
+    }
+
+    std::stable_sort(res.begin(), res.end(), [](const SpanRecord& a, const SpanRecord& b) {
+        return a.start < b.start;
+    });
+    return res;
+}
+
+std::string to_chrome_trace_json(const std::vector<SpanRecord>& spans) {
+    auto pid = getpid();
+    json_str::Object obj;
+    obj.prop_arr("traceEvents", [&](auto& arr) {
+        for (const auto& span : spans) {
+            arr.val_obj([&](auto& event) {
+                event.prop("name", span.name);
+                event.prop("cat", "simlib");
+                event.prop("ph", "X"); // complete event
+                event.prop_raw("ts", to_micros(span.start.time_since_epoch()));
+                event.prop_raw("dur", to_micros(span.end - span.start));
+                event.prop("pid", pid);
+                event.prop("tid", span.tid);
+            });
+        }
+    });
+    obj.prop("displayTimeUnit", "ms");
+    return std::move(obj).into_str();
+}
+
+} // namespace tracing
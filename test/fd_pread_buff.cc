@@ -31,3 +31,60 @@ TEST(fd_pread_buff, fd_pread_buff) {
             str, StringView(data).substring(offset, std::min<int>(offset + len, data.size())));
     }
 }
+
+// NOLINTNEXTLINE
+TEST(fd_pread_buff, read_line) {
+    OpenedTemporaryFile tmp_file{"/tmp/fd_pread_buff.test.XXXXXX"};
+    put_file_contents(tmp_file.path(), "abc\n\nline xxxxxxxxxxxxxxxxxxxx\nlast");
+    BasicFdPreadBuff<16> fbuff{tmp_file};
+    EXPECT_EQ(fbuff.read_line(), "abc");
+    EXPECT_EQ(fbuff.read_line(), "");
+    // Lines longer than the buffer are split
+    EXPECT_EQ(fbuff.read_line(), "line xxxxxxxxxxx");
+    EXPECT_EQ(fbuff.read_line(), "xxxxxxxxx");
+    EXPECT_EQ(fbuff.curr_offset(), 31);
+    EXPECT_EQ(fbuff.read_until('s'), "la");
+    EXPECT_EQ(fbuff.read_line(), "t");
+    EXPECT_EQ(fbuff.read_line(), std::nullopt);
+    EXPECT_EQ(errno, 0);
+    EXPECT_EQ(fbuff.read_line(), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(fd_pread_buff, skip_until) {
+    OpenedTemporaryFile tmp_file{"/tmp/fd_pread_buff.test.XXXXXX"};
+    put_file_contents(tmp_file.path(), "aaaaaaaaaaaaaaaaaaaaaaaa\nb\nc");
+    BasicFdPreadBuff<8> fbuff{tmp_file};
+    EXPECT_EQ(fbuff.skip_until('\n'), '\n');
+    EXPECT_EQ(fbuff.get_char(), 'b');
+    EXPECT_EQ(fbuff.skip_until('\n'), '\n');
+    EXPECT_EQ(fbuff.skip_until('\n'), EOF);
+    EXPECT_EQ(fbuff.curr_offset(), 28);
+    EXPECT_EQ(fbuff.get_char(), EOF);
+}
+
+// NOLINTNEXTLINE
+TEST(fd_pread_buff, read_token) {
+    OpenedTemporaryFile tmp_file{"/tmp/fd_pread_buff.test.XXXXXX"};
+    put_file_contents(tmp_file.path(), "  12 345\t\n\n  abcdefghijklm  x \n ");
+    BasicFdPreadBuff<8> fbuff{tmp_file, 2};
+    EXPECT_EQ(fbuff.read_token(), "12");
+    EXPECT_EQ(fbuff.get_char(), ' ');
+    EXPECT_EQ(fbuff.read_token(), "345");
+    EXPECT_EQ(fbuff.read_token(), "abcdefgh");
+    EXPECT_EQ(fbuff.read_token(), "ijklm");
+    EXPECT_EQ(fbuff.read_token(), "x");
+    EXPECT_EQ(fbuff.read_token(), std::nullopt);
+    EXPECT_EQ(errno, 0);
+}
+
+// NOLINTNEXTLINE
+TEST(fd_pread_buff, read_error) {
+    BasicFdPreadBuff<8> fbuff{-1};
+    EXPECT_EQ(fbuff.read_line(), std::nullopt);
+    EXPECT_EQ(errno, EBADF);
+    EXPECT_EQ(fbuff.read_token(), std::nullopt);
+    EXPECT_EQ(errno, EBADF);
+    EXPECT_EQ(fbuff.skip_until('\n'), std::nullopt);
+    EXPECT_EQ(errno, EBADF);
+}
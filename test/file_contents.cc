@@ -1,6 +1,27 @@
 #include "simlib/file_contents.hh"
+#include "simlib/file_descriptor.hh"
+#include "simlib/opened_temporary_file.hh"
+#include "simlib/random.hh"
 
+#include <climits>
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Splits @p data into many buffers of random sizes (some of them empty)
+static vector<iovec> split_into_iovecs(string& data) {
+    vector<iovec> iov;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t len = std::min(get_random<size_t>(0, 100), data.size() - pos);
+        iov.push_back({data.data() + pos, len});
+        pos += len;
+    }
+    return iov;
+}
 
 // NOLINTNEXTLINE
 TEST(DISABLED_file_contents, read_all) { // TODO:
@@ -10,10 +31,84 @@ TEST(DISABLED_file_contents, read_all) { // TODO:
 TEST(DISABLED_file_contents, pread_all) { // TODO:
 }
 
+// NOLINTNEXTLINE
+TEST(file_contents, readv_all) {
+    int pfd[2];
+    ASSERT_EQ(pipe2(pfd, O_CLOEXEC), 0);
+    FileDescriptor rfd(pfd[0]);
+    FileDescriptor wfd(pfd[1]);
+
+    string data(1 << 18, 0);
+    fill_randomly(data.data(), data.size());
+    // Writing in small chunks makes reads partial
+    std::thread writer([&] {
+        for (size_t pos = 0; pos < data.size(); pos += 1000) {
+            write_all_throw(wfd, StringView(data).substring(pos, pos + 1000));
+        }
+        (void)wfd.close();
+    });
+
+    string buff(data.size() + 10, 0);
+    auto iov = split_into_iovecs(buff);
+    ASSERT_GT(iov.size(), IOV_MAX);
+    EXPECT_EQ(readv_all(rfd, iov.data(), iov.size()), data.size());
+    EXPECT_EQ(errno, 0);
+    writer.join();
+    EXPECT_EQ(StringView(buff).substring(0, data.size()), data);
+}
+
+// NOLINTNEXTLINE
+TEST(file_contents, preadv_all) {
+    OpenedTemporaryFile tmp_file("/tmp/file_contents.test.XXXXXX");
+    string data(1 << 16, 0);
+    fill_randomly(data.data(), data.size());
+    write_all_throw(tmp_file, data);
+
+    string buff(data.size(), 0);
+    auto iov = split_into_iovecs(buff);
+    EXPECT_EQ(preadv_all(tmp_file, 0, iov.data(), iov.size()), data.size());
+    EXPECT_EQ(errno, 0);
+    EXPECT_EQ(buff, data);
+
+    // Reading past EOF
+    buff.assign(100, '\0');
+    iov = split_into_iovecs(buff);
+    EXPECT_EQ(preadv_all(tmp_file, data.size() - 10, iov.data(), iov.size()), 10);
+    EXPECT_EQ(errno, 0);
+    EXPECT_EQ(StringView(buff).substring(0, 10), StringView(data).substring(data.size() - 10));
+    EXPECT_EQ(lseek(tmp_file, 0, SEEK_CUR), data.size());
+}
+
 // NOLINTNEXTLINE
 TEST(DISABLED_file_contents, write_all) { // TODO:
 }
 
+// NOLINTNEXTLINE
+TEST(file_contents, writev_all) {
+    int pfd[2];
+    ASSERT_EQ(pipe2(pfd, O_CLOEXEC), 0);
+    FileDescriptor rfd(pfd[0]);
+    FileDescriptor wfd(pfd[1]);
+
+    // Data is much bigger than the pipe capacity, so writes are partial
+    string data(1 << 20, 0);
+    fill_randomly(data.data(), data.size());
+    string received;
+    std::thread reader([&] { received = get_file_contents(rfd); });
+
+    string to_write = data;
+    auto iov = split_into_iovecs(to_write);
+    ASSERT_GT(iov.size(), IOV_MAX);
+    EXPECT_EQ(writev_all(wfd, iov.data(), iov.size()), data.size());
+    EXPECT_EQ(errno, 0);
+    (void)wfd.close();
+    reader.join();
+    EXPECT_EQ(received, data);
+
+    // Nothing to write
+    EXPECT_EQ(writev_all(STDOUT_FILENO, nullptr, 0), 0);
+}
+
 // NOLINTNEXTLINE
 TEST(DISABLED_file_contents, write_all_throw) { // TODO:
 }
@@ -10,7 +10,9 @@
 #include "simlib/temporary_directory.hh"
 #include "test/get_file_permissions.hh"
 
+#include <future>
 #include <gtest/gtest.h>
+#include <thread>
 
 using std::max;
 using std::string;
@@ -133,6 +135,44 @@ TEST(file_manip, blast) {
     EXPECT_EQ(get_file_size(b.path()), data.size());
 }
 
+// NOLINTNEXTLINE
+TEST(file_manip, blast_from_and_to_pipe) {
+    OpenedTemporaryFile a("/tmp/filesystem-test.XXXXXX");
+    OpenedTemporaryFile b("/tmp/filesystem-test.XXXXXX");
+
+    string data = some_random_data(1 << 14);
+    write_all_throw(a, data);
+    EXPECT_EQ(lseek(a, 100, SEEK_SET), 100);
+
+    std::array<int, 2> pfd{};
+    ASSERT_EQ(pipe2(pfd.data(), O_CLOEXEC), 0);
+    FileDescriptor pipe_in{pfd[0]};
+    FileDescriptor pipe_out{pfd[1]};
+    // File -> pipe
+    EXPECT_EQ(blast(a, pipe_out), 0);
+    EXPECT_EQ(lseek(a, 0, SEEK_CUR), data.size());
+    (void)pipe_out.close();
+    // Pipe -> file
+    EXPECT_EQ(blast(pipe_in, b), 0);
+    EXPECT_EQ(lseek(b, 0, SEEK_CUR), data.size() - 100);
+    EXPECT_TRUE(get_file_contents(b.path()) == data.substr(100));
+
+    // File -> file starting at the beginning of both files
+    OpenedTemporaryFile c("/tmp/filesystem-test.XXXXXX");
+    EXPECT_EQ(lseek(a, 0, SEEK_SET), 0);
+    EXPECT_EQ(blast(a, c), 0);
+    EXPECT_EQ(lseek(a, 0, SEEK_CUR), data.size());
+    EXPECT_EQ(lseek(c, 0, SEEK_CUR), data.size());
+    EXPECT_TRUE(get_file_contents(c.path()) == data);
+
+    // Special files reporting zero size
+    OpenedTemporaryFile d("/tmp/filesystem-test.XXXXXX");
+    FileDescriptor stat_fd{"/proc/self/stat", O_RDONLY | O_CLOEXEC};
+    ASSERT_TRUE(stat_fd.is_open());
+    EXPECT_EQ(blast(stat_fd, d), 0);
+    EXPECT_LT(0, get_file_size(d.path()));
+}
+
 void copy_test(void (*copy_fn)(FilePath, FilePath, mode_t)) {
     TemporaryDirectory tmp_dir("/tmp/filesystem-test.XXXXXX");
     OpenedTemporaryFile a("/tmp/filesystem-test.XXXXXX");
@@ -218,7 +258,22 @@ TEST(file_manip, copy_using_rename) {
 TEST(file_manip, thread_fork_safe_copy) { copy_test(::thread_fork_safe_copy); }
 
 // NOLINTNEXTLINE
-TEST(file_manip, copy_r) {
+TEST(file_manip, thread_fork_safe_copy_multithreaded) {
+    std::promise<void> finish;
+    std::thread other_thread([fut = finish.get_future()] { fut.wait(); });
+    copy_test(::thread_fork_safe_copy);
+
+    TemporaryDirectory tmp_dir("/tmp/filesystem-test.XXXXXX");
+    EXPECT_THROW(
+        thread_fork_safe_copy(
+            concat(tmp_dir.path(), "nonexistent"), concat(tmp_dir.path(), "x"), S_0644),
+        std::runtime_error);
+
+    finish.set_value();
+    other_thread.join();
+}
+
+static void copy_r_test(int (*copy_r_fn)(FilePath, FilePath, bool)) {
     TemporaryDirectory tmp_dir("/tmp/filesystem-test.XXXXXX");
 
     struct FileInfo {
@@ -337,7 +392,7 @@ TEST(file_manip, copy_r) {
     {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         auto dest_path = concat(dest_dir.path(), "dest/dir");
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path), 0);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, true), 0);
         check_equality(dump_files(dest_path), orig_files_slice("dir/"), __LINE__);
     }
 
@@ -345,7 +400,7 @@ TEST(file_manip, copy_r) {
     {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         auto dest_path = concat(dest_dir.path(), "dest");
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path), 0);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, true), 0);
         check_equality(dump_files(dest_path), orig_files_slice("dir/"), __LINE__);
     }
 
@@ -353,7 +408,7 @@ TEST(file_manip, copy_r) {
     {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         const auto& dest_path = dest_dir.path();
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path), 0);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, true), 0);
         check_equality(dump_files(dest_path), orig_files_slice("dir/"), __LINE__);
     }
 
@@ -361,7 +416,7 @@ TEST(file_manip, copy_r) {
     {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         const auto& dest_path = dest_dir.path();
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path, false), 0);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, false), 0);
         check_equality(dump_files(dest_path), orig_files_slice("dir/"), __LINE__);
     }
 
@@ -369,7 +424,7 @@ TEST(file_manip, copy_r) {
     {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         auto dest_path = concat(dest_dir.path(), "dest/");
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path, false), 0);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, false), 0);
         check_equality(dump_files(dest_path), orig_files_slice("dir/"), __LINE__);
     }
 
@@ -378,12 +433,52 @@ TEST(file_manip, copy_r) {
         TemporaryDirectory dest_dir("/tmp/filesystem-test.XXXXXX");
         auto dest_path = concat(dest_dir.path(), "dest/dir");
         errno = 0;
-        EXPECT_EQ(copy_r(concat(tmp_dir.path(), "dir"), dest_path, false), -1);
+        EXPECT_EQ(copy_r_fn(concat(tmp_dir.path(), "dir"), dest_path, false), -1);
         EXPECT_EQ(errno, ENOENT);
         EXPECT_FALSE(path_exists(dest_path));
     }
 }
 
+// NOLINTNEXTLINE
+TEST(file_manip, copy_r) { copy_r_test(::copy_r); }
+
+// NOLINTNEXTLINE
+TEST(file_manip, copy_r_parallel) {
+    copy_r_test([](FilePath src, FilePath dest, bool create_subdirs) {
+        return copy_r_parallel(src, dest, create_subdirs, 4);
+    });
+}
+
+// NOLINTNEXTLINE
+TEST(file_manip, remove_r_parallel) {
+    TemporaryDirectory tmp_dir("/tmp/filesystem-test.XXXXXX");
+    auto root = concat_tostr(tmp_dir.path(), "root");
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            auto dir = concat_tostr(root, '/', i, "/sub", j, '/');
+            EXPECT_EQ(mkdir_r(dir), 0);
+            for (int k = 0; k < 100; ++k) {
+                EXPECT_EQ(create_file(concat(dir, k)), 0);
+            }
+        }
+        EXPECT_EQ(create_file(concat(root, '/', i, "/file")), 0);
+        EXPECT_EQ(mkdir(concat(root, '/', i, "/empty")), 0);
+    }
+
+    EXPECT_EQ(remove_r_parallel(root, 4), 0);
+    EXPECT_FALSE(path_exists(root));
+    for_each_dir_component(tmp_dir.path(), [](dirent* f) { ADD_FAILURE() << f->d_name; });
+
+    // Removing a file
+    EXPECT_EQ(create_file(root), 0);
+    EXPECT_EQ(remove_r_parallel(root), 0);
+    EXPECT_FALSE(path_exists(root));
+
+    errno = 0;
+    EXPECT_EQ(remove_r_parallel(root), -1);
+    EXPECT_EQ(errno, ENOENT);
+}
+
 // NOLINTNEXTLINE
 TEST(DISABLED_file_manip, move) { // TODO:
 }
@@ -0,0 +1,99 @@
+#include "simlib/file_contents.hh"
+#include "simlib/hash_file.hh"
+#include "simlib/murmur_hash.hh"
+#include "simlib/opened_temporary_file.hh"
+#include "simlib/random.hh"
+#include "simlib/sha.hh"
+#include "simlib/string_transform.hh"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+using std::string;
+
+template <class Hasher>
+static typename Hasher::Digest hash(StringView str) {
+    Hasher hasher;
+    hasher.update(str);
+    return hasher.digest();
+}
+
+// NOLINTNEXTLINE
+TEST(hash_file, read_file_in_chunks) {
+    OpenedTemporaryFile tmp_file("/tmp/hash_file.test.XXXXXX");
+    for (size_t size : {0, 1, 1000, 1 << 20, (1 << 20) + 1, 3 << 20, (5 << 20) - 7}) {
+        string data(size, '\0');
+        fill_randomly(data.data(), data.size());
+        put_file_contents(tmp_file.path(), data);
+        ASSERT_EQ(lseek(tmp_file, 0, SEEK_SET), 0);
+
+        string read_data;
+        read_file_in_chunks(tmp_file, [&](StringView chunk) {
+            EXPECT_FALSE(chunk.empty());
+            read_data += chunk;
+        });
+        EXPECT_EQ(read_data.size(), data.size());
+        EXPECT_TRUE(read_data == data) << "size: " << size;
+    }
+
+    EXPECT_THROW(read_file_in_chunks(-1, [](StringView /*unused*/) {}), std::runtime_error);
+
+    // Exception thrown by consume() stops reading
+    ASSERT_EQ(lseek(tmp_file, 0, SEEK_SET), 0);
+    int chunks = 0;
+    EXPECT_THROW(
+        read_file_in_chunks(
+            tmp_file,
+            [&](StringView /*unused*/) {
+                if (++chunks == 2) {
+                    throw std::logic_error("stop");
+                }
+            }),
+        std::logic_error);
+    EXPECT_EQ(chunks, 2);
+}
+
+// NOLINTNEXTLINE
+TEST(hash_file, hash_file) {
+    OpenedTemporaryFile tmp_file("/tmp/hash_file.test.XXXXXX");
+    string data((3 << 20) + 12345, '\0');
+    fill_randomly(data.data(), data.size());
+    put_file_contents(tmp_file.path(), data);
+
+    EXPECT_EQ(hash_file<Sha3_256>(tmp_file.path()), hash<Sha3_256>(data));
+    EXPECT_EQ(hash_file<Sha256>(tmp_file.path()), hash<Sha256>(data));
+    EXPECT_EQ(hash_file<Murmur3Hash128>(tmp_file.path()), hash<Murmur3Hash128>(data));
+
+    // From the current offset
+    ASSERT_EQ(lseek(tmp_file, 100, SEEK_SET), 100);
+    EXPECT_EQ(hash_file<Sha3_512>(tmp_file), hash<Sha3_512>(StringView(data).substring(100)));
+
+    EXPECT_THROW(
+        hash_file<Sha3_256>("/tmp/hash_file.test.nonexistent"), std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST(hash_file, hash_file_tree) {
+    OpenedTemporaryFile tmp_file("/tmp/hash_file.test.XXXXXX");
+    constexpr size_t leaf_size = (1 << 20) + 3;
+    for (size_t size : {size_t{0}, size_t{10}, leaf_size, 5 * leaf_size - 1}) {
+        string data(size, '\0');
+        fill_randomly(data.data(), data.size());
+        put_file_contents(tmp_file.path(), data);
+
+        Sha3_256 root;
+        size_t pos = 0;
+        do {
+            auto digest = hash<Sha3_256>(StringView(data).substring(pos, pos + leaf_size));
+            root.update({reinterpret_cast<const char*>(digest.data()), digest.size()});
+            pos += leaf_size;
+        } while (pos < size);
+        auto expected = root.digest();
+
+        for (unsigned threads_num : {0, 1, 3}) {
+            EXPECT_EQ(hash_file_tree<Sha3_256>(tmp_file, leaf_size, threads_num), expected)
+                << "size: " << size << " threads_num: " << threads_num;
+        }
+    }
+}
@@ -1,6 +1,65 @@
 #include "simlib/inplace_array.hh"
 
+#include <array>
+#include <cstddef>
 #include <gtest/gtest.h>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Counts the live objects, to detect leaked or doubly destroyed elements
+struct Counted {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+    static inline int alive = 0;
+
+    string val;
+
+    Counted()
+    : Counted("") {}
+
+    explicit Counted(string v)
+    : val(std::move(v)) {
+        ++alive;
+    }
+
+    Counted(const Counted& other)
+    : val(other.val) {
+        ++alive;
+    }
+
+    Counted(Counted&& other) noexcept
+    : val(std::move(other.val)) {
+        ++alive;
+    }
+
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&&) = default;
+
+    ~Counted() { --alive; }
+};
+
+template <size_t N, class Alloc>
+vector<string> values(const InplaceArray<Counted, N, Alloc>& arr) {
+    vector<string> res;
+    for (const auto& x : arr) {
+        res.emplace_back(x.val);
+    }
+    return res;
+}
+
+template <class Arr>
+void fill(Arr& arr, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        arr.emplace_back(string(20, static_cast<char>('a' + i % 26)));
+    }
+}
+
+} // namespace
 
 // NOLINTNEXTLINE
 TEST(DISABLED_InplaceArray, default_constructor) {
@@ -13,13 +72,23 @@ TEST(DISABLED_InplaceArray, constructor_with_size) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, constructor_with_size_and_value) {
-    // TODO: implement it
+TEST(InplaceArray, constructor_with_size_and_value) {
+    InplaceArray<int, 4> small(3, 7);
+    EXPECT_EQ(vector<int>(small.begin(), small.end()), (vector<int>{7, 7, 7}));
+    InplaceArray<int, 4> big(6, 7);
+    EXPECT_EQ(vector<int>(big.begin(), big.end()), vector<int>(6, 7));
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, copy_constructor) {
-    // TODO: implement it
+TEST(InplaceArray, copy_constructor) {
+    for (size_t n : {0, 2, 3, 7}) {
+        InplaceArray<Counted, 3> arr;
+        fill(arr, n);
+        InplaceArray<Counted, 3> copy(arr);
+        EXPECT_EQ(values(copy), values(arr));
+        EXPECT_EQ(Counted::alive, 2 * n);
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
@@ -28,18 +97,47 @@ TEST(DISABLED_InplaceArray, template_copy_constructor) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, move_constructor) {
-    // TODO: implement it
+TEST(InplaceArray, move_constructor) {
+    for (size_t n : {0, 2, 3, 7}) {
+        InplaceArray<Counted, 3> arr;
+        fill(arr, n);
+        auto expected = values(arr);
+        InplaceArray<Counted, 3> moved(std::move(arr));
+        EXPECT_EQ(values(moved), expected);
+        EXPECT_EQ(arr.size(), 0); // NOLINT(bugprone-use-after-move)
+        EXPECT_EQ(Counted::alive, n);
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, template_move_constructor) {
-    // TODO: implement it
+TEST(InplaceArray, template_move_constructor) {
+    for (size_t n : {0, 2, 3, 5, 7}) {
+        InplaceArray<Counted, 5> arr;
+        fill(arr, n);
+        auto expected = values(arr);
+        InplaceArray<Counted, 3> moved(std::move(arr));
+        EXPECT_EQ(values(moved), expected);
+        EXPECT_EQ(arr.size(), 0); // NOLINT(bugprone-use-after-move)
+        EXPECT_EQ(Counted::alive, n);
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, copy_assignment) {
-    // TODO: implement it
+TEST(InplaceArray, copy_assignment) {
+    for (size_t n : {0, 2, 3, 7}) {
+        for (size_t m : {0, 1, 3, 5, 9}) {
+            InplaceArray<Counted, 3> arr;
+            InplaceArray<Counted, 3> other;
+            fill(arr, n);
+            fill(other, m);
+            other = arr;
+            EXPECT_EQ(values(other), values(arr));
+            EXPECT_EQ(Counted::alive, 2 * n);
+        }
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
@@ -48,8 +146,20 @@ TEST(DISABLED_InplaceArray, template_copy_assignment) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, move_assignment) {
-    // TODO: implement it
+TEST(InplaceArray, move_assignment) {
+    for (size_t n : {0, 2, 3, 7}) {
+        for (size_t m : {0, 1, 3, 5, 9}) {
+            InplaceArray<Counted, 3> arr;
+            InplaceArray<Counted, 3> other;
+            fill(arr, n);
+            fill(other, m);
+            auto expected = values(arr);
+            other = std::move(arr);
+            EXPECT_EQ(values(other), expected);
+            EXPECT_EQ(Counted::alive, n);
+        }
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
@@ -63,28 +173,81 @@ TEST(DISABLED_InplaceArray, lossy_reserve_for) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, reserve_for) {
-    // TODO: implement it
+TEST(InplaceArray, reserve_for) {
+    InplaceArray<Counted, 2> arr;
+    fill(arr, 2);
+    auto expected = values(arr);
+    arr.reserve_for(100);
+    EXPECT_GE(arr.max_size(), 100);
+    EXPECT_EQ(values(arr), expected);
+    EXPECT_EQ(Counted::alive, 2);
+
+    InplaceArray<int, 2> ints;
+    for (int i = 0; i < 1000; ++i) {
+        ints.emplace_back(i);
+        ints.reserve_for(ints.size() + 1);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(ints[i], i);
+    }
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, resize) {
-    // TODO: implement it
+TEST(InplaceArray, resize) {
+    {
+        InplaceArray<Counted, 2> arr;
+        fill(arr, 5);
+        arr.resize(1);
+        EXPECT_EQ(arr.size(), 1);
+        EXPECT_EQ(Counted::alive, 1);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+
+    InplaceArray<string, 2> strs;
+    strs.emplace_back("abc");
+    strs.resize(5);
+    EXPECT_EQ(
+        vector<string>(strs.begin(), strs.end()), (vector<string>{"abc", "", "", "", ""}));
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, resize_with_value) {
-    // TODO: implement it
+TEST(InplaceArray, resize_with_value) {
+    InplaceArray<int, 2> arr;
+    arr.emplace_back(1);
+    arr.resize(4, 9);
+    EXPECT_EQ(vector<int>(arr.begin(), arr.end()), (vector<int>{1, 9, 9, 9}));
+    arr.resize(2, 5);
+    EXPECT_EQ(vector<int>(arr.begin(), arr.end()), (vector<int>{1, 9}));
+    // The value may be an element of the array itself
+    arr.resize(10, arr[1]);
+    EXPECT_EQ(
+        vector<int>(arr.begin(), arr.end()), (vector<int>{1, 9, 9, 9, 9, 9, 9, 9, 9, 9}));
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, emplace_back) {
-    // TODO: implement it
+TEST(InplaceArray, emplace_back) {
+    {
+        InplaceArray<Counted, 1> arr;
+        arr.emplace_back("first element that does not fit in SSO");
+        for (int i = 0; i < 10; ++i) {
+            // The argument refers to an element that is relocated on growth
+            arr.emplace_back(arr.front());
+        }
+        EXPECT_EQ(arr.size(), 11);
+        for (const auto& x : arr) {
+            EXPECT_EQ(x.val, "first element that does not fit in SSO");
+        }
+    }
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_InplaceArray, clear) {
-    // TODO: implement it
+TEST(InplaceArray, clear) {
+    InplaceArray<Counted, 2> arr;
+    fill(arr, 4);
+    arr.clear();
+    EXPECT_EQ(arr.size(), 0);
+    EXPECT_EQ(Counted::alive, 0);
 }
 
 // NOLINTNEXTLINE
@@ -211,3 +374,22 @@ TEST(DISABLED_InplaceArray, back) {
 TEST(DISABLED_InplaceArray, operator_subscript) {
     // TODO: implement it
 }
+
+// NOLINTNEXTLINE
+TEST(InplaceArray, pmr_allocator) {
+    std::array<std::byte, 1024> buff{};
+    std::pmr::monotonic_buffer_resource arena(
+        buff.data(), buff.size(), std::pmr::null_memory_resource());
+    using Arr = InplaceArray<int, 2, std::pmr::polymorphic_allocator<int>>;
+    Arr arr(&arena);
+    for (int i = 0; i < 100; ++i) {
+        arr.emplace_back(i);
+    }
+    EXPECT_EQ(arr.get_allocator().resource(), &arena);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(arr[i], i);
+    }
+    Arr moved(std::move(arr));
+    EXPECT_EQ(moved.size(), 100);
+    EXPECT_EQ(moved.back(), 99);
+}
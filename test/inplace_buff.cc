@@ -2,9 +2,11 @@
 #include "simlib/random.hh"
 #include "simlib/string_view.hh"
 
+#include <array>
 #include <cstddef>
 #include <gtest/gtest.h>
 #include <limits>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <utility>
@@ -187,6 +189,34 @@ TEST(InplaceBuff, constructors_and_assignments) {
     test_constructors_and_assignments<11, 11>(11, 11);
 }
 
+// NOLINTNEXTLINE
+TEST(InplaceBuff, memory_resource) {
+    std::array<std::byte, 1024> arena_buff{};
+    std::pmr::monotonic_buffer_resource arena(
+        arena_buff.data(), arena_buff.size(), std::pmr::null_memory_resource());
+
+    InplaceBuff<4> ibuff(&arena);
+    EXPECT_EQ(ibuff.resource(), &arena);
+    ibuff.append("0123456789", "abcdefghij");
+    EXPECT_EQ(StringView{ibuff}, "0123456789abcdefghij");
+    EXPECT_GE(static_cast<const void*>(ibuff.data()), arena_buff.data());
+    EXPECT_LT(static_cast<const void*>(ibuff.data()), arena_buff.data() + arena_buff.size());
+
+    // Moving steals the memory together with its resource
+    auto* data = ibuff.data();
+    InplaceBuff<4> moved(std::move(ibuff));
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_EQ(moved.resource(), &arena);
+    EXPECT_EQ(StringView{moved}, "0123456789abcdefghij");
+
+    // Memory from a different resource cannot be stolen
+    InplaceBuff<4> other;
+    other = std::move(moved);
+    EXPECT_EQ(other.resource(), nullptr);
+    EXPECT_NE(other.data(), data);
+    EXPECT_EQ(StringView{other}, "0123456789abcdefghij");
+}
+
 // NOLINTNEXTLINE
 TEST(DISABLED_InplaceBuff, size) {
     // TODO: implement it
@@ -0,0 +1,98 @@
+#include "simlib/file_contents.hh"
+#include "simlib/mapped_file.hh"
+#include "simlib/opened_temporary_file.hh"
+#include "simlib/random.hh"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+
+using std::string;
+
+// NOLINTNEXTLINE
+TEST(mapped_file, map_file_contents) {
+    OpenedTemporaryFile tmp_file{"/tmp/mapped_file.test.XXXXXX"};
+    string data(100000, 0);
+    fill_randomly(data.data(), data.size());
+    put_file_contents(tmp_file.path(), data);
+
+    auto mf = map_file_contents(tmp_file.path());
+    EXPECT_TRUE(mf.is_mapped());
+    EXPECT_EQ(mf.contents(), data);
+    EXPECT_EQ(mf.size(), data.size());
+
+    auto size = static_cast<off64_t>(data.size());
+    for (auto [beg, end] : std::initializer_list<std::pair<off64_t, off64_t>>{
+             {0, -1},
+             {1, 2},
+             {4095, 4097},
+             {4096, 8192},
+             {5000, size + 10},
+             {-100, -1},
+             {-size - 10, 7},
+             {size, -1},
+             {size + 1, -1},
+             {50, 40},
+         })
+    {
+        auto expected = get_file_contents(tmp_file, beg, end);
+        EXPECT_EQ(map_file_contents(tmp_file, beg, end).contents(), expected)
+            << "beg: " << beg << " end: " << end;
+        EXPECT_EQ(map_file_contents(tmp_file.path(), beg, end).contents(), expected)
+            << "beg: " << beg << " end: " << end;
+    }
+
+    // Moving preserves the contents
+    MappedFile mf2 = std::move(mf);
+    EXPECT_EQ(mf2.contents(), data);
+    EXPECT_EQ(mf.contents(), "");
+    mf = std::move(mf2);
+    EXPECT_EQ(mf.contents(), data);
+}
+
+// NOLINTNEXTLINE
+TEST(mapped_file, empty_file) {
+    OpenedTemporaryFile tmp_file{"/tmp/mapped_file.test.XXXXXX"};
+    auto mf = map_file_contents(tmp_file);
+    EXPECT_FALSE(mf.is_mapped());
+    EXPECT_EQ(mf.contents(), "");
+}
+
+// NOLINTNEXTLINE
+TEST(mapped_file, pipe) {
+    int pfd[2];
+    ASSERT_EQ(pipe2(pfd, O_CLOEXEC), 0);
+    FileDescriptor rfd(pfd[0]);
+    FileDescriptor wfd(pfd[1]);
+
+    string data(200000, 0);
+    fill_randomly(data.data(), data.size());
+    std::thread writer([&] {
+        write_all_throw(wfd, data);
+        (void)wfd.close();
+    });
+
+    auto mf = map_file_contents(rfd, 10, -1);
+    writer.join();
+    EXPECT_FALSE(mf.is_mapped());
+    EXPECT_EQ(mf.contents(), data.substr(10));
+
+    // Small contents are stored inline in std::string, so moving has to keep
+    // the contents valid
+    ASSERT_EQ(pipe2(pfd, O_CLOEXEC), 0);
+    rfd = pfd[0];
+    wfd = pfd[1];
+    write_all_throw(wfd, "abc");
+    (void)wfd.close();
+    MappedFile mf2 = map_file_contents(rfd);
+    mf = std::move(mf2);
+    EXPECT_EQ(mf.contents(), "abc");
+}
+
+// NOLINTNEXTLINE
+TEST(mapped_file, procfs) {
+    auto mf = map_file_contents("/proc/self/stat");
+    EXPECT_FALSE(mf.is_mapped());
+    auto prefix = concat(getpid(), " (");
+    EXPECT_TRUE(has_prefix(mf.contents(), prefix));
+}
@@ -0,0 +1,63 @@
+#include "simlib/file_contents.hh"
+#include "simlib/memfd.hh"
+#include "simlib/opened_temporary_file.hh"
+#include "simlib/random.hh"
+#include "simlib/spawner.hh"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+
+// NOLINTNEXTLINE
+TEST(memfd, seal_memfd) {
+    FileDescriptor fd = open_memfd("test");
+    ASSERT_TRUE(fd.is_open());
+    std::string data(1 << 14, 0);
+    fill_randomly(data.data(), data.size());
+    write_all_throw(fd, data);
+
+    FileDescriptor sealed = seal_memfd(fd);
+    ASSERT_TRUE(sealed.is_open());
+    EXPECT_EQ(get_file_contents(sealed), data);
+    EXPECT_EQ(get_file_contents(fd_path(sealed)), data);
+
+    // No modification is possible, even through the original fd
+    EXPECT_EQ(write(sealed, "x", 1), -1);
+    EXPECT_EQ(write(fd, "x", 1), -1);
+    EXPECT_EQ(errno, EPERM);
+    EXPECT_EQ(ftruncate(fd, 0), -1);
+    EXPECT_EQ(errno, EPERM);
+    EXPECT_EQ(get_file_contents(fd_path(sealed)), data);
+}
+
+// NOLINTNEXTLINE
+TEST(memfd, copy_to_sealed_memfd) {
+    OpenedTemporaryFile tmp_file{"/tmp/memfd.test.XXXXXX"};
+    std::string data(1 << 18, 0);
+    fill_randomly(data.data(), data.size());
+    put_file_contents(tmp_file.path(), data);
+
+    FileDescriptor fd = copy_to_sealed_memfd(tmp_file.path(), "test");
+    ASSERT_TRUE(fd.is_open());
+    EXPECT_EQ(get_file_contents(fd), data);
+    EXPECT_EQ(fcntl(fd, F_GETFL) & O_ACCMODE, O_RDONLY);
+    EXPECT_NE(fcntl(fd, F_GETFD) & FD_CLOEXEC, 0);
+
+    EXPECT_FALSE(copy_to_sealed_memfd("/tmp/memfd.test.nonexistent", "test").is_open());
+    EXPECT_EQ(errno, ENOENT);
+}
+
+// NOLINTNEXTLINE
+TEST(memfd, execute_sealed_memfd) {
+    for (auto [program, exit_status] : {std::pair{"/bin/true", 0}, {"/bin/false", 1}}) {
+        FileDescriptor fd = copy_to_sealed_memfd(program, "program");
+        ASSERT_TRUE(fd.is_open());
+
+        Spawner::Options opts;
+        opts.exec_fd = fd;
+        auto es = Spawner::run(program, {program}, opts);
+        EXPECT_EQ(es.si.code, CLD_EXITED);
+        EXPECT_EQ(es.si.status, exit_status);
+    }
+}
@@ -0,0 +1,143 @@
+#include "simlib/metrics.hh"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using std::string;
+
+namespace {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Counter test_counter{"test_metrics_counter_total", "Test counter"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Gauge test_gauge{"test_metrics_gauge", "Test gauge\nwith \\ escaping"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::Histogram test_histogram{"test_metrics_histogram", "Test histogram"};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+metrics::DurationHistogram test_duration_histogram{
+    "test_metrics_duration_seconds", "Test duration histogram"};
+
+// Returns lines of the rendered metrics that start with @p prefix
+string rendered_lines_with_prefix(const string& prefix) {
+    auto rendered = metrics::render_prometheus();
+    string res;
+    size_t beg = 0;
+    while (beg < rendered.size()) {
+        auto end = rendered.find('\n', beg);
+        if (rendered.compare(beg, prefix.size(), prefix) == 0) {
+            res.append(rendered, beg, end + 1 - beg);
+        }
+        beg = end + 1;
+    }
+    return res;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(metrics, counter) {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 1000; ++j) {
+                test_counter.inc();
+            }
+            test_counter.inc(10);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(test_counter.value(), 8 * 1010);
+    EXPECT_EQ(
+        rendered_lines_with_prefix("test_metrics_counter_total"),
+        "test_metrics_counter_total 8080\n");
+}
+
+// NOLINTNEXTLINE
+TEST(metrics, gauge) {
+    test_gauge.set(5);
+    test_gauge.inc();
+    test_gauge.add(4);
+    test_gauge.sub(12);
+    test_gauge.dec();
+    EXPECT_EQ(test_gauge.value(), -3);
+    EXPECT_EQ(rendered_lines_with_prefix("test_metrics_gauge"), "test_metrics_gauge -3\n");
+    EXPECT_EQ(
+        rendered_lines_with_prefix("# HELP test_metrics_gauge"),
+        "# HELP test_metrics_gauge Test gauge\\nwith \\\\ escaping\n");
+    EXPECT_EQ(
+        rendered_lines_with_prefix("# TYPE test_metrics_gauge"),
+        "# TYPE test_metrics_gauge gauge\n");
+}
+
+// NOLINTNEXTLINE
+TEST(metrics, histogram_buckets) {
+    using H = metrics::Histogram;
+    for (uint64_t val :
+         {0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 7ULL, 8ULL, 9ULL, 1000ULL, 123456789ULL, ~0ULL})
+    {
+        auto bucket = H::bucket_of(val);
+        ASSERT_LT(bucket, H::BUCKETS) << val;
+        EXPECT_LE(val, H::bucket_upper_bound(bucket)) << val;
+        if (bucket > 0) {
+            EXPECT_GT(val, H::bucket_upper_bound(bucket - 1)) << val;
+        }
+    }
+    EXPECT_EQ(H::bucket_upper_bound(H::BUCKETS - 1), ~0ULL);
+    for (size_t i = 1; i < H::BUCKETS; ++i) {
+        EXPECT_EQ(H::bucket_of(H::bucket_upper_bound(i)), i);
+        EXPECT_EQ(H::bucket_of(H::bucket_upper_bound(i - 1) + 1), i);
+        // Relative width of a bucket is bounded
+        auto lower = H::bucket_upper_bound(i - 1) + 1;
+        EXPECT_LE((H::bucket_upper_bound(i) - lower) / H::SUB_BUCKETS, lower);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(metrics, histogram) {
+    for (uint64_t val : {2, 2, 5, 100}) {
+        test_histogram.observe(val);
+    }
+    auto snap = test_histogram.snapshot();
+    EXPECT_EQ(snap.count, 4);
+    EXPECT_EQ(snap.sum, 109);
+    EXPECT_EQ(
+        rendered_lines_with_prefix("test_metrics_histogram"),
+        "test_metrics_histogram_bucket{le=\"2\"} 2\n"
+        "test_metrics_histogram_bucket{le=\"5\"} 3\n"
+        "test_metrics_histogram_bucket{le=\"111\"} 4\n"
+        "test_metrics_histogram_bucket{le=\"+Inf\"} 4\n"
+        "test_metrics_histogram_sum 109\n"
+        "test_metrics_histogram_count 4\n");
+}
+
+// NOLINTNEXTLINE
+TEST(metrics, duration_histogram) {
+    test_duration_histogram.observe(std::chrono::nanoseconds(3));
+    test_duration_histogram.observe(std::chrono::milliseconds(1500));
+    test_duration_histogram.observe(std::chrono::nanoseconds(-1));
+    EXPECT_EQ(
+        rendered_lines_with_prefix("test_metrics_duration_seconds"),
+        "test_metrics_duration_seconds_bucket{le=\"0\"} 1\n"
+        "test_metrics_duration_seconds_bucket{le=\"0.000000003\"} 2\n"
+        "test_metrics_duration_seconds_bucket{le=\"1.610612735\"} 3\n"
+        "test_metrics_duration_seconds_bucket{le=\"+Inf\"} 3\n"
+        "test_metrics_duration_seconds_sum 1.500000003\n"
+        "test_metrics_duration_seconds_count 3\n");
+}
+
+// NOLINTNEXTLINE
+TEST(metrics, render_prometheus_is_sorted_by_name) {
+    auto rendered = metrics::render_prometheus();
+    auto counter_pos = rendered.find("# HELP test_metrics_counter_total ");
+    auto duration_pos = rendered.find("# HELP test_metrics_duration_seconds ");
+    auto gauge_pos = rendered.find("# HELP test_metrics_gauge ");
+    auto histogram_pos = rendered.find("# HELP test_metrics_histogram ");
+    ASSERT_NE(counter_pos, string::npos);
+    EXPECT_LT(counter_pos, duration_pos);
+    EXPECT_LT(duration_pos, gauge_pos);
+    EXPECT_LT(gauge_pos, histogram_pos);
+    EXPECT_NE(histogram_pos, string::npos);
+}
@@ -0,0 +1,39 @@
+#include "simlib/murmur_hash.hh"
+#include "simlib/random.hh"
+
+#include <gtest/gtest.h>
+#include <string>
+
+// NOLINTNEXTLINE
+TEST(murmur_hash, murmur3_128) {
+    EXPECT_EQ(murmur3_128(""), "00000000000000000000000000000000");
+    EXPECT_EQ(murmur3_128("hello"), "029bbd41b3a7d8cb191dae486a901e5b");
+    EXPECT_EQ(
+        murmur3_128("The quick brown fox jumps over the lazy dog"),
+        "6c1b07bc7bbc4be347939ac4a93c437a");
+    EXPECT_NE(murmur3_128("hello", 1), murmur3_128("hello"));
+}
+
+// NOLINTNEXTLINE
+TEST(murmur_hash, Murmur3Hash128) {
+    std::string data(1000, '\0');
+    fill_randomly(data.data(), data.size());
+    for (size_t len = 0; len <= 40; ++len) {
+        auto expected = murmur3_128_digest(StringView(data).substring(0, len));
+        for (size_t chunk_len : {1, 3, 15, 16, 17}) {
+            Murmur3Hash128 hash;
+            for (size_t pos = 0; pos < len; pos += chunk_len) {
+                hash.update(StringView(data).substring(pos, std::min(pos + chunk_len, len)));
+            }
+            EXPECT_EQ(hash.digest(), expected)
+                << "len: " << len << " chunk_len: " << chunk_len;
+        }
+    }
+
+    // digest() does not finish hashing
+    Murmur3Hash128 hash;
+    hash.update("abc");
+    (void)hash.digest();
+    hash.update("def");
+    EXPECT_EQ(hash.digest(), murmur3_128_digest("abcdef"));
+}
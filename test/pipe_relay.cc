@@ -0,0 +1,113 @@
+#include "simlib/pipe_relay.hh"
+#include "simlib/file_contents.hh"
+#include "simlib/pipe.hh"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <thread>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+Pipe make_pipe() {
+    auto p = pipe2(O_CLOEXEC);
+    if (not p) {
+        THROW("pipe2()", errmsg());
+    }
+    return std::move(*p);
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(pipe_relay, relays_data_and_eof) {
+    auto sol_out = make_pipe();
+    auto sol_out_relayed = make_pipe();
+    auto chk_out = make_pipe();
+    auto chk_out_relayed = make_pipe();
+    write_all_throw(sol_out.writable, "abc\n");
+    write_all_throw(chk_out.writable, "xyz");
+    (void)sol_out.writable.close();
+    (void)chk_out.writable.close();
+
+    vector<PipeRelayChannel> channels;
+    channels.push_back(
+        {std::move(sol_out.readable), std::move(sol_out_relayed.writable), "sol"});
+    channels.push_back(
+        {std::move(chk_out.readable), std::move(chk_out_relayed.writable), "chk"});
+    EXPECT_EQ(relay_pipes(channels, 100), "[sol]\nabc\n[chk]\nxyz");
+    for (auto& channel : channels) {
+        EXPECT_EQ(channel.source, -1);
+        EXPECT_EQ(channel.sink, -1);
+    }
+    EXPECT_EQ(get_file_contents(sol_out_relayed.readable), "abc\n");
+    EXPECT_EQ(get_file_contents(chk_out_relayed.readable), "xyz");
+}
+
+// NOLINTNEXTLINE
+TEST(pipe_relay, transcript_truncation) {
+    auto in = make_pipe();
+    auto out = make_pipe();
+    write_all_throw(in.writable, "hello world");
+    (void)in.writable.close();
+
+    vector<PipeRelayChannel> channels;
+    channels.push_back({std::move(in.readable), std::move(out.writable), "x"});
+    EXPECT_EQ(relay_pipes(channels, 5), "[x]\nhello\n[truncated]\n");
+    EXPECT_EQ(get_file_contents(out.readable), "hello world");
+}
+
+// NOLINTNEXTLINE
+TEST(pipe_relay, transcript_of_exactly_max_len_is_not_truncated) {
+    auto in = make_pipe();
+    auto out = make_pipe();
+    write_all_throw(in.writable, "hello");
+    (void)in.writable.close();
+
+    vector<PipeRelayChannel> channels;
+    channels.push_back({std::move(in.readable), std::move(out.writable), "x"});
+    EXPECT_EQ(relay_pipes(channels, 5), "[x]\nhello");
+    EXPECT_EQ(get_file_contents(out.readable), "hello");
+}
+
+// NOLINTNEXTLINE
+TEST(pipe_relay, sink_without_readers_closes_source) {
+    auto in = make_pipe();
+    auto out = make_pipe();
+    (void)out.readable.close();
+
+    vector<PipeRelayChannel> channels;
+    channels.push_back({std::move(in.readable), std::move(out.writable), "x"});
+    EXPECT_EQ(relay_pipes(channels, 100), "");
+    // Writing to the source would raise SIGPIPE now
+    pollfd pfd = {in.writable, 0, 0};
+    ASSERT_EQ(poll(&pfd, 1, 0), 1);
+    EXPECT_TRUE(pfd.revents & POLLERR);
+}
+
+// NOLINTNEXTLINE
+TEST(pipe_relay, data_bigger_than_pipe_capacity) {
+    string data(1 << 20, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+
+    auto in = make_pipe();
+    auto out = make_pipe();
+    vector<PipeRelayChannel> channels;
+    channels.push_back({std::move(in.readable), std::move(out.writable), "x"});
+    std::thread writer([&, writable = std::move(in.writable)] {
+        write_all_throw(writable, data);
+    });
+    string received;
+    std::thread reader([&, readable = std::move(out.readable)] {
+        received = get_file_contents(readable);
+    });
+    EXPECT_EQ(relay_pipes(channels, 100), "[x]\n" + data.substr(0, 100) + "\n[truncated]\n");
+    writer.join();
+    reader.join();
+    EXPECT_EQ(received, data);
+}
@@ -0,0 +1,127 @@
+#include "simlib/proc_sampler.hh"
+#include "simlib/spawner.hh"
+
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using std::chrono_literals::operator""ms;
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, read_statm_and_sample) {
+    ProcSampler sampler(getpid());
+    auto page_size = sysconf(_SC_PAGESIZE);
+    auto statm = sampler.read_statm();
+    auto sample = sampler.sample();
+    EXPECT_GT(statm.vm_size, 0);
+    EXPECT_GT(statm.rss, 0);
+    EXPECT_EQ(sample.time, 0ms);
+    EXPECT_GT(sample.vm_size, 0);
+    EXPECT_GT(sample.rss, 0);
+    EXPECT_GE(sample.threads, 1);
+
+    constexpr size_t MEM_SIZE = 64 << 20;
+    auto mem = std::make_unique<char[]>(MEM_SIZE);
+    std::memset(mem.get(), 1, MEM_SIZE);
+    auto statm2 = sampler.read_statm();
+    EXPECT_GE((statm2.vm_size - statm.vm_size) * page_size, MEM_SIZE);
+    EXPECT_GE((statm2.rss - statm.rss) * page_size, MEM_SIZE);
+
+    auto sample2 = sampler.sample();
+    EXPECT_GE(sample2.vm_size - sample.vm_size, MEM_SIZE);
+    EXPECT_GE(sample2.rss - sample.rss, MEM_SIZE);
+    EXPECT_GE(sample2.utime + sample2.stime, sample.utime + sample.stime);
+
+    std::thread thread([&] { EXPECT_EQ(sampler.sample().threads, sample.threads + 1); });
+    thread.join();
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, nonexistent_process) {
+    EXPECT_THROW(ProcSampler(-1), std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, periodic_proc_sampler) {
+    PeriodicProcSampler sampler(getpid(), 5ms);
+    std::this_thread::sleep_for(50ms);
+    auto samples = sampler.stop();
+    ASSERT_GE(samples.size(), 2);
+    EXPECT_EQ(samples[0].time, 0ms);
+    for (size_t i = 1; i < samples.size(); ++i) {
+        EXPECT_GE(samples[i].time - samples[i - 1].time, 5ms);
+        EXPECT_GT(samples[i].rss, 0);
+    }
+    EXPECT_TRUE(sampler.stop().empty());
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, spawner_profile) {
+    Spawner::Options opts;
+    opts.sampling_interval = 5ms;
+    auto es = Spawner::run("sleep", {"sleep", "0.05"}, opts);
+    EXPECT_EQ(es.si.code, CLD_EXITED);
+    EXPECT_EQ(es.si.status, 0);
+    ASSERT_FALSE(es.profile.empty());
+    EXPECT_GT(es.rss_peak, 0);
+    for (const auto& sample : es.profile) {
+        EXPECT_LE(sample.rss, es.rss_peak);
+    }
+
+    es = Spawner::run("true", {"true"});
+    EXPECT_TRUE(es.profile.empty());
+    EXPECT_EQ(es.rss_peak, 0);
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, spawner_profile_starts_after_exec) {
+    // Until execve() the child has the RSS of this process
+    std::vector<char> memory(64 << 20, 1);
+    Spawner::Options opts;
+    opts.sampling_interval = 1ms;
+    auto es = Spawner::run("sleep", {"sleep", "0.01"}, opts);
+    EXPECT_EQ(es.si.code, CLD_EXITED);
+    EXPECT_LT(es.rss_peak, memory.size());
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, read_proc_schedstat) {
+    auto schedstat = read_proc_schedstat(getpid());
+    if (not schedstat) {
+        GTEST_SKIP() << "/proc/pid/schedstat is not available";
+    }
+    // Spin for a while
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < 20ms) {
+    }
+    auto schedstat2 = read_proc_schedstat(getpid()).value();
+    EXPECT_GE(schedstat2.since(*schedstat).run_time, 10ms);
+    EXPECT_GE(schedstat2.run_queue_wait_time, schedstat->run_queue_wait_time);
+    EXPECT_GE(schedstat2.timeslices, schedstat->timeslices);
+
+    EXPECT_THROW(read_proc_schedstat(-1), std::runtime_error);
+}
+
+// NOLINTNEXTLINE
+TEST(proc_sampler, spawner_schedstat) {
+    if (not read_proc_schedstat(getpid())) {
+        GTEST_SKIP() << "/proc/pid/schedstat is not available";
+    }
+    Spawner::Options opts;
+    opts.read_schedstat = true;
+    auto es = Spawner::run(
+        "sh", {"sh", "-c", "i=0; while [ $i -lt 20000 ]; do i=$((i+1)); done"}, opts);
+    EXPECT_EQ(es.si.code, CLD_EXITED);
+    EXPECT_EQ(es.si.status, 0);
+    ASSERT_TRUE(es.schedstat.has_value());
+    // Both are measured from the start of the program
+    EXPECT_EQ(es.schedstat->run_time, es.cpu_runtime);
+    EXPECT_LE(es.schedstat->run_queue_wait_time, es.runtime);
+
+    es = Spawner::run("true", {"true"});
+    EXPECT_FALSE(es.schedstat.has_value());
+}
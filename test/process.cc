@@ -1,6 +1,78 @@
-#include "simlib/proc_stat_file_contents.hh"
+#include "simlib/process.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/file_manip.hh"
+#include "simlib/pipe.hh"
+#include "simlib/temporary_directory.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
 #include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Runs a private copy of sleep(1), so that no other process has the same
+// executable
+class SleepingProcess {
+    TemporaryDirectory tmp_dir_{"/tmp/process-test.XXXXXX"};
+
+public:
+    const string exec_path = concat_tostr(tmp_dir_.path(), "sleep");
+    pid_t pid = -1;
+
+    SleepingProcess() {
+        if (copy("/bin/sleep", exec_path, S_0755)) {
+            THROW("copy()", errmsg());
+        }
+        auto exec_pipe = pipe2(O_CLOEXEC);
+        if (not exec_pipe) {
+            THROW("pipe2()", errmsg());
+        }
+
+        pid = fork();
+        if (pid == -1) {
+            THROW("fork()", errmsg());
+        }
+        if (pid == 0) {
+            execl(exec_path.c_str(), "sleep", "100", nullptr);
+            _exit(1);
+        }
+
+        // The pipe is closed once the child calls execve()
+        (void)exec_pipe->writable.close();
+        char c = 0;
+        (void)read(exec_pipe->readable, &c, 1);
+    }
+
+    SleepingProcess(const SleepingProcess&) = delete;
+    SleepingProcess(SleepingProcess&&) = delete;
+    SleepingProcess& operator=(const SleepingProcess&) = delete;
+    SleepingProcess& operator=(SleepingProcess&&) = delete;
+
+    // Returns the wait status of the process
+    int wait() {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid) {
+            THROW("waitpid()", errmsg());
+        }
+        pid = -1;
+        return status;
+    }
+
+    ~SleepingProcess() {
+        if (pid > 0) {
+            (void)kill(pid, SIGKILL);
+            (void)waitpid(pid, nullptr, 0);
+        }
+    }
+};
+
+} // namespace
 
 // NOLINTNEXTLINE
 TEST(DISABLED_process, executable_path) {
@@ -8,13 +80,66 @@ TEST(DISABLED_process, executable_path) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_process, find_processes_by_executable_path) {
-    // TODO: implement it
+TEST(process, find_processes_by_executable_path) {
+    SleepingProcess proc;
+    EXPECT_EQ(find_processes_by_executable_path({proc.exec_path}), vector<pid_t>{proc.pid});
+    EXPECT_EQ(
+        find_processes_by_executable_path({proc.exec_path}, false, 4),
+        vector<pid_t>{proc.pid});
+    EXPECT_EQ(find_processes_by_executable_path({}), vector<pid_t>{});
+
+    // Deleted executable
+    ASSERT_EQ(unlink(proc.exec_path), 0);
+    EXPECT_EQ(find_processes_by_executable_path({proc.exec_path}), vector<pid_t>{proc.pid});
+
+    auto my_exec = executable_path(getpid());
+    auto res = find_processes_by_executable_path({my_exec}, true);
+    EXPECT_EQ(std::count(res.begin(), res.end(), getpid()), 1);
+    res = find_processes_by_executable_path({my_exec}, false);
+    EXPECT_EQ(std::count(res.begin(), res.end(), getpid()), 0);
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_process, kill_processes_by_exec) {
-    // TODO: implement it
+TEST(process, kill_processes_by_exec) {
+    using std::chrono_literals::operator""s;
+    using std::chrono_literals::operator""ms;
+    {
+        SleepingProcess proc;
+        kill_processes_by_exec({proc.exec_path}, 10s);
+        int status = proc.wait();
+        EXPECT_TRUE(WIFSIGNALED(status));
+        EXPECT_EQ(WTERMSIG(status), SIGTERM);
+    }
+    {
+        // SIGCHLD is ignored by sleep(1)
+        SleepingProcess proc;
+        kill_processes_by_exec({proc.exec_path}, 10ms, true, SIGCHLD);
+        int status = proc.wait();
+        EXPECT_TRUE(WIFSIGNALED(status));
+        EXPECT_EQ(WTERMSIG(status), SIGKILL);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(process, call_in_vfork_like_child) {
+    struct Args {
+        int value;
+        int fd;
+    } args = {0, -1};
+    int rc = call_in_vfork_like_child(
+        [](void* arg) noexcept {
+            auto& child_args = *static_cast<Args*>(arg);
+            child_args.value = 42; // Memory is shared
+            child_args.fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            return 7;
+        },
+        &args);
+    EXPECT_EQ(rc, 7);
+    EXPECT_EQ(args.value, 42);
+    ASSERT_GE(args.fd, 0);
+    // The file descriptor table is not shared
+    EXPECT_EQ(fcntl(args.fd, F_GETFD), -1);
+    EXPECT_EQ(errno, EBADF);
 }
 
 // NOLINTNEXTLINE
@@ -1,6 +1,8 @@
 #include "simlib/sandbox.hh"
 #include "simlib/concurrent/job_processor.hh"
+#include "simlib/file_contents.hh"
 #include "simlib/file_manip.hh"
+#include "simlib/memfd.hh"
 #include "simlib/path.hh"
 #include "simlib/process.hh"
 #include "simlib/temporary_file.hh"
@@ -517,6 +519,38 @@ public:
         EXPECT_LT(0, es.vm_peak);
         EXPECT_LT(es.vm_peak, MEM_LIMIT);
     }
+
+    void test_23() {
+        // Testing executing from memfd and granting access by file descriptor
+        compile_test_case("23.c");
+        FileDescriptor executable = copy_to_sealed_memfd(executable_.path(), "23");
+        throw_assert(executable.is_open());
+        FileDescriptor file = open_memfd("file");
+        throw_assert(file.is_open());
+        write_all_throw(file, "abcde");
+
+        auto opts = SANDBOX_OPTIONS;
+        opts.exec_fd = executable;
+        std::vector<string> args = {"23", fd_path(file).to_string(), std::to_string(file)};
+        auto es = Sandbox().run("23", args, opts, {{file, OpenAccess::RDONLY}});
+        EXPECT_EQ(es.si.code, CLD_EXITED);
+        EXPECT_EQ(es.si.status, 0);
+        EXPECT_EQ(es.message, "");
+        EXPECT_LT(0s, es.cpu_runtime);
+        EXPECT_LT(es.cpu_runtime, CPU_TIME_LIMIT);
+        EXPECT_LT(0s, es.runtime);
+        EXPECT_LT(es.runtime, REAL_TIME_LIMIT);
+        EXPECT_LT(0, es.vm_peak);
+        EXPECT_LT(es.vm_peak, MEM_LIMIT);
+        // file is open for writing here, but it was granted read-only
+        EXPECT_EQ(get_file_contents(file, 0, -1), "abcde");
+
+        // Without the access granted
+        es = Sandbox().run("23", args, opts);
+        EXPECT_EQ(es.si.code, CLD_EXITED);
+        EXPECT_EQ(es.si.status, 2);
+        EXPECT_EQ(es.message, "exited with 2");
+    }
 };
 
 class SandboxTestRunner : public concurrent::JobProcessor<void (SandboxTests::*)()> {
@@ -556,6 +590,7 @@ protected:
         add_job(&SandboxTests::test_20);
         add_job(&SandboxTests::test_21);
         add_job(&SandboxTests::test_22);
+        add_job(&SandboxTests::test_23);
     }
 };
 
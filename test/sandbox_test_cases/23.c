@@ -0,0 +1,31 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+	if (argc != 3)
+		return 1;
+
+	int fd = open(argv[1], O_RDONLY);
+	if (fd == -1)
+		return 2;
+
+	char buff[6];
+	if (read(fd, buff, 6) != 5 || memcmp(buff, "abcde", 5) != 0)
+		return 3;
+	close(fd);
+
+	if (open(argv[1], O_RDWR) != -1)
+		return 4;
+
+	// The file descriptor is also usable directly
+	int inherited_fd = atoi(argv[2]);
+	if (pread(inherited_fd, buff, 6, 1) != 4 || memcmp(buff, "bcde", 4) != 0)
+		return 5;
+	// ...but only with the granted access
+	if (write(inherited_fd, "x", 1) != -1)
+		return 6;
+
+	return 0;
+}
@@ -1,23 +1,90 @@
+#include "simlib/random.hh"
 #include "simlib/sha.hh"
+#include "simlib/string_transform.hh"
 
 #include <gtest/gtest.h>
 
 // NOLINTNEXTLINE
-TEST(DISABLED_sha, sha3_224) {
-    // TODO: implement it
+TEST(sha, sha3_224) {
+    EXPECT_EQ(sha3_224(""), "6b4e03423667dbb73b6e15454f0eb1abd4597f9a1b078e3f5b5a6bc7");
+    EXPECT_EQ(sha3_224("abc"), "e642824c3f8cf24ad09234ee7d3c766fc9a3a5168d0c94ad73b46fdf");
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_sha, sha3_256) {
-    // TODO: implement it
+TEST(sha, sha3_256) {
+    EXPECT_EQ(
+        sha3_256(""), "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a");
+    EXPECT_EQ(
+        sha3_256("abc"), "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532");
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_sha, sha3_384) {
-    // TODO: implement it
+TEST(sha, sha3_384) {
+    EXPECT_EQ(
+        sha3_384("abc"),
+        "ec01498288516fc926459f58e2c6ad8df9b473cb0fc08c2596da7cf0e49be4b298d88cea927ac7f5"
+        "39f1edf228376d25");
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_sha, sha3_512) {
-    // TODO: implement it
+TEST(sha, sha3_512) {
+    EXPECT_EQ(
+        sha3_512("abc"),
+        "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e10e116e9192af3c9"
+        "1a7ec57647e3934057340b4cf408d5a56592f8274eec53f0");
+}
+
+// NOLINTNEXTLINE
+TEST(sha, Sha3) {
+    std::string data(2000, '\0');
+    fill_randomly(data.data(), data.size());
+    auto expected = sha3_256(data);
+    for (size_t chunk_len : {1, 7, 135, 136, 137, 1000}) {
+        Sha3_256 sha;
+        for (size_t pos = 0; pos < data.size(); pos += chunk_len) {
+            sha.update(StringView(data).substring(pos, pos + chunk_len));
+        }
+        auto digest = sha.digest();
+        StringView digest_str(reinterpret_cast<const char*>(digest.data()), digest.size());
+        EXPECT_EQ(to_hex(digest_str), expected) << "chunk_len: " << chunk_len;
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(sha, sha256) {
+    EXPECT_EQ(sha256(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(
+        sha256("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(
+        sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    std::string million_a(1'000'000, 'a');
+    EXPECT_EQ(
+        sha256(million_a),
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// NOLINTNEXTLINE
+TEST(sha, Sha256) {
+    std::string data(10'000, '\0');
+    fill_randomly(data.data(), data.size());
+    auto expected = sha256_digest(data);
+    for (size_t chunk_len : {1, 7, 63, 64, 65, 1000}) {
+        Sha256 sha;
+        for (size_t pos = 0; pos < data.size(); pos += chunk_len) {
+            sha.update(StringView(data).substring(pos, pos + chunk_len));
+        }
+        EXPECT_EQ(sha.digest(), expected) << "chunk_len: " << chunk_len;
+    }
+
+    // Lengths around the padding boundary
+    for (size_t len = 50; len < 140; ++len) {
+        Sha256 sha;
+        sha.update(StringView(data).substring(0, len));
+        auto digest = sha.digest();
+        sha.reset();
+        sha.update(StringView(data).substring(0, len));
+        EXPECT_EQ(sha.digest(), digest);
+        EXPECT_NE(sha256_digest(StringView(data).substring(0, len + 1)), digest);
+    }
 }
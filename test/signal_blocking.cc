@@ -31,3 +31,28 @@ TEST(DISABLED_signal_blocking, thread_block_signals) {
 TEST(DISABLED_signal_blocking, THREAD_BLOCK_SIGNALS) {
     // TODO: implement it
 }
+
+// NOLINTNEXTLINE
+TEST(signal_blocking, ThreadSignalBlocker_with_mask) {
+    auto is_blocked = [](int signum) {
+        sigset_t mask;
+        pthread_sigmask(SIG_SETMASK, nullptr, &mask);
+        return sigismember(&mask, signum) == 1;
+    };
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    ASSERT_FALSE(is_blocked(SIGUSR1));
+    {
+        ThreadSignalBlocker blocker(mask);
+        EXPECT_TRUE(is_blocked(SIGUSR1));
+        EXPECT_FALSE(is_blocked(SIGUSR2));
+        EXPECT_FALSE(blocker.was_blocked(SIGUSR1));
+        {
+            ThreadSignalBlocker nested_blocker(mask);
+            EXPECT_TRUE(nested_blocker.was_blocked(SIGUSR1));
+        }
+        EXPECT_TRUE(is_blocked(SIGUSR1));
+    }
+    EXPECT_FALSE(is_blocked(SIGUSR1));
+}
@@ -0,0 +1,233 @@
+#include "simlib/sim/judge_worker.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/file_contents.hh"
+#include "simlib/file_manip.hh"
+#include "simlib/temporary_directory.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using sim::JudgeReport;
+using sim::JudgeWorker;
+using std::string;
+using std::vector;
+
+namespace {
+
+constexpr size_t COMPILATION_ERRORS_MAX_LENGTH = 4096;
+constexpr int TESTS_NUM = 4;
+
+// Randomly either spins for 10 ms and prints "fast", or spins for 80 ms and
+// prints "slow" -- the expected output. This way the verdict tells which run's
+// output was checked.
+constexpr const char SOLUTION_SOURCE[] = R"(#include <stdio.h>
+#include <time.h>
+int main() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    int slow = (ts.tv_nsec >> 10) & 1;
+    clock_t spin_until = (slow ? 80 : 10) * (CLOCKS_PER_SEC / 1000);
+    while (clock() < spin_until) {
+    }
+    puts(slow ? "slow" : "fast");
+    return 0;
+}
+)";
+
+// Prints the expected output at once
+constexpr const char FAST_SOLUTION_SOURCE[] = R"(#include <stdio.h>
+int main() {
+    puts("slow");
+    return 0;
+}
+)";
+
+constexpr const char CRASHING_SOLUTION_SOURCE[] = R"(int main() { return 1; }
+)";
+
+using std::chrono_literals::operator""ms;
+
+constexpr auto split_runtime = 50ms; // between the fast and the slow runtime
+
+struct Package {
+    TemporaryDirectory dir{"/tmp/simlib.test.judge_worker.XXXXXX"};
+    string simfile;
+
+    explicit Package(const char* solution_source = SOLUTION_SOURCE) {
+        throw_assert(mkdir(concat(dir.path(), "prog")) == 0);
+        throw_assert(mkdir(concat(dir.path(), "tests")) == 0);
+        put_file_contents(concat(dir.path(), "prog/sol.c"), solution_source);
+
+        string limits;
+        string tests_files;
+        for (int i = 1; i <= TESTS_NUM; ++i) {
+            put_file_contents(concat(dir.path(), "tests/", i, ".in"), "");
+            put_file_contents(concat(dir.path(), "tests/", i, ".out"), "slow\n");
+            back_insert(limits, '\t', i, " 0.1\n");
+            back_insert(tests_files, '\t', i, " tests/", i, ".in tests/", i, ".out\n");
+        }
+        simfile = concat_tostr(
+            "name: rerun\nlabel: rr\nsolutions: [prog/sol.c]\nmemory_limit: 32\n"
+            "limits: [\n",
+            limits, "]\ntests_files: [\n", tests_files, "]\n");
+    }
+};
+
+void compile(JudgeWorker& jworker) {
+    string compilation_errors;
+    if (jworker.compile_checker(
+            std::chrono::seconds(30), &compilation_errors, COMPILATION_ERRORS_MAX_LENGTH, ""))
+    {
+        THROW("failed to compile checker: \n", compilation_errors);
+    }
+    if (jworker.compile_solution_from_package(
+            "prog/sol.c", sim::SolutionLanguage::C11, std::chrono::seconds(30),
+            &compilation_errors, COMPILATION_ERRORS_MAX_LENGTH, ""))
+    {
+        THROW("failed to compile solution: \n", compilation_errors);
+    }
+}
+
+vector<JudgeReport::Test> judge_tests(JudgeWorker& jworker, bool use_memfds) {
+    jworker.use_memfds = use_memfds;
+    sim::VerboseJudgeLogger judge_logger;
+    auto report = jworker.judge(true, judge_logger);
+    vector<JudgeReport::Test> tests;
+    for (auto& group : report.groups) {
+        for (auto& test : group.tests) {
+            tests.emplace_back(std::move(test));
+        }
+    }
+    EXPECT_EQ(tests.size(), TESTS_NUM);
+    return tests;
+}
+
+// The checker has to see the output of the run that decided the runtime
+void expect_verdict_matches_runtime(const JudgeReport::Test& test) {
+    if (test.runtime > split_runtime) {
+        EXPECT_EQ(test.status, JudgeReport::Test::OK) << test.name;
+    } else {
+        EXPECT_EQ(test.status, JudgeReport::Test::WA) << test.name;
+    }
+}
+
+} // namespace
+
+// NOLINTNEXTLINE
+TEST(JudgeWorker, rerun_policy_pick_min) {
+    Package package;
+    JudgeWorker jworker;
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+    jworker.rerun_policy.emplace();
+    jworker.rerun_policy->band = 1; // every runtime is close
+    jworker.rerun_policy->runs = 3;
+    jworker.rerun_policy->pick = JudgeWorker::RerunPolicy::Pick::MIN;
+
+    for (bool use_memfds : {true, false}) {
+        for (const auto& test : judge_tests(jworker, use_memfds)) {
+            ASSERT_EQ(test.all_runtimes.size(), 3) << test.name;
+            EXPECT_EQ(
+                test.runtime,
+                *std::min_element(test.all_runtimes.begin(), test.all_runtimes.end()))
+                << test.name;
+            expect_verdict_matches_runtime(test);
+        }
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(JudgeWorker, rerun_policy_pick_median) {
+    Package package;
+    JudgeWorker jworker;
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+    jworker.rerun_policy.emplace();
+    jworker.rerun_policy->band = 1; // every runtime is close
+    jworker.rerun_policy->runs = 3;
+    jworker.rerun_policy->pick = JudgeWorker::RerunPolicy::Pick::MEDIAN;
+
+    for (bool use_memfds : {true, false}) {
+        for (const auto& test : judge_tests(jworker, use_memfds)) {
+            ASSERT_EQ(test.all_runtimes.size(), 3) << test.name;
+            auto sorted_runtimes = test.all_runtimes;
+            std::sort(sorted_runtimes.begin(), sorted_runtimes.end());
+            EXPECT_EQ(test.runtime, sorted_runtimes[1]) << test.name;
+            expect_verdict_matches_runtime(test);
+        }
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(JudgeWorker, rerun_policy_stops_at_decisive_run) {
+    Package package;
+    JudgeWorker jworker;
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+    // With the time limit of 100 ms and the score cut at 50 ms, the slow run
+    // (80 ms) is close and the fast run (10 ms) is not
+    jworker.score_cut_lambda = 0.5;
+    jworker.rerun_policy.emplace();
+    jworker.rerun_policy->band = 0.3;
+    jworker.rerun_policy->runs = 5;
+    jworker.rerun_policy->pick = JudgeWorker::RerunPolicy::Pick::MIN;
+
+    for (const auto& test : judge_tests(jworker, true)) {
+        const auto& runtimes = test.all_runtimes;
+        if (runtimes.empty()) {
+            // The first run was fast
+            EXPECT_LT(test.runtime, split_runtime) << test.name;
+        } else {
+            // Every run but the last one was slow, the last is fast unless
+            // all the runs were made
+            for (size_t i = 0; i + 1 < runtimes.size(); ++i) {
+                EXPECT_GT(runtimes[i], split_runtime) << test.name;
+            }
+            if (runtimes.size() < 5) {
+                EXPECT_LT(runtimes.back(), split_runtime) << test.name;
+            }
+            EXPECT_EQ(test.runtime, *std::min_element(runtimes.begin(), runtimes.end()))
+                << test.name;
+        }
+        expect_verdict_matches_runtime(test);
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(JudgeWorker, rerun_policy_ignores_score_cut_if_there_is_none) {
+    Package package(FAST_SOLUTION_SOURCE);
+    JudgeWorker jworker;
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+    // With score_cut_lambda == 0 the score is not scaled, so runtimes close to
+    // 0 are not close to anything
+    jworker.score_cut_lambda = 0;
+    jworker.rerun_policy.emplace();
+    jworker.rerun_policy->band = 0.3;
+    jworker.rerun_policy->runs = 3;
+
+    for (const auto& test : judge_tests(jworker, true)) {
+        EXPECT_EQ(test.status, JudgeReport::Test::OK) << test.name;
+        EXPECT_LT(test.runtime, split_runtime) << test.name;
+        EXPECT_TRUE(test.all_runtimes.empty()) << test.name;
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(JudgeWorker, rerun_policy_does_not_rerun_runtime_error) {
+    Package package(CRASHING_SOLUTION_SOURCE);
+    JudgeWorker jworker;
+    jworker.load_package(package.dir.path(), package.simfile);
+    compile(jworker);
+    jworker.rerun_policy.emplace();
+    jworker.rerun_policy->band = 1; // every runtime is close
+    jworker.rerun_policy->runs = 3;
+
+    for (const auto& test : judge_tests(jworker, true)) {
+        EXPECT_EQ(test.status, JudgeReport::Test::RTE) << test.name;
+        EXPECT_TRUE(test.all_runtimes.empty()) << test.name;
+    }
+}
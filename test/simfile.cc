@@ -4,6 +4,7 @@
 #include "simlib/temporary_directory.hh"
 #include "simlib/utilities.hh"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 
 using std::array;
@@ -747,3 +748,34 @@ TEST(Simfile, validate_files) {
         }
     }
 }
+
+// NOLINTNEXTLINE
+TEST(Simfile, TestNameComparator) {
+    using TNC = sim::Simfile::TestNameComparator;
+    auto key = TNC::key("abc012xy");
+    EXPECT_EQ(key.name, "abc012xy");
+    EXPECT_EQ(key.split.gid, "012");
+    EXPECT_EQ(key.split.tid, "xy");
+    EXPECT_EQ(key.gid_num, "12");
+    EXPECT_FALSE(key.ocen);
+    EXPECT_TRUE(TNC::key("abc00ocen").ocen);
+    EXPECT_EQ(TNC::key("abc00ocen").gid_num, "");
+
+    const vector<string> sorted = {
+        "sim0a", "sim0b", "sim1ocen", "sim2ocen", "sim1a", "sim1b",
+        "sim2a", "sim2b", "sim9a",    "sim10a",   "sim10b",
+    };
+    auto names = sorted;
+    std::reverse(names.begin(), names.end());
+    std::stable_sort(names.begin(), names.end(), TNC());
+    EXPECT_EQ(names, sorted);
+
+    vector<TNC::Key> keys;
+    for (auto i : {4, 8, 0, 3, 10, 2, 7, 1, 9, 5, 6}) {
+        keys.emplace_back(TNC::key(sorted[i]));
+    }
+    std::stable_sort(keys.begin(), keys.end(), TNC());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        EXPECT_EQ(keys[i].name, sorted[i]) << i;
+    }
+}
@@ -1,6 +1,14 @@
 #include "simlib/string_transform.hh"
+#include "simlib/random.hh"
 
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
 
 // NOLINTNEXTLINE
 TEST(DISABLED_string_transform, to_lower) {
@@ -140,18 +148,186 @@ TEST(DISABLED_string_transform, json_stringify) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_string_transform, str2num_integral) {
-    // TODO: implement it
+TEST(string_transform, str2num_integral) {
+    EXPECT_EQ(str2num<int>("0"), 0);
+    EXPECT_EQ(str2num<int>("-0"), 0);
+    EXPECT_EQ(str2num<int>("123"), 123);
+    EXPECT_EQ(str2num<int>("-123"), -123);
+    EXPECT_EQ(str2num<int>("0000000000000000000000000042"), 42);
+    EXPECT_EQ(str2num<int>("2147483647"), 2147483647);
+    EXPECT_EQ(str2num<int>("-2147483648"), std::numeric_limits<int>::min());
+    EXPECT_EQ(str2num<int>("2147483648"), std::nullopt);
+    EXPECT_EQ(str2num<int>("-2147483649"), std::nullopt);
+    EXPECT_EQ(str2num<int>(""), std::nullopt);
+    EXPECT_EQ(str2num<int>("-"), std::nullopt);
+    EXPECT_EQ(str2num<int>("+1"), std::nullopt);
+    EXPECT_EQ(str2num<int>(" 1"), std::nullopt);
+    EXPECT_EQ(str2num<int>("1 "), std::nullopt);
+    EXPECT_EQ(str2num<int>("12345678a"), std::nullopt);
+    EXPECT_EQ(str2num<unsigned>("-1"), std::nullopt);
+    EXPECT_EQ(str2num<uint8_t>("255"), 255);
+    EXPECT_EQ(str2num<uint8_t>("256"), std::nullopt);
+    EXPECT_EQ(str2num<int8_t>("-128"), -128);
+    EXPECT_EQ(str2num<int8_t>("-129"), std::nullopt);
+    EXPECT_EQ(str2num<bool>("1"), true);
+    EXPECT_EQ(str2num<bool>("2"), std::nullopt);
+    EXPECT_EQ(str2num<uint64_t>("18446744073709551615"), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(str2num<uint64_t>("18446744073709551616"), std::nullopt);
+    EXPECT_EQ(str2num<uint64_t>("99999999999999999999"), std::nullopt);
+    EXPECT_EQ(str2num<int64_t>("9223372036854775807"), std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(str2num<int64_t>("-9223372036854775808"), std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(str2num<int64_t>("9223372036854775808"), std::nullopt);
+    EXPECT_EQ(str2num<int64_t>("-9223372036854775809"), std::nullopt);
+    static_assert(str2num<int>("-12345678901") == std::nullopt);
+    static_assert(str2num<int>("-1234567890") == -1234567890);
+}
+
+namespace {
+
+// The digit by digit implementation of str2num() for integers
+template <class T>
+std::optional<T> reference_str2num(StringView str) {
+    if (str.empty()) {
+        return std::nullopt;
+    }
+    bool minus = false;
+    if (std::is_signed_v<T> and str[0] == '-') {
+        minus = true;
+        str.remove_prefix(1);
+        if (str.empty()) {
+            return std::nullopt;
+        }
+    }
+    T res = 0;
+    for (unsigned char c : str) {
+        if (not is_digit(c) or __builtin_mul_overflow(res, 10, &res) or
+            __builtin_add_overflow(res, (minus ? '0' - c : c - '0'), &res))
+        {
+            return std::nullopt;
+        }
+    }
+    return res;
+}
+
+// The strtod() based implementation of str2num() for floating-point numbers
+template <class T>
+std::optional<T> reference_str2num_fp(const string& str) {
+    if (str.empty() or is_space(str[0])) {
+        return std::nullopt;
+    }
+    errno = 0;
+    char* ptr = nullptr;
+    T res = [&] {
+        if constexpr (std::is_same_v<T, float>) {
+            return ::strtof(str.data(), &ptr);
+        } else {
+            return ::strtod(str.data(), &ptr);
+        }
+    }();
+    if (errno or ptr != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return res;
+}
+
+string random_str_from(StringView alphabet, size_t max_len) {
+    string res(get_random<size_t>(0, size_t{max_len}), '\0');
+    for (auto& c : res) {
+        c = alphabet[get_random<size_t>(0, alphabet.size() - 1)];
+    }
+    return res;
+}
+
+template <class T>
+void fuzz_str2num_integral() {
+    for (int iter = 0; iter < 100000; ++iter) {
+        auto str = random_str_from("0123456789999-", 24);
+        if (get_random(0, 1)) {
+            // Mostly valid numbers
+            str = random_str_from("-", 1) + random_str_from("0123456789", 24);
+        }
+        EXPECT_EQ(str2num<T>(str), reference_str2num<T>(str)) << str;
+    }
 }
 
+} // namespace
+
 // NOLINTNEXTLINE
-TEST(DISABLED_string_transform, str2num_floating_point) {
-    // TODO: implement it
+TEST(string_transform, str2num_integral_fuzz) {
+    fuzz_str2num_integral<int8_t>();
+    fuzz_str2num_integral<uint8_t>();
+    fuzz_str2num_integral<int16_t>();
+    fuzz_str2num_integral<uint16_t>();
+    fuzz_str2num_integral<int32_t>();
+    fuzz_str2num_integral<uint32_t>();
+    fuzz_str2num_integral<int64_t>();
+    fuzz_str2num_integral<uint64_t>();
+#ifdef __GLIBCXX_TYPE_INT_N_0 // __int128 is an integral type only in GNU modes
+    fuzz_str2num_integral<__int128>();
+#endif
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_string_transform, str2num_with_bounds) {
-    // TODO: implement it
+TEST(string_transform, str2num_floating_point) {
+    EXPECT_EQ(str2num<double>("0"), 0);
+    EXPECT_EQ(str2num<double>("3.25"), 3.25);
+    EXPECT_EQ(str2num<double>("+3.25"), 3.25);
+    EXPECT_EQ(str2num<double>("-3.25e2"), -325);
+    EXPECT_EQ(str2num<double>(".5"), 0.5);
+    EXPECT_EQ(str2num<double>("5."), 5);
+    EXPECT_EQ(str2num<double>("0x1p4"), 16);
+    EXPECT_EQ(str2num<double>("-0X1P4"), -16);
+    EXPECT_EQ(str2num<double>("inf"), std::numeric_limits<double>::infinity());
+    EXPECT_EQ(str2num<float>("1.5"), 1.5F);
+    EXPECT_EQ(str2num<long double>("1.5"), 1.5L);
+    EXPECT_EQ(str2num<double>(""), std::nullopt);
+    EXPECT_EQ(str2num<double>("+"), std::nullopt);
+    EXPECT_EQ(str2num<double>("+-1"), std::nullopt);
+    EXPECT_EQ(str2num<double>("++1"), std::nullopt);
+    EXPECT_EQ(str2num<double>(" 1"), std::nullopt);
+    EXPECT_EQ(str2num<double>("1 "), std::nullopt);
+    EXPECT_EQ(str2num<double>("1e"), std::nullopt);
+    EXPECT_EQ(str2num<double>("1e999"), std::nullopt);
+    EXPECT_EQ(str2num<double>("1e-999"), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(string_transform, str2num_floating_point_fuzz) {
+    for (int iter = 0; iter < 100000; ++iter) {
+        auto str = random_str_from("0123456789.e-+", 24);
+        if (get_random(0, 1)) {
+            // Mostly valid numbers
+            str = random_str_from("+-", 1) + random_str_from("0123456789", 12) + '.' +
+                random_str_from("0123456789", 12) + random_str_from("e", 1) +
+                random_str_from("-", 1) + random_str_from("0123456789", 2);
+        }
+        EXPECT_EQ(str2num<double>(str), reference_str2num_fp<double>(str)) << str;
+        EXPECT_EQ(str2num<float>(str), reference_str2num_fp<float>(str)) << str;
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(string_transform, str2num_with_bounds) {
+    EXPECT_EQ(str2num<int>("5", 1, 10), 5);
+    EXPECT_EQ(str2num<int>("1", 1, 10), 1);
+    EXPECT_EQ(str2num<int>("10", 1, 10), 10);
+    EXPECT_EQ(str2num<int>("0", 1, 10), std::nullopt);
+    EXPECT_EQ(str2num<int>("11", 1, 10), std::nullopt);
+    EXPECT_EQ(str2num<int>("x", 1, 10), std::nullopt);
+}
+
+// NOLINTNEXTLINE
+TEST(string_transform, str2nums) {
+    EXPECT_EQ(str2nums<int>(""), vector<int>{});
+    EXPECT_EQ(str2nums<int>(" \n\t "), vector<int>{});
+    EXPECT_EQ(str2nums<int>("1 -2\n\n 3\t"), (vector<int>{1, -2, 3}));
+    EXPECT_EQ(
+        str2nums<uint64_t>("18446744073709551615"),
+        vector<uint64_t>{std::numeric_limits<uint64_t>::max()});
+    EXPECT_EQ(str2nums<double>(" 0.5 1e3 "), (vector<double>{0.5, 1000}));
+    EXPECT_EQ(str2nums<int>("1 2 x 3"), std::nullopt);
+    EXPECT_EQ(str2nums<int>("1 2-"), std::nullopt);
+    EXPECT_EQ(str2nums<uint8_t>("1 256"), std::nullopt);
 }
 
 // NOLINTNEXTLINE
@@ -162,3 +338,14 @@ TEST(string_trasform, padded_string) {
     EXPECT_EQ("1234", padded_string("1234", 4, RIGHT, '0'));
     EXPECT_EQ("1234", padded_string("1234", 2, RIGHT, '0'));
 }
+
+// NOLINTNEXTLINE
+TEST(string_trasform, append_padded) {
+    string str = "x";
+    append_padded(str, "abc", 5);
+    EXPECT_EQ(str, "x  abc");
+    append_padded(str, "abc", 4, LEFT, '.');
+    EXPECT_EQ(str, "x  abcabc.");
+    append_padded(str, "1234", 2);
+    EXPECT_EQ(str, "x  abcabc.1234");
+}
@@ -1,11 +1,52 @@
 #include "simlib/time.hh"
 
 #include <chrono>
+#include <cstdlib>
+#include <ctime>
 #include <gtest/gtest.h>
+#include <optional>
+#include <string>
 
 using std::chrono_literals::operator""ns;
 using std::chrono_literals::operator""ms;
 using std::chrono_literals::operator""s;
+using std::chrono_literals::operator""h;
+
+namespace {
+
+// Sets the timezone for the lifetime of the object
+class TimezoneGuard {
+    std::optional<std::string> old_tz_;
+
+public:
+    explicit TimezoneGuard(const char* tz) {
+        if (const char* old_tz = getenv("TZ")) {
+            old_tz_ = old_tz;
+        }
+        set(tz);
+    }
+
+    TimezoneGuard(const TimezoneGuard&) = delete;
+    TimezoneGuard(TimezoneGuard&&) = delete;
+    TimezoneGuard& operator=(const TimezoneGuard&) = delete;
+    TimezoneGuard& operator=(TimezoneGuard&&) = delete;
+
+    static void set(const char* tz) {
+        setenv("TZ", tz, 1);
+        tzset();
+    }
+
+    ~TimezoneGuard() {
+        if (old_tz_) {
+            setenv("TZ", old_tz_->c_str(), 1);
+        } else {
+            unsetenv("TZ");
+        }
+        tzset();
+    }
+};
+
+} // namespace
 
 // NOLINTNEXTLINE
 TEST(DISABLED_time, microtime) {
@@ -28,18 +69,27 @@ TEST(DISABLED_time, date_with_time_point) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_time, mysql_date) {
-    // TODO: implement it
+TEST(time, mysql_date) {
+    EXPECT_EQ(mysql_date(0), "1970-01-01 00:00:00");
+    EXPECT_EQ(mysql_date(1616893199), "2021-03-28 00:59:59");
+    EXPECT_EQ(mysql_date(1616893200), "2021-03-28 01:00:00");
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_time, mysql_date_with_curr_time) {
-    // TODO: implement it
+TEST(time, mysql_date_with_curr_time) {
+    auto before = time(nullptr);
+    auto date = mysql_date();
+    auto after = time(nullptr);
+    ASSERT_TRUE(is_datetime(date)) << date;
+    EXPECT_LE(before, str_to_time_t(date));
+    EXPECT_LE(str_to_time_t(date), after);
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_time, mysql_date_with_time_point) {
-    // TODO: implement it
+TEST(time, mysql_date_with_time_point) {
+    EXPECT_EQ(
+        mysql_date(std::chrono::system_clock::from_time_t(1616893199) + 999ms),
+        "2021-03-28 00:59:59");
 }
 
 // NOLINTNEXTLINE
@@ -58,8 +108,10 @@ TEST(DISABLED_time, localdate_with_time_point) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_time, mysql_localdate) {
-    // TODO: implement it
+TEST(time, mysql_localdate) {
+    TimezoneGuard tz_guard("CET-1CEST,M3.5.0,M10.5.0/3");
+    EXPECT_EQ(mysql_localdate(0), "1970-01-01 01:00:00");
+    EXPECT_EQ(mysql_localdate(1616893199), "2021-03-28 01:59:59");
 }
 
 // NOLINTNEXTLINE
@@ -68,8 +120,60 @@ TEST(DISABLED_time, mysql_localdate_with_curr_time) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_time, mysql_localdate_with_time_point) {
-    // TODO: implement it
+TEST(time, mysql_localdate_with_time_point) {
+    TimezoneGuard tz_guard("CET-1CEST,M3.5.0,M10.5.0/3");
+    EXPECT_EQ(
+        mysql_localdate(std::chrono::system_clock::from_time_t(1616893200) + 999ms),
+        "2021-03-28 03:00:00");
+}
+
+// NOLINTNEXTLINE
+TEST(time, mysql_date_buff) {
+    auto tp = std::chrono::system_clock::from_time_t(1616893199) + 123456789ns;
+    EXPECT_STREQ(mysql_date_buff(tp).c_str(), "2021-03-28 00:59:59");
+    EXPECT_STREQ(mysql_date_buff(tp, 1).c_str(), "2021-03-28 00:59:59.1");
+    EXPECT_STREQ(mysql_date_buff(tp, 3).c_str(), "2021-03-28 00:59:59.123");
+    EXPECT_STREQ(mysql_date_buff(tp, 9).c_str(), "2021-03-28 00:59:59.123456789");
+    EXPECT_STREQ(mysql_date_buff(tp, 42).c_str(), "2021-03-28 00:59:59.123456789");
+    // Cached seconds do not leak into the next second
+    EXPECT_STREQ(mysql_date_buff(tp + 1s, 3).c_str(), "2021-03-28 01:00:00.123");
+    // Before the epoch the fraction counts from the earlier second
+    auto epoch = std::chrono::system_clock::from_time_t(0);
+    EXPECT_STREQ(mysql_date_buff(epoch - 1ms, 3).c_str(), "1969-12-31 23:59:59.999");
+    EXPECT_STREQ(mysql_date_buff(epoch, 2).c_str(), "1970-01-01 00:00:00.00");
+    EXPECT_EQ(mysql_date_buff(tp, 9).c_str()[29], '\0');
+}
+
+// NOLINTNEXTLINE
+TEST(time, mysql_localdate_buff_timezone_change) {
+    auto tp = std::chrono::system_clock::from_time_t(0) + 500ms;
+    TimezoneGuard tz_guard("UTC0");
+    EXPECT_STREQ(mysql_localdate_buff(tp, 1).c_str(), "1970-01-01 00:00:00.5");
+    // The same second is cached, but it has to be formatted again
+    TimezoneGuard::set("EET-2");
+    EXPECT_STREQ(mysql_localdate_buff(tp, 1).c_str(), "1970-01-01 02:00:00.5");
+    TimezoneGuard::set("XYZ+3");
+    EXPECT_STREQ(mysql_localdate_buff(tp, 1).c_str(), "1969-12-31 21:00:00.5");
+    TimezoneGuard::set("UTC0");
+    EXPECT_STREQ(mysql_localdate_buff(tp, 1).c_str(), "1970-01-01 00:00:00.5");
+    // UTC date does not depend on the timezone
+    TimezoneGuard::set("EET-2");
+    EXPECT_STREQ(mysql_date_buff(tp, 1).c_str(), "1970-01-01 00:00:00.5");
+}
+
+// NOLINTNEXTLINE
+TEST(time, mysql_localdate_buff_dst_transitions) {
+    TimezoneGuard tz_guard("CET-1CEST,M3.5.0,M10.5.0/3");
+    auto forward = std::chrono::system_clock::from_time_t(1616893199); // 00:59:59 UTC
+    EXPECT_STREQ(mysql_localdate_buff(forward).c_str(), "2021-03-28 01:59:59");
+    EXPECT_STREQ(mysql_localdate_buff(forward + 999ms, 3).c_str(), "2021-03-28 01:59:59.999");
+    EXPECT_STREQ(mysql_localdate_buff(forward + 1s).c_str(), "2021-03-28 03:00:00");
+
+    auto backward = std::chrono::system_clock::from_time_t(1635641999); // 00:59:59 UTC
+    EXPECT_STREQ(mysql_localdate_buff(backward).c_str(), "2021-10-31 02:59:59");
+    EXPECT_STREQ(mysql_localdate_buff(backward + 1s).c_str(), "2021-10-31 02:00:00");
+    EXPECT_STREQ(mysql_localdate_buff(backward + 1h).c_str(), "2021-10-31 02:59:59");
+    EXPECT_STREQ(mysql_localdate_buff(backward + 1h + 1s).c_str(), "2021-10-31 03:00:00");
 }
 
 // NOLINTNEXTLINE
@@ -210,6 +314,10 @@ TEST(time, to_string_with_duration) {
     static_assert(intentional_unsafe_string_view(to_string(800ns, false)) == "0.000000800");
     static_assert(intentional_unsafe_string_view(to_string(12ms, false)) == "0.012");
     static_assert(intentional_unsafe_string_view(to_string(1230000ms, false)) == "1230.000");
+
+    static_assert(intentional_unsafe_string_view(to_string(-1ns)) == "-0.000000001");
+    static_assert(intentional_unsafe_string_view(to_string(-1500ms)) == "-1.5");
+    static_assert(intentional_unsafe_string_view(to_string(-2000ms, false)) == "-2.000");
 }
 
 // NOLINTNEXTLINE
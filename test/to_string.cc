@@ -1,6 +1,10 @@
 #include "simlib/to_string.hh"
+#include "simlib/string_view.hh"
 
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <limits>
+#include <string>
 
 // NOLINTNEXTLINE
 TEST(DISABLED_StaticCStringBuff, default_constructor) {
@@ -88,8 +92,24 @@ TEST(DISABLED_StaticCStringBuff, operator_subscript) {
 }
 
 // NOLINTNEXTLINE
-TEST(DISABLED_to_string, to_string_with_integral) {
-    // TODO: implement it
+TEST(to_string, to_string_with_integral) {
+    static_assert(intentional_unsafe_string_view(to_string(0)) == "0");
+    static_assert(intentional_unsafe_string_view(to_string(9)) == "9");
+    static_assert(intentional_unsafe_string_view(to_string(10)) == "10");
+    static_assert(intentional_unsafe_string_view(to_string(99)) == "99");
+    static_assert(intentional_unsafe_string_view(to_string(100)) == "100");
+    static_assert(intentional_unsafe_string_view(to_string(-7)) == "-7");
+    static_assert(intentional_unsafe_string_view(to_string(int8_t{-128})) == "-128");
+    static_assert(intentional_unsafe_string_view(to_string(uint8_t{255})) == "255");
+    static_assert(
+        intentional_unsafe_string_view(to_string(std::numeric_limits<int64_t>::min())) ==
+        "-9223372036854775808");
+    static_assert(
+        intentional_unsafe_string_view(to_string(std::numeric_limits<uint64_t>::max())) ==
+        "18446744073709551615");
+    for (int64_t x = -100000; x <= 100000; x += 7) {
+        EXPECT_EQ(intentional_unsafe_string_view(to_string(x)), std::to_string(x));
+    }
 }
 
 // NOLINTNEXTLINE
@@ -0,0 +1,89 @@
+#define SIMLIB_TRACING
+#include "simlib/tracing.hh"
+#include "simlib/concat_tostr.hh"
+#include "simlib/syscalls.hh"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using std::chrono_literals::operator""ms;
+
+// NOLINTNEXTLINE
+TEST(tracing, span) {
+    auto start = tracing::Clock::now();
+    {
+        TRACE_SPAN("outer");
+        {
+            TRACE_SPAN_NAMED(inner, "inner");
+            std::this_thread::sleep_for(1ms);
+            TRACE_SPAN_END(inner);
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    auto end = tracing::Clock::now();
+
+    auto spans = tracing::spans_since(start);
+    ASSERT_EQ(spans.size(), 2);
+    EXPECT_STREQ(spans[0].name, "outer");
+    EXPECT_STREQ(spans[1].name, "inner");
+    EXPECT_GE(spans[0].start, start);
+    EXPECT_LE(spans[0].start, spans[1].start);
+    EXPECT_GE(spans[1].end - spans[1].start, 1ms);
+    // inner was ended before the second sleep
+    EXPECT_GE(spans[0].end - spans[1].end, 1ms);
+    EXPECT_LE(spans[0].end, end);
+    EXPECT_EQ(spans[0].tid, syscalls::gettid());
+    EXPECT_EQ(spans[1].tid, syscalls::gettid());
+
+    EXPECT_TRUE(tracing::spans_since(tracing::Clock::now()).empty());
+}
+
+// NOLINTNEXTLINE
+TEST(tracing, spans_of_finished_threads) {
+    auto start = tracing::Clock::now();
+    pid_t thread_tid = 0;
+    std::thread([&] {
+        TRACE_SPAN("thread");
+        thread_tid = syscalls::gettid();
+    }).join();
+
+    auto spans = tracing::spans_since(start);
+    ASSERT_EQ(spans.size(), 1);
+    EXPECT_STREQ(spans[0].name, "thread");
+    EXPECT_EQ(spans[0].tid, thread_tid);
+}
+
+// NOLINTNEXTLINE
+TEST(tracing, ring_buffer_keeps_last_spans) {
+    auto start = tracing::Clock::now();
+    for (size_t i = 0; i < tracing::SPANS_PER_THREAD + 10; ++i) {
+        tracing::record(i < 10 ? "old" : "new", tracing::Clock::now(), tracing::Clock::now());
+    }
+
+    auto spans = tracing::spans_since(start);
+    ASSERT_EQ(spans.size(), tracing::SPANS_PER_THREAD);
+    for (const auto& span : spans) {
+        EXPECT_STREQ(span.name, "new");
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(tracing, to_chrome_trace_json) {
+    tracing::Clock::time_point start{std::chrono::nanoseconds(1234567)};
+    std::vector<tracing::SpanRecord> spans = {
+        {"a\"b", start, start + std::chrono::nanoseconds(2005), 42},
+        {"c", start, start, 7},
+    };
+    auto pid = getpid();
+    EXPECT_EQ(
+        tracing::to_chrome_trace_json(spans),
+        concat_tostr(
+            "{\"traceEvents\":[{\"name\":\"a\\\"b\",\"cat\":\"simlib\",\"ph\":\"X\",",
+            "\"ts\":1234.567,\"dur\":2.005,\"pid\":", pid, ",\"tid\":42},",
+            "{\"name\":\"c\",\"cat\":\"simlib\",\"ph\":\"X\",",
+            "\"ts\":1234.567,\"dur\":0.000,\"pid\":", pid, ",\"tid\":7}],",
+            "\"displayTimeUnit\":\"ms\"}"));
+    EXPECT_EQ(
+        tracing::to_chrome_trace_json({}), "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}");
+}